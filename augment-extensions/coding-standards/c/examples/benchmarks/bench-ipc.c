@@ -0,0 +1,121 @@
+/**
+ * @file bench-ipc.c
+ * @brief Pipe vs. shared-memory channel latency (systems/ipc-channel.h)
+ *
+ * Ping-pong between the parent and a forked echo child over a request and
+ * a reply channel, as in ipc-pipes.c, but every round trip is timed on its
+ * own so the tail shows up: a futex wake or a pipe wakeup that misses the
+ * peer's time slice lands in p99, not in the mean.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../systems/ipc-channel.h"
+#include "bench.h"
+
+#define IPC_MESSAGE_SIZE    64
+#define IPC_WARMUP          1000
+
+/**
+ * @brief Time round_trips request/reply pairs over one transport
+ * @return 0 on success, -1 on error
+ */
+static int time_round_trips(ipc_transport_t transport, long round_trips) {
+    ipc_channel_t request;
+    ipc_channel_t reply;
+    char buffer[IPC_MESSAGE_SIZE];
+    double *samples;
+    pid_t pid;
+    int ret = 0;
+
+    samples = malloc((size_t)round_trips * sizeof(*samples));
+    if (samples == NULL) {
+        perror("malloc");
+        return -1;
+    }
+    if (ipc_channel_open(&request, transport) < 0) {
+        free(samples);
+        return -1;
+    }
+    if (ipc_channel_open(&reply, transport) < 0) {
+        ipc_channel_close(&request);
+        free(samples);
+        return -1;
+    }
+
+    fflush(stdout);
+    pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        ipc_channel_close(&request);
+        ipc_channel_close(&reply);
+        free(samples);
+        return -1;
+    }
+
+    if (pid == 0) {
+        // Child: echo every request
+        ssize_t n;
+
+        ipc_channel_set_role(&request, IPC_ROLE_RECEIVER);
+        ipc_channel_set_role(&reply, IPC_ROLE_SENDER);
+        while ((n = ipc_receive(&request, buffer, sizeof(buffer))) > 0) {
+            if (ipc_send(&reply, buffer, (size_t)n) < 0) {
+                break;
+            }
+        }
+        ipc_channel_close(&request);
+        ipc_channel_close(&reply);
+        _exit(EXIT_SUCCESS);
+    }
+
+    ipc_channel_set_role(&request, IPC_ROLE_SENDER);
+    ipc_channel_set_role(&reply, IPC_ROLE_RECEIVER);
+    memset(buffer, 'p', sizeof(buffer));
+
+    for (long i = -IPC_WARMUP; i < round_trips; i++) {
+        uint64_t start = bench_now_ns();
+
+        if (ipc_send(&request, buffer, sizeof(buffer)) < 0 ||
+            ipc_receive(&reply, buffer, sizeof(buffer)) != IPC_MESSAGE_SIZE) {
+            fprintf(stderr, "ipc: %s round trip %ld failed\n", ipc_transport_name(transport), i);
+            ret = -1;
+            break;
+        }
+        if (i >= 0) {
+            samples[i] = (double)(bench_now_ns() - start) / 1e3;
+        }
+    }
+
+    ipc_channel_close(&request);
+    ipc_channel_close(&reply);
+    waitpid(pid, NULL, 0);
+
+    if (ret == 0) {
+        char prefix[BENCH_SCENARIO_MAX];
+        char description[BENCH_DESCRIPTION_MAX];
+
+        snprintf(prefix, sizeof(prefix), "ipc.%s.round_trip", ipc_transport_name(transport));
+        snprintf(description, sizeof(description), "%s channel, %d-byte ping-pong",
+                 ipc_transport_name(transport), IPC_MESSAGE_SIZE);
+        bench_report_latency(prefix, samples, (size_t)round_trips, description);
+    }
+    free(samples);
+    return ret;
+}
+
+int bench_ipc(const bench_options_t *opts) {
+    long round_trips = bench_iterations(opts, 100000);
+
+    if (time_round_trips(IPC_TRANSPORT_PIPE, round_trips) < 0 ||
+        time_round_trips(IPC_TRANSPORT_SHM, round_trips) < 0) {
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,465 @@
+/**
+ * @file bench-net.c
+ * @brief Loopback load generator for the networking servers
+ *
+ * Starts the real server binaries from ../networking on a free port and
+ * drives them over 127.0.0.1:
+ * - tcp: NET_CONNECTIONS connections against tcp-server (epoll engine),
+ *   each keeping one NET_MESSAGE_SIZE echo outstanding (closed loop).
+ *   Latency is send-to-full-echo per message.
+ * - udp: udp-multicast receives on a group while the generator sends
+ *   timestamped datagrams to it and, as a second member of the group,
+ *   times their loopback delivery. The receiver is load on the same
+ *   socket path; it does not reply, so this is one-way latency.
+ *
+ * Server output goes to /dev/null.
+ */
+
+#define _GNU_SOURCE     /* usleep, kill, inet_aton */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include "bench.h"
+
+#define NET_CONNECTIONS     8
+#define NET_MESSAGE_SIZE    64
+#define NET_MCAST_GROUP     "239.255.77.77"
+#define NET_START_RETRIES   100         /* x 20 ms while the server starts */
+#define NET_IO_TIMEOUT_MS   5000
+#define NET_MAX_LOSS        100         /* Tolerate 1 in 100 datagrams lost */
+
+extern char **environ;
+
+/* Datagram body: sequence number and send time */
+typedef struct {
+    uint64_t seq;
+    uint64_t sent_ns;
+} net_probe_t;
+
+typedef struct {
+    int fd;
+    uint64_t sent_ns;
+    size_t received;
+} net_conn_t;
+
+/**
+ * @brief Ask the kernel for a currently unused loopback port
+ * @return Port number, or 0 on error
+ */
+static uint16_t free_port(int type) {
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    uint16_t port = 0;
+    int fd = socket(AF_INET, type, 0);
+
+    if (fd < 0) {
+        perror("socket");
+        return 0;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0 &&
+        getsockname(fd, (struct sockaddr *)&addr, &len) == 0) {
+        port = ntohs(addr.sin_port);
+    } else {
+        perror("bind");
+    }
+    close(fd);
+    return port;
+}
+
+/**
+ * @brief Start a server binary with stdout and stderr on /dev/null
+ * @return Server PID, or -1 on error
+ */
+static pid_t start_server(char *const argv[]) {
+    posix_spawn_file_actions_t actions;
+    pid_t pid;
+    int ret;
+
+    if (access(argv[0], X_OK) != 0) {
+        fprintf(stderr, "net: %s not built (make -C ../networking)\n", argv[0]);
+        return -1;
+    }
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, STDERR_FILENO);
+    ret = posix_spawn(&pid, argv[0], &actions, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (ret != 0) {
+        fprintf(stderr, "posix_spawn %s: %s\n", argv[0], strerror(ret));
+        return -1;
+    }
+    return pid;
+}
+
+/**
+ * @brief Ask a server to shut down and reap it
+ * @return 0 if it was still running and exited cleanly, -1 otherwise
+ */
+static int stop_server(pid_t pid) {
+    int status;
+
+    if (waitpid(pid, &status, WNOHANG) == pid) {
+        fprintf(stderr, "net: server %d exited during the run\n", pid);
+        return -1;
+    }
+    kill(pid, SIGTERM);
+    if (waitpid(pid, &status, 0) < 0) {
+        perror("waitpid");
+        return -1;
+    }
+    return (WIFEXITED(status) || (WIFSIGNALED(status) && WTERMSIG(status) == SIGTERM)) ? 0 : -1;
+}
+
+/**
+ * @brief Connect to 127.0.0.1:port, retrying while the server starts
+ * @return Connected socket, or -1 on error
+ */
+static int connect_with_retry(uint16_t port) {
+    struct sockaddr_in addr;
+    int one = 1;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+
+    for (int attempt = 0; attempt < NET_START_RETRIES; attempt++) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+        if (fd < 0) {
+            perror("socket");
+            return -1;
+        }
+        if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+            /* Small echoes must not wait for Nagle */
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            return fd;
+        }
+        close(fd);
+        if (errno != ECONNREFUSED) {
+            perror("connect");
+            return -1;
+        }
+        usleep(20000);
+    }
+    fprintf(stderr, "net: server on port %u did not start\n", port);
+    return -1;
+}
+
+/**
+ * @brief Closed-loop echo load: one request outstanding per connection
+ * @return 0 on success, -1 on error
+ */
+static int tcp_load(uint16_t port, long requests, double *samples, double *seconds) {
+    net_conn_t conns[NET_CONNECTIONS];
+    struct pollfd pfds[NET_CONNECTIONS];
+    char message[NET_MESSAGE_SIZE];
+    char reply[NET_MESSAGE_SIZE];
+    long issued = 0;
+    long completed = 0;
+    int opened = 0;
+    int ret = 0;
+
+    memset(message, 'e', sizeof(message));
+    for (; opened < NET_CONNECTIONS; opened++) {
+        conns[opened].fd = connect_with_retry(port);
+        if (conns[opened].fd < 0) {
+            ret = -1;
+            goto out;
+        }
+        conns[opened].received = 0;
+        pfds[opened].fd = conns[opened].fd;
+        pfds[opened].events = POLLIN;
+    }
+
+    uint64_t start = bench_now_ns();
+    for (int i = 0; i < NET_CONNECTIONS && issued < requests; i++, issued++) {
+        conns[i].sent_ns = bench_now_ns();
+        if (send(conns[i].fd, message, sizeof(message), MSG_NOSIGNAL) != (ssize_t)sizeof(message)) {
+            perror("send");
+            ret = -1;
+            goto out;
+        }
+    }
+
+    while (completed < requests) {
+        int ready = poll(pfds, NET_CONNECTIONS, NET_IO_TIMEOUT_MS);
+
+        if (ready <= 0) {
+            fprintf(stderr, "net: tcp echo %s\n", ready == 0 ? "timed out" : strerror(errno));
+            ret = -1;
+            goto out;
+        }
+        for (int i = 0; i < NET_CONNECTIONS; i++) {
+            net_conn_t *conn = &conns[i];
+
+            if (pfds[i].revents == 0) {
+                continue;
+            }
+            ssize_t n = recv(conn->fd, reply, sizeof(reply) - conn->received, 0);
+            if (n <= 0) {
+                fprintf(stderr, "net: tcp connection %d %s\n", i, n == 0 ? "closed" : strerror(errno));
+                ret = -1;
+                goto out;
+            }
+            conn->received += (size_t)n;
+            if (conn->received < NET_MESSAGE_SIZE) {
+                continue;
+            }
+
+            uint64_t now = bench_now_ns();
+            samples[completed++] = (double)(now - conn->sent_ns) / 1e3;
+            conn->received = 0;
+            if (issued < requests) {
+                conn->sent_ns = now;
+                if (send(conn->fd, message, sizeof(message), MSG_NOSIGNAL) != (ssize_t)sizeof(message)) {
+                    perror("send");
+                    ret = -1;
+                    goto out;
+                }
+                issued++;
+            }
+        }
+    }
+    *seconds = bench_seconds_since(start);
+
+out:
+    for (int i = 0; i < opened; i++) {
+        close(conns[i].fd);
+    }
+    return ret;
+}
+
+static int bench_tcp(const bench_options_t *opts) {
+    long requests = bench_iterations(opts, 200000);
+    double *samples = malloc((size_t)requests * sizeof(*samples));
+    char path[512];
+    char port_arg[8];
+    uint16_t port = free_port(SOCK_STREAM);
+    double seconds = 0.0;
+    pid_t server;
+    int ret;
+
+    if (samples == NULL) {
+        perror("malloc");
+        return -1;
+    }
+    if (port == 0) {
+        free(samples);
+        return -1;
+    }
+    snprintf(path, sizeof(path), "%s/tcp-server", opts->networking_dir);
+    snprintf(port_arg, sizeof(port_arg), "%u", port);
+    char *argv[] = {path, "--engine", "epoll", port_arg, NULL};
+
+    server = start_server(argv);
+    if (server < 0) {
+        free(samples);
+        return -1;
+    }
+    ret = tcp_load(port, requests, samples, &seconds);
+    if (stop_server(server) < 0) {
+        ret = -1;
+    }
+
+    if (ret == 0) {
+        char description[BENCH_DESCRIPTION_MAX];
+
+        bench_report("net.tcp.echo.rate", "k msgs/s", true, (double)requests / seconds / 1e3,
+                     "tcp-server epoll engine, %d connections, %d-byte echoes",
+                     NET_CONNECTIONS, NET_MESSAGE_SIZE);
+        snprintf(description, sizeof(description), "tcp-server echo round trip, %d connections",
+                 NET_CONNECTIONS);
+        bench_report_latency("net.tcp.echo", samples, (size_t)requests, description);
+    }
+    free(samples);
+    return ret;
+}
+
+/**
+ * @brief Join the group on loopback as a second receiver
+ * @return Socket, or -1 on error
+ */
+static int udp_open_member(uint16_t port) {
+    struct sockaddr_in addr;
+    struct ip_mreq mreq;
+    struct timeval timeout = {0, 200000};
+    int reuse = 1;
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    memset(&mreq, 0, sizeof(mreq));
+    inet_aton(NET_MCAST_GROUP, &mreq.imr_multiaddr);
+    mreq.imr_interface.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) < 0 ||
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) < 0 ||
+        bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+        perror("net: udp member");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Sender socket that multicasts out of the loopback interface
+ * @return Socket, or -1 on error
+ */
+static int udp_open_sender(void) {
+    struct in_addr loopback;
+    unsigned char loop = 1;
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    loopback.s_addr = htonl(INADDR_LOOPBACK);
+    if (setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &loopback, sizeof(loopback)) < 0 ||
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) < 0) {
+        perror("net: udp sender");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Send probes one at a time and time each one's delivery
+ * @return Probes delivered, or -1 on error
+ */
+static long udp_load(uint16_t port, long probes, double *samples, double *seconds) {
+    struct sockaddr_in group;
+    long delivered = 0;
+    long lost = 0;
+    int tx = udp_open_sender();
+    int rx = udp_open_member(port);
+
+    if (tx < 0 || rx < 0) {
+        if (tx >= 0) {
+            close(tx);
+        }
+        if (rx >= 0) {
+            close(rx);
+        }
+        return -1;
+    }
+    memset(&group, 0, sizeof(group));
+    group.sin_family = AF_INET;
+    inet_aton(NET_MCAST_GROUP, &group.sin_addr);
+    group.sin_port = htons(port);
+
+    uint64_t start = bench_now_ns();
+    for (long seq = 0; seq < probes; seq++) {
+        net_probe_t probe = {(uint64_t)seq, bench_now_ns()};
+        net_probe_t echo;
+
+        if (sendto(tx, &probe, sizeof(probe), 0, (struct sockaddr *)&group, sizeof(group)) < 0) {
+            perror("sendto");
+            break;
+        }
+        /* Skip anything older than this probe, e.g. ones that arrived late */
+        do {
+            if (recv(rx, &echo, sizeof(echo), 0) != (ssize_t)sizeof(echo)) {
+                echo.seq = UINT64_MAX;
+                break;
+            }
+        } while (echo.seq < probe.seq);
+
+        if (echo.seq == probe.seq) {
+            samples[delivered++] = (double)(bench_now_ns() - probe.sent_ns) / 1e3;
+        } else {
+            lost++;
+        }
+    }
+    *seconds = bench_seconds_since(start);
+    close(tx);
+    close(rx);
+
+    if (delivered == 0 || lost * NET_MAX_LOSS > probes) {
+        fprintf(stderr, "net: udp delivered %ld of %ld probes\n", delivered, probes);
+        return -1;
+    }
+    return delivered;
+}
+
+static int bench_udp(const bench_options_t *opts) {
+    long probes = bench_iterations(opts, 100000);
+    double *samples = malloc((size_t)probes * sizeof(*samples));
+    char path[512];
+    char port_arg[8];
+    uint16_t port = free_port(SOCK_DGRAM);
+    double seconds = 0.0;
+    long delivered;
+    pid_t server;
+    int ret = 0;
+
+    if (samples == NULL) {
+        perror("malloc");
+        return -1;
+    }
+    if (port == 0) {
+        free(samples);
+        return -1;
+    }
+    snprintf(path, sizeof(path), "%s/udp-multicast", opts->networking_dir);
+    snprintf(port_arg, sizeof(port_arg), "%u", port);
+    char *argv[] = {path, "recv", NET_MCAST_GROUP, port_arg, NULL};
+
+    server = start_server(argv);
+    if (server < 0) {
+        free(samples);
+        return -1;
+    }
+    usleep(200000);     /* No handshake: give the receiver time to join */
+
+    delivered = udp_load(port, probes, samples, &seconds);
+    if (stop_server(server) < 0 || delivered < 0) {
+        ret = -1;
+    }
+
+    if (ret == 0) {
+        bench_report("net.udp.multicast.rate", "k msgs/s", true, (double)delivered / seconds / 1e3,
+                     "%zu-byte probes to %s with udp-multicast receiving",
+                     sizeof(net_probe_t), NET_MCAST_GROUP);
+        bench_report_latency("net.udp.multicast", samples, (size_t)delivered,
+                             "udp-multicast group, loopback delivery");
+    }
+    free(samples);
+    return ret;
+}
+
+int bench_net(const bench_options_t *opts) {
+    signal(SIGPIPE, SIG_IGN);
+
+    if (bench_tcp(opts) < 0 || bench_udp(opts) < 0) {
+        return -1;
+    }
+    return 0;
+}
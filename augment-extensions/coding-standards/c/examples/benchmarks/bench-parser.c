@@ -0,0 +1,224 @@
+/**
+ * @file bench-parser.c
+ * @brief Protocol parser and checksum kernel benchmarks
+ *
+ * protocol-parser.c is a single-file example whose functions are all
+ * static, so it is compiled into this file with its main() renamed. The
+ * benchmarks therefore run exactly the code the example ships.
+ *
+ * Parser workload: a 64 KiB stream of back-to-back v1 and v2 messages with
+ * 16-512 byte payloads, delivered in 1460-byte reads (one TCP segment) so
+ * frames straddle reads as they do on a socket.
+ */
+
+#define main protocol_parser_main
+#include "../networking/protocol-parser.c"
+#undef main
+
+#include "bench.h"
+
+#define PARSER_STREAM_SIZE  (64 * 1024)
+#define PARSER_READ_SIZE    1460
+#define PARSER_REPEATS      5           /* Best of, like the checksum kernels */
+#define CHECKSUM_BLOCK      MAX_PAYLOAD_SIZE
+#define CHECKSUM_REPEATS    5           /* Best of: a shared CPU adds noise */
+
+/**
+ * @brief Fill stream with complete messages
+ * @return Bytes used; *messages receives the message count
+ */
+static size_t build_stream(uint8_t *stream, size_t size, size_t *messages) {
+    uint8_t payload[MAX_PAYLOAD_SIZE];
+    uint32_t seed = 2463534242u;
+    size_t used = 0;
+
+    *messages = 0;
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)(i * 31 + 7);
+    }
+
+    for (;;) {
+        seed = seed * 1103515245u + 12345u;
+        uint16_t length = (uint16_t)(16 + (seed >> 16) % 497);
+        protocol_version_t version = (*messages % 4 == 3) ? PROTOCOL_V2 : PROTOCOL_V1;
+        size_t n = create_message_with_version(stream + used, size - used, version,
+                                               MSG_TYPE_DATA, payload, length);
+        if (n == 0) {
+            return used;
+        }
+        used += n;
+        (*messages)++;
+    }
+}
+
+/**
+ * @brief Parse the stream passes times, best of PARSER_REPEATS runs
+ * @param use_buffer parser_process_buffer() in reads, else parser_process_byte()
+ * @return Seconds for the fastest run, or -1 if a message was lost
+ */
+static double time_parser(bool use_buffer, const uint8_t *stream, size_t stream_len,
+                          size_t stream_messages, long passes) {
+    double best = -1.0;
+
+    for (int repeat = 0; repeat < PARSER_REPEATS; repeat++) {
+        parser_context_t parser;
+        size_t parsed = 0;
+
+        parser_init(&parser);
+        uint64_t start = bench_now_ns();
+        for (long pass = 0; pass < passes; pass++) {
+            if (use_buffer) {
+                /* Headers decoded in one step, payloads delivered as views */
+                for (size_t offset = 0; offset < stream_len; offset += PARSER_READ_SIZE) {
+                    size_t len = stream_len - offset;
+
+                    if (len > PARSER_READ_SIZE) {
+                        len = PARSER_READ_SIZE;
+                    }
+                    parsed += parser_process_buffer(&parser, stream + offset, len, NULL);
+                }
+            } else {
+                /* The state machine sees every byte */
+                for (size_t i = 0; i < stream_len; i++) {
+                    if (parser_process_byte(&parser, stream[i])) {
+                        parsed++;
+                    }
+                }
+            }
+        }
+        double seconds = bench_seconds_since(start);
+        parser_destroy(&parser);
+
+        if (parsed != stream_messages * (size_t)passes) {
+            fprintf(stderr, "parser: %s API parsed %zu of %zu messages\n",
+                    use_buffer ? "buffer" : "byte", parsed, stream_messages * (size_t)passes);
+            return -1.0;
+        }
+        if (best < 0 || seconds < best) {
+            best = seconds;
+        }
+    }
+    return best;
+}
+
+int bench_parser(const bench_options_t *opts) {
+    static uint8_t stream[PARSER_STREAM_SIZE];
+    size_t stream_messages;
+    size_t stream_len = build_stream(stream, sizeof(stream), &stream_messages);
+    long passes = bench_iterations(opts, 400);
+    double mb = (double)stream_len * (double)passes / 1e6;
+    double msgs = (double)stream_messages * (double)passes;
+    double seconds;
+
+    seconds = time_parser(false, stream, stream_len, stream_messages, passes);
+    if (seconds < 0) {
+        return -1;
+    }
+    bench_report("parser.byte.throughput", "MB/s", true, mb / seconds,
+                 "parser_process_byte() over a %zu-byte stream", stream_len);
+    bench_report("parser.byte.rate", "M msgs/s", true, msgs / seconds / 1e6,
+                 "parser_process_byte(), %zu messages per stream", stream_messages);
+
+    seconds = time_parser(true, stream, stream_len, stream_messages, passes);
+    if (seconds < 0) {
+        return -1;
+    }
+    bench_report("parser.buffer.throughput", "MB/s", true, mb / seconds,
+                 "parser_process_buffer() in %d-byte reads", PARSER_READ_SIZE);
+    bench_report("parser.buffer.rate", "M msgs/s", true, msgs / seconds / 1e6,
+                 "parser_process_buffer(), %zu messages per stream", stream_messages);
+    return 0;
+}
+
+/**
+ * @brief Time one XOR checksum kernel over CHECKSUM_BLOCK-byte payloads
+ */
+static void time_checksum(const char *name, checksum_kernel_t kernel,
+                          const uint8_t *data, long calls) {
+    /* Called through a pointer, as calculate_checksum() does, not inlined */
+    checksum_kernel_t volatile call = kernel;
+    char scenario[BENCH_SCENARIO_MAX];
+    double seconds = 0.0;
+    uint64_t acc = 0;
+
+    for (int repeat = 0; repeat < CHECKSUM_REPEATS; repeat++) {
+        uint64_t start = bench_now_ns();
+
+        for (long i = 0; i < calls; i++) {
+            /* Step the start so every alignment in a vector is covered */
+            acc += call(data + (i & 31), CHECKSUM_BLOCK);
+        }
+        double elapsed = bench_seconds_since(start);
+        if (repeat == 0 || elapsed < seconds) {
+            seconds = elapsed;
+        }
+    }
+
+    bench_consume(acc);
+    snprintf(scenario, sizeof(scenario), "checksum.xor_%s.throughput", name);
+    bench_report(scenario, "GB/s", true, (double)calls * CHECKSUM_BLOCK / seconds / 1e9,
+                 "XOR checksum, %s kernel, %d-byte payloads", name, CHECKSUM_BLOCK);
+}
+
+/**
+ * @brief Time one CRC32C kernel over CHECKSUM_BLOCK-byte payloads
+ */
+static void time_crc32c(const char *name, crc32c_kernel_t kernel,
+                        const uint8_t *data, long calls) {
+    crc32c_kernel_t volatile call = kernel;
+    char scenario[BENCH_SCENARIO_MAX];
+    double seconds = 0.0;
+    uint64_t acc = 0;
+
+    for (int repeat = 0; repeat < CHECKSUM_REPEATS; repeat++) {
+        uint64_t start = bench_now_ns();
+
+        for (long i = 0; i < calls; i++) {
+            acc += call(~0u, data + (i & 31), CHECKSUM_BLOCK);
+        }
+        double elapsed = bench_seconds_since(start);
+        if (repeat == 0 || elapsed < seconds) {
+            seconds = elapsed;
+        }
+    }
+
+    bench_consume(acc);
+    snprintf(scenario, sizeof(scenario), "checksum.crc32c_%s.throughput", name);
+    bench_report(scenario, "GB/s", true, (double)calls * CHECKSUM_BLOCK / seconds / 1e9,
+                 "CRC32C, %s kernel, %d-byte payloads", name, CHECKSUM_BLOCK);
+}
+
+int bench_checksum(const bench_options_t *opts) {
+    static uint8_t data[CHECKSUM_BLOCK + 32];
+    long calls = bench_iterations(opts, 400000);
+    uint32_t seed = 12345;
+
+    for (size_t i = 0; i < sizeof(data); i++) {
+        seed = seed * 1103515245u + 12345u;
+        data[i] = (uint8_t)(seed >> 16);
+    }
+
+    time_checksum("bytewise", checksum_bytewise, data, calls);
+    time_checksum("word", checksum_word, data, calls);
+#if defined(CHECKSUM_HAVE_X86)
+    time_checksum("sse2", checksum_sse2, data, calls);
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        time_checksum("avx2", checksum_avx2, data, calls);
+    }
+#elif defined(CHECKSUM_HAVE_NEON)
+    time_checksum("neon", checksum_neon, data, calls);
+#endif
+
+    time_crc32c("slicing8", crc32c_sw, data, calls);
+#if defined(CHECKSUM_HAVE_X86)
+    if (__builtin_cpu_supports("sse4.2")) {
+        time_crc32c("sse42", crc32c_sse42, data, calls);
+    }
+#elif defined(CRC32C_HAVE_ARM)
+    if ((getauxval(AT_HWCAP) & HWCAP_CRC32) != 0) {
+        time_crc32c("armv8", crc32c_armv8, data, calls);
+    }
+#endif
+    return 0;
+}
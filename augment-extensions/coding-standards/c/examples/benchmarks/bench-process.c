@@ -0,0 +1,93 @@
+/**
+ * @file bench-process.c
+ * @brief fork()+execvp() vs. posix_spawnp() launch cost
+ *
+ * Compiles in systems/process-management.c (main() renamed) and launches
+ * 'true' through its spawn_process_fast(). The parent first touches
+ * PROCESS_RSS_MB of memory: fork() copies the page tables for all of it on
+ * every launch, posix_spawn() does not, which is the regression this
+ * guards against.
+ */
+
+#define main process_management_main
+#include "../systems/process-management.c"
+#undef main
+
+#include "bench.h"
+
+#define PROCESS_RSS_MB      64
+
+/**
+ * @brief Start 'true' once and wait for it
+ * @return Launch-to-exit time in microseconds, or -1 on error
+ */
+static double launch_once(bool use_spawn) {
+    char *args[] = {"true", NULL};
+    uint64_t start = bench_now_ns();
+    int status;
+    pid_t pid;
+
+    if (use_spawn) {
+        pid = spawn_process_fast(args[0], args);
+    } else {
+        pid = fork();
+        if (pid == 0) {
+            execvp(args[0], args);
+            _exit(127);
+        }
+        if (pid < 0) {
+            perror("fork");
+        }
+    }
+
+    if (pid < 0 || waitpid(pid, &status, 0) < 0 ||
+        !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        return -1.0;
+    }
+    return (double)(bench_now_ns() - start) / 1e3;
+}
+
+int bench_process(const bench_options_t *opts) {
+    size_t size = (size_t)PROCESS_RSS_MB * 1024 * 1024;
+    long page = sysconf(_SC_PAGESIZE);
+    long launches = bench_iterations(opts, 1000);
+    char *ballast = malloc(size);
+    double *samples = malloc((size_t)launches * sizeof(*samples));
+    int ret = 0;
+
+    if (ballast == NULL || samples == NULL) {
+        perror("malloc");
+        free(ballast);
+        free(samples);
+        return -1;
+    }
+    for (size_t off = 0; off < size; off += (size_t)page) {
+        ballast[off] = 1;
+    }
+
+    fflush(stdout);
+    for (int method = 0; method < 2 && ret == 0; method++) {
+        bool use_spawn = (method == 1);
+
+        for (long i = 0; i < launches; i++) {
+            samples[i] = launch_once(use_spawn);
+            if (samples[i] < 0) {
+                fprintf(stderr, "process: launch %ld failed\n", i);
+                ret = -1;
+                break;
+            }
+        }
+        if (ret == 0) {
+            char description[BENCH_DESCRIPTION_MAX];
+
+            snprintf(description, sizeof(description), "%s of 'true' from a %d MiB parent",
+                     use_spawn ? "posix_spawnp()" : "fork()+execvp()", PROCESS_RSS_MB);
+            bench_report_latency(use_spawn ? "process.posix_spawn.launch" : "process.fork_exec.launch",
+                                 samples, (size_t)launches, description);
+        }
+    }
+
+    free(ballast);
+    free(samples);
+    return ret;
+}
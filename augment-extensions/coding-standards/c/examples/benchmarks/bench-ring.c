@@ -0,0 +1,147 @@
+/**
+ * @file bench-ring.c
+ * @brief SPSC ring benchmarks (common/spsc-ring.h)
+ *
+ * - byte:     spsc_ring_write()/spsc_ring_read() one byte at a time, the
+ *             UART ISR pattern; an op is one call
+ * - bulk:     spsc_ring_write_n()/spsc_ring_read_n() in 64-byte chunks
+ * - threaded: producer and consumer threads, so the index cache lines
+ *             really move between cores (or between time slices on one)
+ */
+
+#define _GNU_SOURCE     /* sched_yield */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+
+#include "../common/spsc-ring.h"
+#include "bench.h"
+
+#define RING_SIZE       4096
+#define RING_CHUNK      64
+
+SPSC_RING_ASSERT_SIZE(RING_SIZE);
+
+typedef struct {
+    spsc_ring_t ring;
+    long bytes;             /* Total to move */
+    uint64_t checksum;      /* Consumer's sum of every byte read */
+} ring_pipe_t;
+
+static void *ring_producer(void *arg) {
+    ring_pipe_t *p = arg;
+    uint8_t chunk[RING_CHUNK];
+    long sent = 0;
+
+    for (size_t i = 0; i < sizeof(chunk); i++) {
+        chunk[i] = (uint8_t)i;
+    }
+    while (sent < p->bytes) {
+        uint32_t n = spsc_ring_write_n(&p->ring, chunk, RING_CHUNK);
+
+        if (n == 0) {
+            sched_yield();  /* Full: let the consumer run */
+        }
+        sent += n;
+    }
+    return NULL;
+}
+
+static void *ring_consumer(void *arg) {
+    ring_pipe_t *p = arg;
+    uint8_t chunk[RING_CHUNK];
+    long received = 0;
+
+    while (received < p->bytes) {
+        uint32_t n = spsc_ring_read_n(&p->ring, chunk, RING_CHUNK);
+
+        if (n == 0) {
+            sched_yield();
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            p->checksum += chunk[i];
+        }
+        received += n;
+    }
+    return NULL;
+}
+
+int bench_ring(const bench_options_t *opts) {
+    static uint8_t storage[RING_SIZE];
+    spsc_ring_t ring;
+    uint8_t chunk[RING_CHUNK] = {0};
+    uint64_t acc = 0;
+    uint64_t start;
+    double seconds;
+
+    /* One byte per call, a ring's worth in and out per round */
+    long rounds = bench_iterations(opts, 40000);
+    spsc_ring_init(&ring, storage, sizeof(storage));
+    start = bench_now_ns();
+    for (long r = 0; r < rounds; r++) {
+        uint8_t byte;
+
+        for (uint32_t i = 0; i < RING_SIZE; i++) {
+            spsc_ring_write(&ring, (uint8_t)i);
+        }
+        while (spsc_ring_read(&ring, &byte)) {
+            acc += byte;
+        }
+    }
+    seconds = bench_seconds_since(start);
+    bench_consume(acc);
+    bench_report("ring.byte.rate", "M ops/s", true,
+                 2.0 * RING_SIZE * (double)rounds / seconds / 1e6,
+                 "spsc_ring_write()/spsc_ring_read(), one byte per op");
+
+    /* 64-byte chunks */
+    spsc_ring_init(&ring, storage, sizeof(storage));
+    start = bench_now_ns();
+    for (long r = 0; r < rounds * 4; r++) {
+        while (spsc_ring_write_n(&ring, chunk, RING_CHUNK) == RING_CHUNK) {
+        }
+        while (spsc_ring_read_n(&ring, chunk, RING_CHUNK) > 0) {
+            acc += chunk[0];
+        }
+    }
+    seconds = bench_seconds_since(start);
+    bench_consume(acc);
+    bench_report("ring.bulk.rate", "M ops/s", true,
+                 2.0 * (RING_SIZE / RING_CHUNK) * (double)rounds * 4 / seconds / 1e6,
+                 "spsc_ring_write_n()/spsc_ring_read_n(), %d bytes per op", RING_CHUNK);
+
+    /* Producer and consumer on their own threads */
+    ring_pipe_t pipe_state;
+    pthread_t producer;
+    pthread_t consumer;
+
+    spsc_ring_init(&pipe_state.ring, storage, sizeof(storage));
+    pipe_state.bytes = bench_iterations(opts, 400L * 1024 * 1024);
+    pipe_state.checksum = 0;
+    start = bench_now_ns();
+    if (pthread_create(&consumer, NULL, ring_consumer, &pipe_state) != 0) {
+        fprintf(stderr, "ring: pthread_create failed\n");
+        return -1;
+    }
+    if (pthread_create(&producer, NULL, ring_producer, &pipe_state) != 0) {
+        fprintf(stderr, "ring: pthread_create failed\n");
+        ring_producer(&pipe_state);     /* Feed the consumer so it can finish */
+        pthread_join(consumer, NULL);
+        return -1;
+    }
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+    seconds = bench_seconds_since(start);
+
+    /* Every chunk is 0..63, so the sum is known */
+    uint64_t expected = (uint64_t)(pipe_state.bytes / RING_CHUNK) * (RING_CHUNK * (RING_CHUNK - 1) / 2);
+    if (pipe_state.checksum != expected) {
+        fprintf(stderr, "ring: consumer checksum mismatch\n");
+        return -1;
+    }
+    bench_report("ring.threaded.throughput", "MB/s", true,
+                 (double)pipe_state.bytes / seconds / 1e6,
+                 "producer and consumer threads, %d-byte chunks", RING_CHUNK);
+    return 0;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file bench.c
+ * @brief Timing, statistics and result output for the benchmark suites
+ */
+
+#define _GNU_SOURCE     /* CLOCK_MONOTONIC, vsnprintf */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench.h"
+
+static bench_result_t results[BENCH_MAX_RESULTS];
+static size_t result_count = 0;
+
+/* Written through a volatile so the compiler has to produce every value */
+static volatile uint64_t bench_sink;
+
+uint64_t bench_now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+double bench_seconds_since(uint64_t start_ns) {
+    return (double)(bench_now_ns() - start_ns) / 1e9;
+}
+
+long bench_iterations(const bench_options_t *opts, long full) {
+    long n = opts->quick ? full / 10 : full;
+
+    return n > 0 ? n : 1;
+}
+
+void bench_consume(uint64_t v) {
+    bench_sink ^= v;
+}
+
+void bench_report(const char *scenario, const char *unit, bool higher_is_better,
+                  double value, const char *description, ...) {
+    bench_result_t *result;
+    va_list ap;
+
+    if (result_count == BENCH_MAX_RESULTS) {
+        fprintf(stderr, "bench: too many results, dropping %s\n", scenario);
+        return;
+    }
+    result = &results[result_count++];
+
+    snprintf(result->scenario, sizeof(result->scenario), "%s", scenario);
+    va_start(ap, description);
+    vsnprintf(result->description, sizeof(result->description), description, ap);
+    va_end(ap);
+    result->unit = unit;
+    result->value = value;
+    result->higher_is_better = higher_is_better;
+
+    printf("  %-38s %10.2f %-8s %s\n", result->scenario, value, unit, result->description);
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+void bench_sort(double *samples, size_t count) {
+    qsort(samples, count, sizeof(samples[0]), compare_doubles);
+}
+
+double bench_percentile(const double *sorted, size_t count, double p) {
+    double exact = p / 100.0 * (double)count;
+    size_t rank = (size_t)exact;
+
+    if (count == 0) {
+        return 0.0;
+    }
+    /* Nearest rank: the smallest sample with at least p% at or below it */
+    if ((double)rank < exact) {
+        rank++;
+    }
+    if (rank == 0) {
+        rank = 1;
+    }
+    if (rank > count) {
+        rank = count;
+    }
+    return sorted[rank - 1];
+}
+
+void bench_report_latency(const char *prefix, double *samples_us, size_t count,
+                          const char *description) {
+    char scenario[BENCH_SCENARIO_MAX];
+
+    bench_sort(samples_us, count);
+
+    snprintf(scenario, sizeof(scenario), "%s.p50_us", prefix);
+    bench_report(scenario, "us", false, bench_percentile(samples_us, count, 50.0),
+                 "%s, median of %zu", description, count);
+    snprintf(scenario, sizeof(scenario), "%s.p99_us", prefix);
+    bench_report(scenario, "us", false, bench_percentile(samples_us, count, 99.0),
+                 "%s, 99th percentile of %zu", description, count);
+}
+
+/**
+ * @brief Print s as a JSON string literal
+ */
+static void json_string(FILE *out, const char *s) {
+    fputc('"', out);
+    for (; *s != '\0'; s++) {
+        if (*s == '"' || *s == '\\') {
+            fputc('\\', out);
+            fputc(*s, out);
+        } else if ((unsigned char)*s < 0x20) {
+            fprintf(out, "\\u%04x", (unsigned)*s);
+        } else {
+            fputc(*s, out);
+        }
+    }
+    fputc('"', out);
+}
+
+int bench_write_json(const char *path, const bench_options_t *opts) {
+    FILE *out = stdout;
+
+    if (strcmp(path, "-") != 0) {
+        out = fopen(path, "w");
+        if (out == NULL) {
+            perror(path);
+            return -1;
+        }
+    }
+
+    fprintf(out, "{\n  \"suite\": \"c-examples\",\n  \"quick\": %s,\n  \"results\": [",
+            opts->quick ? "true" : "false");
+    for (size_t i = 0; i < result_count; i++) {
+        const bench_result_t *r = &results[i];
+
+        fprintf(out, "%s\n    {\n      \"scenario\": ", i == 0 ? "" : ",");
+        json_string(out, r->scenario);
+        fprintf(out, ",\n      \"description\": ");
+        json_string(out, r->description);
+        fprintf(out, ",\n      \"unit\": ");
+        json_string(out, r->unit);
+        fprintf(out, ",\n      \"value\": %.6g,\n      \"higher_is_better\": %s\n    }",
+                r->value, r->higher_is_better ? "true" : "false");
+    }
+    fprintf(out, "\n  ]\n}\n");
+
+    if (out != stdout && fclose(out) != 0) {
+        perror(path);
+        return -1;
+    }
+    return 0;
+}
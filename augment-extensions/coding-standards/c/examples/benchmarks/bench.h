@@ -0,0 +1,111 @@
+/**
+ * @file bench.h
+ * @brief Shared harness for the example benchmarks
+ *
+ * Each suite measures the example code itself, not a copy of it: the
+ * single-file examples are compiled into the suite with their main()
+ * renamed (see bench-parser.c), and the modules are linked as they are.
+ *
+ * A suite records every number with bench_report(). Scenario names are
+ * dotted, "<suite>.<case>.<metric>", and stay stable between releases:
+ * benchmarks/run-c-benchmarks.py matches them against
+ * benchmarks/baseline/c-examples.json to catch regressions.
+ *
+ * Usage:
+ *   uint64_t start = bench_now_ns();
+ *   ... run iterations ...
+ *   bench_report("ring.byte.rate", "M ops/s", true, ops / seconds / 1e6,
+ *                "spsc_ring_write() + spsc_ring_read(), one byte each");
+ */
+
+#ifndef BENCHMARKS_BENCH_H
+#define BENCHMARKS_BENCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define BENCH_MAX_RESULTS       64
+#define BENCH_SCENARIO_MAX      64
+#define BENCH_DESCRIPTION_MAX   160
+
+/* Set by the command line, passed to every suite */
+typedef struct {
+    bool quick;                     /* A tenth of the iterations, for CI */
+    const char *networking_dir;     /* Where tcp-server and udp-multicast live */
+} bench_options_t;
+
+typedef struct {
+    char scenario[BENCH_SCENARIO_MAX];
+    char description[BENCH_DESCRIPTION_MAX];
+    const char *unit;
+    double value;
+    bool higher_is_better;
+} bench_result_t;
+
+/**
+ * @brief Monotonic clock in nanoseconds
+ */
+uint64_t bench_now_ns(void);
+
+/**
+ * @brief Seconds elapsed since a bench_now_ns() timestamp
+ */
+double bench_seconds_since(uint64_t start_ns);
+
+/**
+ * @brief Iteration count for this run: full, or a tenth of it with --quick
+ */
+long bench_iterations(const bench_options_t *opts, long full);
+
+/**
+ * @brief Keep the optimizer from deleting the work that produced v
+ */
+void bench_consume(uint64_t v);
+
+/**
+ * @brief Record one measurement and print it
+ * @param scenario Stable dotted name, e.g. "parser.buffer.throughput"
+ * @param unit Unit of value, e.g. "MB/s" or "us"
+ * @param higher_is_better false for latencies and costs
+ * @param description printf-style description for reports
+ */
+void bench_report(const char *scenario, const char *unit, bool higher_is_better,
+                  double value, const char *description, ...)
+    __attribute__((format(printf, 5, 6)));
+
+/**
+ * @brief Report the p50 and p99 of latency samples in microseconds
+ *
+ * Records "<prefix>.p50_us" and "<prefix>.p99_us". Sorts samples in place.
+ */
+void bench_report_latency(const char *prefix, double *samples_us, size_t count,
+                          const char *description);
+
+/**
+ * @brief Nearest-rank percentile of sorted samples
+ * @param p Percentile in [0, 100]
+ */
+double bench_percentile(const double *sorted, size_t count, double p);
+
+/**
+ * @brief Sort samples in ascending order
+ */
+void bench_sort(double *samples, size_t count);
+
+/**
+ * @brief Write every recorded result as JSON ("-" for stdout)
+ * @return 0 on success, -1 on error
+ */
+int bench_write_json(const char *path, const bench_options_t *opts);
+
+/* ---- Suites; each returns 0 on success, -1 on error ---- */
+
+int bench_parser(const bench_options_t *opts);      /* bench-parser.c */
+int bench_checksum(const bench_options_t *opts);    /* bench-parser.c */
+int bench_ring(const bench_options_t *opts);        /* bench-ring.c */
+int bench_ipc(const bench_options_t *opts);         /* bench-ipc.c */
+int bench_process(const bench_options_t *opts);     /* bench-process.c */
+int bench_net(const bench_options_t *opts);         /* bench-net.c */
+
+#endif /* BENCHMARKS_BENCH_H */
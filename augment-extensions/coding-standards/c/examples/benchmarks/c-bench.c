@@ -0,0 +1,111 @@
+/**
+ * @file c-bench.c
+ * @brief Benchmark suite for the C examples
+ *
+ * Suites:
+ * - parser:   parser_process_byte() vs. parser_process_buffer(), MB/s and msgs/s
+ * - checksum: XOR checksum and CRC32C kernels, GB/s
+ * - ring:     spsc-ring.h operations per second, single- and two-threaded
+ * - ipc:      pipe vs. shared-memory channel round-trip p50/p99
+ * - process:  fork()+execvp() vs. posix_spawnp() launch p50/p99
+ * - net:      loopback load against tcp-server and udp-multicast, p50/p99
+ *
+ * Build: make
+ * Run:   ./c-bench [--quick] [--json FILE] [--networking-dir DIR] [suite...]
+ *        With no suite names every suite runs. benchmarks/run-c-benchmarks.py
+ *        (from the repository root) runs this and checks the results
+ *        against benchmarks/baseline/c-examples.json.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+
+typedef struct {
+    const char *name;
+    const char *title;
+    int (*run)(const bench_options_t *opts);
+} bench_suite_t;
+
+static const bench_suite_t suites[] = {
+    {"parser",   "Protocol parser throughput",           bench_parser},
+    {"checksum", "Checksum kernels",                     bench_checksum},
+    {"ring",     "SPSC ring operations",                 bench_ring},
+    {"ipc",      "Pipe vs. shared-memory IPC latency",   bench_ipc},
+    {"process",  "fork() vs. posix_spawn() launch cost", bench_process},
+    {"net",      "TCP/UDP loopback load",                bench_net},
+};
+
+#define NUM_SUITES (sizeof(suites) / sizeof(suites[0]))
+
+/**
+ * @brief Print command line usage
+ */
+static void print_usage(const char *program) {
+    fprintf(stderr, "Usage: %s [--quick] [--json FILE] [--networking-dir DIR] [suite...]\n",
+            program);
+    fprintf(stderr, "Suites:");
+    for (size_t i = 0; i < NUM_SUITES; i++) {
+        fprintf(stderr, " %s", suites[i].name);
+    }
+    fprintf(stderr, "\n");
+}
+
+int main(int argc, char *argv[]) {
+    bench_options_t opts = {false, "../networking"};
+    const char *json_path = NULL;
+    bool selected[NUM_SUITES] = {false};
+    bool any_selected = false;
+    int failed = 0;
+    int argi;
+
+    for (argi = 1; argi < argc && strncmp(argv[argi], "--", 2) == 0; argi++) {
+        if (strcmp(argv[argi], "--quick") == 0) {
+            opts.quick = true;
+        } else if (strcmp(argv[argi], "--json") == 0 && argi + 1 < argc) {
+            json_path = argv[++argi];
+        } else if (strcmp(argv[argi], "--networking-dir") == 0 && argi + 1 < argc) {
+            opts.networking_dir = argv[++argi];
+        } else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    for (; argi < argc; argi++) {
+        size_t i;
+
+        for (i = 0; i < NUM_SUITES; i++) {
+            if (strcmp(argv[argi], suites[i].name) == 0) {
+                selected[i] = true;
+                any_selected = true;
+                break;
+            }
+        }
+        if (i == NUM_SUITES) {
+            fprintf(stderr, "Unknown suite: %s\n", argv[argi]);
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    printf("C examples benchmark suite%s\n", opts.quick ? " (quick)" : "");
+    for (size_t i = 0; i < NUM_SUITES; i++) {
+        if (any_selected && !selected[i]) {
+            continue;
+        }
+        printf("\n%s\n", suites[i].title);
+        fflush(stdout);
+        if (suites[i].run(&opts) < 0) {
+            fprintf(stderr, "Suite %s failed\n", suites[i].name);
+            failed++;
+        }
+    }
+
+    if (json_path != NULL && bench_write_json(json_path, &opts) < 0) {
+        return EXIT_FAILURE;
+    }
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,307 @@
+/**
+ * @file compat-fast.h
+ * @brief Portable fast paths: strings, byte order and branch hints
+ *
+ * Header-only companion to legacy/compatibility-layer.c, usable from C89
+ * through C11. Each helper maps to a compiler builtin where one exists and
+ * falls back to plain C otherwise:
+ * - compat_strnlen() / compat_strlcpy(): scan and copy a word at a time
+ * - compat_bswap16/32/64(): __builtin_bswap*, _byteswap_*, or shifts
+ * - compat_load_be16/be32(), compat_store_be16/be32(), compat_load_le32():
+ *   unaligned-safe fixed-order access; one load, plus a byte swap when
+ *   the host order differs
+ * - COMPAT_LIKELY() / COMPAT_UNLIKELY() / COMPAT_PREFETCH()
+ *
+ * Usage:
+ *   uint16_t length = compat_load_be16(frame + 3);
+ *   compat_store_be32(header + 5, crc);
+ *   if (COMPAT_UNLIKELY(length > MAX_PAYLOAD_SIZE)) { ... }
+ */
+
+#ifndef EXAMPLES_COMPAT_FAST_H
+#define EXAMPLES_COMPAT_FAST_H
+
+#include <stddef.h>
+#include <string.h>
+#include <limits.h>
+
+#if defined(_MSC_VER)
+#include <stdlib.h>     /* _byteswap_* */
+#endif
+
+#ifndef COMPAT_INLINE
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
+#define COMPAT_INLINE inline
+#elif defined(__GNUC__)
+#define COMPAT_INLINE __inline__
+#elif defined(_MSC_VER)
+#define COMPAT_INLINE __inline
+#else
+#define COMPAT_INLINE
+#endif
+#endif
+
+/* ---- Fixed-width types (C89 has no stdint.h) ---- */
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
+#include <stdint.h>
+typedef uint16_t compat_u16;
+typedef uint32_t compat_u32;
+typedef uint64_t compat_u64;
+#define COMPAT_HAVE_U64 1
+#else
+typedef unsigned short compat_u16;
+#if UINT_MAX == 0xFFFFFFFFU
+typedef unsigned int compat_u32;
+#else
+typedef unsigned long compat_u32;
+#endif
+#if defined(_MSC_VER)
+typedef unsigned __int64 compat_u64;
+#define COMPAT_HAVE_U64 1
+#elif ULONG_MAX > 0xFFFFFFFFUL
+typedef unsigned long compat_u64;
+#define COMPAT_HAVE_U64 1
+#else
+#define COMPAT_HAVE_U64 0
+#endif
+#endif
+
+/* ---- Branch and cache hints ---- */
+
+#if defined(__GNUC__) || defined(__clang__)
+#define COMPAT_LIKELY(x)        __builtin_expect(!!(x), 1)
+#define COMPAT_UNLIKELY(x)      __builtin_expect(!!(x), 0)
+#define COMPAT_PREFETCH(addr)   __builtin_prefetch(addr)
+#else
+#define COMPAT_LIKELY(x)        (x)
+#define COMPAT_UNLIKELY(x)      (x)
+#define COMPAT_PREFETCH(addr)   ((void)(addr))
+#endif
+
+/* ---- Byte order ---- */
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__) && \
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define COMPAT_LITTLE_ENDIAN 1
+#elif defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && \
+    __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define COMPAT_BIG_ENDIAN 1
+#elif defined(_MSC_VER)
+#define COMPAT_LITTLE_ENDIAN 1      /* Every MSVC target */
+#endif
+
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 8)))
+#define COMPAT_HAVE_BUILTIN_BSWAP 1
+#endif
+
+static COMPAT_INLINE compat_u16 compat_bswap16(compat_u16 v) {
+#if defined(COMPAT_HAVE_BUILTIN_BSWAP)
+    return __builtin_bswap16(v);
+#elif defined(_MSC_VER)
+    return _byteswap_ushort(v);
+#else
+    return (compat_u16)((v >> 8) | (v << 8));
+#endif
+}
+
+static COMPAT_INLINE compat_u32 compat_bswap32(compat_u32 v) {
+#if defined(COMPAT_HAVE_BUILTIN_BSWAP)
+    return __builtin_bswap32(v);
+#elif defined(_MSC_VER)
+    return _byteswap_ulong(v);
+#else
+    return ((v & 0xFFU) << 24) | ((v & 0xFF00U) << 8) |
+           ((v >> 8) & 0xFF00U) | ((v >> 24) & 0xFFU);
+#endif
+}
+
+#if COMPAT_HAVE_U64
+static COMPAT_INLINE compat_u64 compat_bswap64(compat_u64 v) {
+#if defined(COMPAT_HAVE_BUILTIN_BSWAP)
+    return __builtin_bswap64(v);
+#elif defined(_MSC_VER)
+    return _byteswap_uint64(v);
+#else
+    return ((compat_u64)compat_bswap32((compat_u32)(v & 0xFFFFFFFFU)) << 32) |
+           compat_bswap32((compat_u32)(v >> 32));
+#endif
+}
+#endif
+
+/*
+ * memcpy() of a constant size compiles to a single (unaligned) load or
+ * store, so with a known byte order these are one instruction plus a
+ * swap. Unknown byte order falls back to assembling bytes.
+ */
+static COMPAT_INLINE compat_u16 compat_load_be16(const void *p) {
+#if defined(COMPAT_LITTLE_ENDIAN) || defined(COMPAT_BIG_ENDIAN)
+    compat_u16 v;
+    memcpy(&v, p, sizeof(v));
+#if defined(COMPAT_LITTLE_ENDIAN)
+    v = compat_bswap16(v);
+#endif
+    return v;
+#else
+    const unsigned char *b = (const unsigned char *)p;
+    return (compat_u16)((b[0] << 8) | b[1]);
+#endif
+}
+
+static COMPAT_INLINE compat_u32 compat_load_be32(const void *p) {
+#if defined(COMPAT_LITTLE_ENDIAN) || defined(COMPAT_BIG_ENDIAN)
+    compat_u32 v;
+    memcpy(&v, p, sizeof(v));
+#if defined(COMPAT_LITTLE_ENDIAN)
+    v = compat_bswap32(v);
+#endif
+    return v;
+#else
+    const unsigned char *b = (const unsigned char *)p;
+    return (compat_u32)b[0] << 24 | (compat_u32)b[1] << 16 | (compat_u32)b[2] << 8 | b[3];
+#endif
+}
+
+static COMPAT_INLINE compat_u32 compat_load_le32(const void *p) {
+#if defined(COMPAT_LITTLE_ENDIAN) || defined(COMPAT_BIG_ENDIAN)
+    compat_u32 v;
+    memcpy(&v, p, sizeof(v));
+#if defined(COMPAT_BIG_ENDIAN)
+    v = compat_bswap32(v);
+#endif
+    return v;
+#else
+    const unsigned char *b = (const unsigned char *)p;
+    return (compat_u32)b[3] << 24 | (compat_u32)b[2] << 16 | (compat_u32)b[1] << 8 | b[0];
+#endif
+}
+
+static COMPAT_INLINE void compat_store_be16(void *p, compat_u16 v) {
+#if defined(COMPAT_LITTLE_ENDIAN) || defined(COMPAT_BIG_ENDIAN)
+#if defined(COMPAT_LITTLE_ENDIAN)
+    v = compat_bswap16(v);
+#endif
+    memcpy(p, &v, sizeof(v));
+#else
+    unsigned char *b = (unsigned char *)p;
+    b[0] = (unsigned char)(v >> 8);
+    b[1] = (unsigned char)v;
+#endif
+}
+
+static COMPAT_INLINE void compat_store_be32(void *p, compat_u32 v) {
+#if defined(COMPAT_LITTLE_ENDIAN) || defined(COMPAT_BIG_ENDIAN)
+#if defined(COMPAT_LITTLE_ENDIAN)
+    v = compat_bswap32(v);
+#endif
+    memcpy(p, &v, sizeof(v));
+#else
+    unsigned char *b = (unsigned char *)p;
+    b[0] = (unsigned char)(v >> 24);
+    b[1] = (unsigned char)(v >> 16);
+    b[2] = (unsigned char)(v >> 8);
+    b[3] = (unsigned char)v;
+#endif
+}
+
+/* ---- Strings ---- */
+
+/*
+ * Word-at-a-time scanning reads whole aligned words, which may include
+ * bytes past the terminator. An aligned word never straddles a page, so
+ * this cannot fault, but sanitizers report it: their builds scan bytes.
+ */
+#if defined(__SANITIZE_ADDRESS__)
+#define COMPAT_WORD_AT_A_TIME 0
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(memory_sanitizer)
+#define COMPAT_WORD_AT_A_TIME 0
+#endif
+#endif
+#ifndef COMPAT_WORD_AT_A_TIME
+#define COMPAT_WORD_AT_A_TIME 1
+#endif
+
+#define COMPAT_WORD_SIZE        sizeof(size_t)
+#define COMPAT_WORD_REPEAT(b)   (((size_t)-1 / 0xFF) * (b))
+
+/* Non-zero if any byte of the word is zero */
+#define COMPAT_WORD_HAS_ZERO(v) \
+    (((v) - COMPAT_WORD_REPEAT(0x01)) & ~(v) & COMPAT_WORD_REPEAT(0x80))
+
+#define COMPAT_WORD_ALIGNED(p)  (((size_t)(p) & (COMPAT_WORD_SIZE - 1)) == 0)
+
+/**
+ * @brief Length of s, looking at no more than maxlen bytes
+ */
+static COMPAT_INLINE size_t compat_strnlen(const char *s, size_t maxlen) {
+    size_t n = 0;
+
+#if COMPAT_WORD_AT_A_TIME
+    while (n < maxlen && !COMPAT_WORD_ALIGNED(s + n)) {
+        if (s[n] == '\0') {
+            return n;
+        }
+        n++;
+    }
+    while (maxlen - n >= COMPAT_WORD_SIZE) {
+        size_t word;
+
+        memcpy(&word, s + n, sizeof(word));
+        if (COMPAT_WORD_HAS_ZERO(word)) {
+            break;
+        }
+        n += COMPAT_WORD_SIZE;
+    }
+#endif
+    while (n < maxlen && s[n] != '\0') {
+        n++;
+    }
+    return n;
+}
+
+/**
+ * @brief Copy src into dst of size bytes, always NUL-terminated
+ * @return strlen(src); a result >= size means dst was truncated
+ *
+ * One pass: copies whole words until the terminator or the end of dst is
+ * near, and only keeps scanning src when it did not fit.
+ */
+static COMPAT_INLINE size_t compat_strlcpy(char *dst, const char *src, size_t size) {
+    size_t n = 0;
+
+    if (size == 0) {
+        return compat_strnlen(src, (size_t)-1);
+    }
+
+#if COMPAT_WORD_AT_A_TIME
+    while (n < size - 1 && !COMPAT_WORD_ALIGNED(src + n)) {
+        if ((dst[n] = src[n]) == '\0') {
+            return n;
+        }
+        n++;
+    }
+    while (size - 1 - n >= COMPAT_WORD_SIZE) {
+        size_t word;
+
+        memcpy(&word, src + n, sizeof(word));
+        if (COMPAT_WORD_HAS_ZERO(word)) {
+            break;
+        }
+        memcpy(dst + n, &word, sizeof(word));
+        n += COMPAT_WORD_SIZE;
+    }
+#endif
+    while (n < size - 1 && src[n] != '\0') {
+        dst[n] = src[n];
+        n++;
+    }
+    dst[n] = '\0';
+
+    if (src[n] == '\0') {
+        return n;
+    }
+    return n + compat_strnlen(src + n, (size_t)-1 - n);
+}
+
+#endif /* EXAMPLES_COMPAT_FAST_H */
@@ -0,0 +1,238 @@
+/**
+ * @file lockfree.h
+ * @brief Lock-free primitives for sharing state between tasks
+ *
+ * Header-only, built on the index helpers of spsc-ring.h:
+ * - Atomic counters: any number of writers, no lock (LDREX/STREX on
+ *   Cortex-M3/M4/M7, a locked add on x86)
+ * - Seqlock: one writer publishes a multi-word snapshot; readers copy
+ *   it and retry if the writer got in the way
+ * - SPSC mailbox: fixed-size messages from one producer to one consumer
+ *
+ * None of these ever block the writer, so a high-priority task that
+ * shares state with lower-priority tasks cannot suffer priority
+ * inversion and never needs a context switch to get at the data.
+ *
+ * Usage:
+ *   static lf_counter_t events;
+ *   lf_counter_add(&events, 1);
+ *
+ *   static lf_seqlock_t lock;
+ *   static state_t state;
+ *   lf_seq_write_begin(&lock); state.a = a; state.b = b; lf_seq_write_end(&lock);
+ *
+ *   unsigned seq;
+ *   state_t copy;
+ *   do {
+ *       seq = lf_seq_read_begin(&lock);
+ *       copy = state;
+ *   } while (lf_seq_read_retry(&lock, seq));
+ */
+
+#ifndef EXAMPLES_LOCKFREE_H
+#define EXAMPLES_LOCKFREE_H
+
+#include "spsc-ring.h"
+
+/* ---- Fences ---- */
+
+#if SPSC_RING_C11_ATOMICS
+#define LF_FENCE_ACQUIRE()          atomic_thread_fence(memory_order_acquire)
+#define LF_FENCE_RELEASE()          atomic_thread_fence(memory_order_release)
+#else
+#define LF_FENCE_ACQUIRE()          SPSC_RING_BARRIER()
+#define LF_FENCE_RELEASE()          SPSC_RING_BARRIER()
+#endif
+
+/* ---- Atomic counters ---- */
+
+/*
+ * Relaxed ordering: a counter orders nothing else. Use a seqlock or
+ * mailbox to publish data alongside it.
+ */
+#if SPSC_RING_C11_ATOMICS
+
+typedef atomic_uint_least32_t lf_counter_t;
+
+#define lf_counter_init(c, v)       atomic_init((c), (v))
+
+/**
+ * @brief Add to a counter
+ * @return The new value
+ *
+ * Cortex-M3 and up compile this to an LDREX/ADD/STREX retry loop; an
+ * interrupt between LDREX and STREX only costs one retry. Cortex-M0 has
+ * no exclusives and calls a libatomic helper that masks interrupts.
+ */
+static inline uint32_t lf_counter_add(lf_counter_t *counter, uint32_t n) {
+    return (uint32_t)atomic_fetch_add_explicit(counter, n, memory_order_relaxed) + n;
+}
+
+static inline uint32_t lf_counter_read(lf_counter_t *counter) {
+    return (uint32_t)atomic_load_explicit(counter, memory_order_relaxed);
+}
+
+#else
+
+typedef volatile uint32_t lf_counter_t;
+
+#define lf_counter_init(c, v)       (*(c) = (v))
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+static inline uint32_t lf_counter_add(lf_counter_t *counter, uint32_t n) {
+    uint32_t value;
+    uint32_t failed;
+
+    /* STREX fails if anything, including an exception, intervened */
+    do {
+        __asm__ volatile ("ldrex %0, [%2]\n\t"
+                          "add %0, %0, %3\n\t"
+                          "strex %1, %0, [%2]"
+                          : "=&r" (value), "=&r" (failed)
+                          : "r" (counter), "r" (n)
+                          : "memory");
+    } while (failed);
+    return value;
+}
+#else
+static inline uint32_t lf_counter_add(lf_counter_t *counter, uint32_t n) {
+    return __sync_add_and_fetch(counter, n);
+}
+#endif
+
+static inline uint32_t lf_counter_read(lf_counter_t *counter) {
+    return *counter;
+}
+
+#endif
+
+/* ---- Seqlock ---- */
+
+/**
+ * Sequence count guarding a snapshot: odd while the writer is updating.
+ *
+ * One writer only (serialize several writers yourself). A reader spins
+ * while the count is odd, so a reader must never preempt the writer on
+ * the same core: on a uniprocessor RTOS, readers need a lower priority
+ * than the writer. If they cannot have one, publish two copies instead
+ * (the latch in realtime/task-monitor.h).
+ *
+ * The snapshot is copied with plain loads; a torn copy is possible but
+ * always discarded by lf_seq_read_retry(). Keep the data to plain
+ * values; never follow a pointer read from an unvalidated copy.
+ */
+typedef struct {
+    spsc_index_t seq;
+} lf_seqlock_t;
+
+static inline void lf_seqlock_init(lf_seqlock_t *lock) {
+    spsc_index_init(&lock->seq, 0);
+}
+
+static inline void lf_seq_write_begin(lf_seqlock_t *lock) {
+    spsc_store_release(&lock->seq, spsc_load_relaxed(&lock->seq) + 1);
+    /* Data stores after this point stay after the odd count */
+    LF_FENCE_RELEASE();
+}
+
+static inline void lf_seq_write_end(lf_seqlock_t *lock) {
+    spsc_store_release(&lock->seq, spsc_load_relaxed(&lock->seq) + 1);
+}
+
+/**
+ * @brief Start a read
+ * @return Count to pass to lf_seq_read_retry()
+ */
+static inline uint32_t lf_seq_read_begin(lf_seqlock_t *lock) {
+    uint32_t seq;
+
+    while ((seq = spsc_load_acquire(&lock->seq)) & 1) {
+        /* Writer in progress */
+    }
+    return seq;
+}
+
+/**
+ * @brief Finish a read
+ * @return true if the writer intervened and the copy must be retaken
+ */
+static inline bool lf_seq_read_retry(lf_seqlock_t *lock, uint32_t seq) {
+    /* Data loads before this point complete before the count is rechecked */
+    LF_FENCE_ACQUIRE();
+    return spsc_load_relaxed(&lock->seq) != seq;
+}
+
+/* ---- SPSC mailbox ---- */
+
+/**
+ * Ring of fixed-size message slots. Same ownership as spsc_ring_t: the
+ * producer owns head, the consumer owns tail. Posting never blocks; a
+ * full mailbox rejects the message and the producer decides what to
+ * drop.
+ */
+typedef struct {
+    SPSC_RING_INDEX_ALIGN spsc_index_t head;    /* Written by producer only */
+    SPSC_RING_INDEX_ALIGN spsc_index_t tail;    /* Written by consumer only */
+    uint8_t *slots;
+    uint32_t mask;                              /* Slot count - 1 */
+    uint32_t msg_size;
+} lf_mailbox_t;
+
+/**
+ * @brief Attach a mailbox to storage
+ * @param storage slot_count * msg_size bytes, e.g. an array of messages
+ * @param msg_size Size of one message
+ * @param slot_count Number of slots; must be a power of two
+ * @return true on success, false if slot_count is not a power of two
+ */
+static inline bool lf_mailbox_init(lf_mailbox_t *mb, void *storage,
+                                   uint32_t msg_size, uint32_t slot_count) {
+    if (!SPSC_RING_IS_POW2(slot_count)) {
+        return false;
+    }
+    mb->slots = (uint8_t *)storage;
+    mb->mask = slot_count - 1;
+    mb->msg_size = msg_size;
+    spsc_index_init(&mb->head, 0);
+    spsc_index_init(&mb->tail, 0);
+    return true;
+}
+
+/**
+ * @brief Post a message (producer only)
+ * @return true if queued, false if the mailbox is full
+ */
+static inline bool lf_mailbox_post(lf_mailbox_t *mb, const void *msg) {
+    uint32_t head = spsc_load_relaxed(&mb->head);
+
+    if (head - spsc_load_acquire(&mb->tail) > mb->mask) {
+        return false;
+    }
+    memcpy(mb->slots + (head & mb->mask) * mb->msg_size, msg, mb->msg_size);
+    spsc_store_release(&mb->head, head + 1);
+    return true;
+}
+
+/**
+ * @brief Take the oldest message (consumer only)
+ * @return true if a message was copied to msg, false if empty
+ */
+static inline bool lf_mailbox_fetch(lf_mailbox_t *mb, void *msg) {
+    uint32_t tail = spsc_load_relaxed(&mb->tail);
+
+    if (spsc_load_acquire(&mb->head) == tail) {
+        return false;
+    }
+    memcpy(msg, mb->slots + (tail & mb->mask) * mb->msg_size, mb->msg_size);
+    spsc_store_release(&mb->tail, tail + 1);
+    return true;
+}
+
+/**
+ * @brief Messages posted and not yet fetched (either side may call)
+ */
+static inline uint32_t lf_mailbox_pending(lf_mailbox_t *mb) {
+    return spsc_load_acquire(&mb->head) - spsc_load_acquire(&mb->tail);
+}
+
+#endif /* EXAMPLES_LOCKFREE_H */
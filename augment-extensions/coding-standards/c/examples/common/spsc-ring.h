@@ -0,0 +1,278 @@
+/**
+ * @file spsc-ring.h
+ * @brief Lock-free single-producer/single-consumer byte ring
+ *
+ * Header-only ring shared by the embedded, networking and systems
+ * examples:
+ * - Power-of-two capacity: positions are masked, never reduced modulo
+ * - Free-running 32-bit indices: the whole capacity is usable and
+ *   head - tail is the fill level even across wrap-around
+ * - Acquire/release ordering via C11 atomics, or a DMB barrier when
+ *   building as C99 for a Cortex-M
+ * - Bulk read/write and peek/commit spans for zero-copy (e.g. DMA)
+ *
+ * Only the producer calls the *_write functions and only the consumer
+ * calls the *_read functions; each side owns one index. The producer may
+ * be an ISR and the consumer main(), or two threads.
+ *
+ * Usage:
+ *   static uint8_t storage[256];
+ *   SPSC_RING_ASSERT_SIZE(sizeof(storage));
+ *   spsc_ring_t ring;
+ *   spsc_ring_init(&ring, storage, sizeof(storage));
+ */
+
+#ifndef EXAMPLES_SPSC_RING_H
+#define EXAMPLES_SPSC_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_ATOMICS__)
+#define SPSC_RING_C11_ATOMICS 1
+#include <stdatomic.h>
+#else
+#define SPSC_RING_C11_ATOMICS 0
+#endif
+
+/** True if n is a non-zero power of two */
+#define SPSC_RING_IS_POW2(n)    ((n) != 0 && ((n) & ((n) - 1)) == 0)
+
+/** Compile-time check for a ring size (works in C99) */
+#define SPSC_RING_CONCAT_(a, b)     a##b
+#define SPSC_RING_CONCAT(a, b)      SPSC_RING_CONCAT_(a, b)
+#define SPSC_RING_ASSERT_SIZE(n) \
+    typedef char SPSC_RING_CONCAT(spsc_ring_size_must_be_pow2_, __LINE__)[SPSC_RING_IS_POW2(n) ? 1 : -1]
+
+#if SPSC_RING_C11_ATOMICS
+
+typedef atomic_uint_least32_t spsc_index_t;
+
+#define spsc_index_init(p, v)       atomic_init((p), (v))
+#define spsc_load_relaxed(p)        ((uint32_t)atomic_load_explicit((p), memory_order_relaxed))
+#define spsc_load_acquire(p)        ((uint32_t)atomic_load_explicit((p), memory_order_acquire))
+#define spsc_store_release(p, v)    atomic_store_explicit((p), (v), memory_order_release)
+
+#else
+
+typedef volatile uint32_t spsc_index_t;
+
+/* Orders buffer accesses against the index update on the other side */
+#if defined(__arm__) || defined(__aarch64__)
+#define SPSC_RING_BARRIER()         __asm__ volatile ("dmb" ::: "memory")
+#else
+#define SPSC_RING_BARRIER()         __sync_synchronize()
+#endif
+
+#define spsc_index_init(p, v)       (*(p) = (v))
+#define spsc_load_relaxed(p)        (*(p))
+
+static inline uint32_t spsc_load_acquire(const spsc_index_t *index) {
+    uint32_t value = *index;
+    SPSC_RING_BARRIER();
+    return value;
+}
+
+#define spsc_store_release(p, v)    do { SPSC_RING_BARRIER(); *(p) = (v); } while (0)
+
+#endif
+
+/* Hosts keep the two indices on separate cache lines */
+#if SPSC_RING_C11_ATOMICS && !defined(__arm__)
+#define SPSC_RING_INDEX_ALIGN       _Alignas(64)
+#else
+#define SPSC_RING_INDEX_ALIGN
+#endif
+
+typedef struct {
+    SPSC_RING_INDEX_ALIGN spsc_index_t head;    /* Written by producer only */
+    SPSC_RING_INDEX_ALIGN spsc_index_t tail;    /* Written by consumer only */
+    uint8_t *buffer;
+    uint32_t mask;                              /* Capacity - 1 */
+} spsc_ring_t;
+
+/**
+ * @brief Attach a ring to storage
+ * @param ring Ring to initialise
+ * @param storage Backing buffer
+ * @param size Size of storage in bytes; must be a power of two
+ * @return true on success, false if size is not a power of two
+ */
+static inline bool spsc_ring_init(spsc_ring_t *ring, uint8_t *storage, uint32_t size) {
+    if (!SPSC_RING_IS_POW2(size)) {
+        return false;
+    }
+    ring->buffer = storage;
+    ring->mask = size - 1;
+    spsc_index_init(&ring->head, 0);
+    spsc_index_init(&ring->tail, 0);
+    return true;
+}
+
+/**
+ * @brief Capacity in bytes
+ */
+static inline uint32_t spsc_ring_capacity(const spsc_ring_t *ring) {
+    return ring->mask + 1;
+}
+
+/**
+ * @brief Bytes written and not yet read (either side may call)
+ *
+ * Can exceed the capacity only if a producer outside the ring's control
+ * (e.g. circular DMA) published more than the consumer had room for.
+ */
+static inline uint32_t spsc_ring_count(spsc_ring_t *ring) {
+    return spsc_load_acquire(&ring->head) - spsc_load_acquire(&ring->tail);
+}
+
+/* ---- Producer side ---- */
+
+/**
+ * @brief Free space, as seen by the producer
+ */
+static inline uint32_t spsc_ring_space(spsc_ring_t *ring) {
+    return spsc_ring_capacity(ring) -
+           (spsc_load_relaxed(&ring->head) - spsc_load_acquire(&ring->tail));
+}
+
+/**
+ * @brief Largest contiguous writable span at the head
+ * @param span Receives a pointer to the first free byte
+ * @return Bytes that may be written at *span before spsc_ring_commit_write()
+ */
+static inline uint32_t spsc_ring_peek_write(spsc_ring_t *ring, uint8_t **span) {
+    uint32_t head = spsc_load_relaxed(&ring->head);
+    uint32_t offset = head & ring->mask;
+    uint32_t space = spsc_ring_space(ring);
+    uint32_t to_end = spsc_ring_capacity(ring) - offset;
+
+    *span = ring->buffer + offset;
+    return (space < to_end) ? space : to_end;
+}
+
+/**
+ * @brief Publish bytes written into the span from spsc_ring_peek_write()
+ */
+static inline void spsc_ring_commit_write(spsc_ring_t *ring, uint32_t n) {
+    spsc_store_release(&ring->head, spsc_load_relaxed(&ring->head) + n);
+}
+
+/**
+ * @brief Copy up to n bytes into the ring
+ * @return Bytes written (less than n if the ring filled up)
+ */
+static inline uint32_t spsc_ring_write_n(spsc_ring_t *ring, const uint8_t *data, uint32_t n) {
+    uint32_t head = spsc_load_relaxed(&ring->head);
+    uint32_t space = spsc_ring_space(ring);
+    uint32_t offset = head & ring->mask;
+
+    if (n > space) {
+        n = space;
+    }
+
+    /* At most two copies: up to the end of storage, then from the start */
+    uint32_t first = spsc_ring_capacity(ring) - offset;
+    if (first > n) {
+        first = n;
+    }
+    memcpy(ring->buffer + offset, data, first);
+    memcpy(ring->buffer, data + first, n - first);
+
+    spsc_store_release(&ring->head, head + n);
+    return n;
+}
+
+/**
+ * @brief Write one byte
+ * @return true if written, false if the ring is full
+ */
+static inline bool spsc_ring_write(spsc_ring_t *ring, uint8_t byte) {
+    uint32_t head = spsc_load_relaxed(&ring->head);
+
+    if (head - spsc_load_acquire(&ring->tail) >= spsc_ring_capacity(ring)) {
+        return false;
+    }
+    ring->buffer[head & ring->mask] = byte;
+    spsc_store_release(&ring->head, head + 1);
+    return true;
+}
+
+/* ---- Consumer side ---- */
+
+/**
+ * @brief Largest contiguous readable span at the tail
+ * @param span Receives a pointer to the oldest unread byte
+ * @return Bytes readable at *span before spsc_ring_commit_read()
+ */
+static inline uint32_t spsc_ring_peek_read(spsc_ring_t *ring, const uint8_t **span) {
+    uint32_t tail = spsc_load_relaxed(&ring->tail);
+    uint32_t offset = tail & ring->mask;
+    uint32_t count = spsc_load_acquire(&ring->head) - tail;
+    uint32_t to_end = spsc_ring_capacity(ring) - offset;
+
+    *span = ring->buffer + offset;
+    return (count < to_end) ? count : to_end;
+}
+
+/**
+ * @brief Release n bytes obtained from spsc_ring_peek_read()
+ */
+static inline void spsc_ring_commit_read(spsc_ring_t *ring, uint32_t n) {
+    spsc_store_release(&ring->tail, spsc_load_relaxed(&ring->tail) + n);
+}
+
+/**
+ * @brief Copy up to n bytes out of the ring
+ * @return Bytes read (less than n if the ring ran empty)
+ */
+static inline uint32_t spsc_ring_read_n(spsc_ring_t *ring, uint8_t *data, uint32_t n) {
+    uint32_t tail = spsc_load_relaxed(&ring->tail);
+    uint32_t count = spsc_load_acquire(&ring->head) - tail;
+    uint32_t offset = tail & ring->mask;
+
+    if (n > count) {
+        n = count;
+    }
+
+    uint32_t first = spsc_ring_capacity(ring) - offset;
+    if (first > n) {
+        first = n;
+    }
+    memcpy(data, ring->buffer + offset, first);
+    memcpy(data + first, ring->buffer, n - first);
+
+    spsc_store_release(&ring->tail, tail + n);
+    return n;
+}
+
+/**
+ * @brief Read one byte
+ * @return true if a byte was read, false if the ring is empty
+ */
+static inline bool spsc_ring_read(spsc_ring_t *ring, uint8_t *byte) {
+    uint32_t tail = spsc_load_relaxed(&ring->tail);
+
+    if (spsc_load_acquire(&ring->head) == tail) {
+        return false;
+    }
+    *byte = ring->buffer[tail & ring->mask];
+    spsc_store_release(&ring->tail, tail + 1);
+    return true;
+}
+
+/**
+ * @brief Drop everything currently readable
+ * @return Bytes discarded
+ */
+static inline uint32_t spsc_ring_discard(spsc_ring_t *ring) {
+    uint32_t tail = spsc_load_relaxed(&ring->tail);
+    uint32_t head = spsc_load_acquire(&ring->head);
+
+    spsc_store_release(&ring->tail, head);
+    return head - tail;
+}
+
+#endif /* EXAMPLES_SPSC_RING_H */
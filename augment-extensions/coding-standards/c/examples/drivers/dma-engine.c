@@ -0,0 +1,733 @@
+/**
+ * @file dma-engine.c
+ * @brief Example dmaengine provider with a descriptor ring
+ *
+ * This example demonstrates:
+ * - Registering a DMA controller with struct dma_device
+ * - Producer/consumer descriptor ring in coherent memory
+ * - One doorbell write per batch of issued descriptors
+ * - IRQ handler that masks the device and wakes a threaded poll
+ * - NAPI-style budgeted polling, unmasking only once caught up
+ * - Interrupt coalescing by completion count and timeout
+ *
+ * The hardware is hypothetical: a memcpy engine that walks a ring of
+ * descriptors, sets DONE in each descriptor's status word as it
+ * finishes and raises one interrupt per coalesce_count completions or
+ * coalesce_usecs after the first unreported one, whichever comes first.
+ *
+ * Device Tree Example:
+ *   dma_controller: dma-controller@40002000 {
+ *       compatible = "example,dma-controller";
+ *       reg = <0x40002000 0x1000>;
+ *       interrupts = <0 34 4>;
+ *       #dma-cells = <1>;
+ *       example,coalesce-count = <16>;
+ *       example,coalesce-usecs = <50>;
+ *   };
+ *
+ * Build: make
+ * Load: sudo insmod dma-engine.ko coalesce_count=32 poll_budget=64
+ */
+
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/platform_device.h>
+#include <linux/of.h>
+#include <linux/of_dma.h>
+#include <linux/dmaengine.h>
+#include <linux/dma-mapping.h>
+#include <linux/interrupt.h>
+#include <linux/io.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+
+MODULE_LICENSE("GPL");
+MODULE_AUTHOR("Example Author");
+MODULE_DESCRIPTION("Example descriptor-ring DMA engine");
+MODULE_VERSION("1.0");
+
+#define DRIVER_NAME "example-dma-engine"
+
+/* Register map */
+#define EX_DMA_REG_CTRL         0x00
+#define EX_DMA_REG_IRQ_STATUS   0x04    /* Write 1 to clear */
+#define EX_DMA_REG_IRQ_ENABLE   0x08
+#define EX_DMA_REG_RING_LO      0x10
+#define EX_DMA_REG_RING_HI      0x14
+#define EX_DMA_REG_RING_SIZE    0x18
+#define EX_DMA_REG_DOORBELL     0x1C    /* Producer index, free-running */
+#define EX_DMA_REG_COAL_COUNT   0x20
+#define EX_DMA_REG_COAL_USECS   0x24
+
+#define EX_DMA_CTRL_ENABLE      BIT(0)
+#define EX_DMA_CTRL_RESET       BIT(1)
+
+#define EX_DMA_IRQ_DONE         BIT(0)
+#define EX_DMA_IRQ_ERROR        BIT(1)
+#define EX_DMA_IRQ_ALL          (EX_DMA_IRQ_DONE | EX_DMA_IRQ_ERROR)
+
+#define EX_DESC_CTRL_VALID      BIT(31)
+#define EX_DESC_STS_DONE        BIT(0)
+#define EX_DESC_STS_ERROR       BIT(1)
+
+/* Ring geometry; the size must be a power of two */
+#define EX_DMA_RING_SIZE        256
+#define EX_DMA_RING_MASK        (EX_DMA_RING_SIZE - 1)
+#define EX_DMA_MAX_LEN          (1U << 24)
+
+static unsigned int coalesce_count = 16;
+module_param(coalesce_count, uint, 0444);
+MODULE_PARM_DESC(coalesce_count, "Completions per interrupt (default: 16)");
+
+static unsigned int coalesce_usecs = 50;
+module_param(coalesce_usecs, uint, 0444);
+MODULE_PARM_DESC(coalesce_usecs, "Max interrupt delay after a completion in us (default: 50)");
+
+static unsigned int poll_budget = 64;
+module_param(poll_budget, uint, 0444);
+MODULE_PARM_DESC(poll_budget, "Completions reaped per poll pass (default: 64)");
+
+/**
+ * @brief Hardware descriptor, one ring slot (32 bytes)
+ */
+struct ex_hw_desc {
+    __le64 src;
+    __le64 dst;
+    __le32 len;
+    __le32 ctrl;
+    __le32 status;          /* Written by the device */
+    __le32 reserved;
+};
+
+/**
+ * @brief Software descriptor handed to dmaengine clients
+ */
+struct ex_desc {
+    struct dma_async_tx_descriptor txd;
+    struct list_head node;
+    dma_addr_t src;
+    dma_addr_t dst;
+    size_t len;
+    enum dmaengine_tx_result result;
+};
+
+/**
+ * @brief Channel state
+ *
+ * head and tail are free-running; head - tail descriptors are owned by
+ * the device. lock protects the lists, the ring and both indices.
+ */
+struct ex_dma_chan {
+    struct dma_chan chan;
+    struct ex_dma *ed;
+    spinlock_t lock;
+
+    struct ex_hw_desc *ring;
+    dma_addr_t ring_dma;
+    struct ex_desc *slots[EX_DMA_RING_SIZE];
+    u32 head;
+    u32 tail;
+
+    struct ex_desc *descs;
+    struct list_head free_list;
+    struct list_head pending;       /* Submitted, not yet in the ring */
+
+    /* Statistics, reported on remove */
+    u64 irqs;
+    u64 polls;
+    u64 completed;
+};
+
+/**
+ * @brief Controller state
+ */
+struct ex_dma {
+    struct dma_device dma;
+    struct device *dev;
+    void __iomem *base;
+    int irq;
+    u32 coalesce_count;
+    u32 coalesce_usecs;
+    unsigned int budget;
+    struct ex_dma_chan chan;
+};
+
+static inline struct ex_dma_chan *to_ex_chan(struct dma_chan *chan)
+{
+    return container_of(chan, struct ex_dma_chan, chan);
+}
+
+static inline struct ex_desc *to_ex_desc(struct dma_async_tx_descriptor *txd)
+{
+    return container_of(txd, struct ex_desc, txd);
+}
+
+/**
+ * @brief Move pending descriptors into free ring slots
+ *
+ * Called with ec->lock held. The doorbell is written once for the whole
+ * batch, so a burst of submissions costs one MMIO write.
+ */
+static void ex_dma_issue_locked(struct ex_dma_chan *ec)
+{
+    unsigned int queued = 0;
+
+    while (!list_empty(&ec->pending) && ec->head - ec->tail < EX_DMA_RING_SIZE) {
+        struct ex_desc *desc = list_first_entry(&ec->pending, struct ex_desc, node);
+        u32 slot = ec->head & EX_DMA_RING_MASK;
+        struct ex_hw_desc *hw = &ec->ring[slot];
+
+        list_del(&desc->node);
+
+        hw->src = cpu_to_le64(desc->src);
+        hw->dst = cpu_to_le64(desc->dst);
+        hw->len = cpu_to_le32(desc->len);
+        hw->status = 0;
+        /* Descriptor body before VALID: the device may be polling the ring */
+        dma_wmb();
+        hw->ctrl = cpu_to_le32(EX_DESC_CTRL_VALID);
+
+        ec->slots[slot] = desc;
+        ec->head++;
+        queued++;
+    }
+
+    /* writel() orders the descriptor writes before the doorbell */
+    if (queued)
+        writel(ec->head, ec->ed->base + EX_DMA_REG_DOORBELL);
+}
+
+/**
+ * @brief Report a finished descriptor to its client
+ */
+static void ex_desc_complete(struct ex_desc *desc)
+{
+    struct dma_async_tx_descriptor *txd = &desc->txd;
+    /* Descriptor granularity: a failed copy reports none of it as done */
+    struct dmaengine_result result = {
+        .result = desc->result,
+        .residue = desc->result == DMA_TRANS_NOERROR ? 0 : desc->len,
+    };
+
+    if (txd->callback_result)
+        txd->callback_result(txd->callback_param, &result);
+    else if (txd->callback)
+        txd->callback(txd->callback_param);
+}
+
+/**
+ * @brief Reap up to budget completed descriptors
+ * @return Number of descriptors reaped
+ *
+ * Callbacks run without the channel lock, so clients may submit new
+ * work from them.
+ */
+static unsigned int ex_dma_poll(struct ex_dma_chan *ec, unsigned int budget)
+{
+    struct ex_desc *desc, *tmp;
+    unsigned long flags;
+    unsigned int done = 0;
+    LIST_HEAD(completed);
+
+    spin_lock_irqsave(&ec->lock, flags);
+
+    while (done < budget && ec->tail != ec->head) {
+        u32 slot = ec->tail & EX_DMA_RING_MASK;
+        u32 status = le32_to_cpu(READ_ONCE(ec->ring[slot].status));
+
+        if (!(status & EX_DESC_STS_DONE))
+            break;
+        /* Read the rest of the descriptor only after seeing DONE */
+        dma_rmb();
+
+        /* Hand the slot back: a polling device must not re-run it */
+        ec->ring[slot].ctrl = 0;
+        ec->ring[slot].status = 0;
+
+        desc = ec->slots[slot];
+        ec->slots[slot] = NULL;
+        desc->result = (status & EX_DESC_STS_ERROR) ? DMA_TRANS_ABORTED
+                                                    : DMA_TRANS_NOERROR;
+        ec->chan.completed_cookie = desc->txd.cookie;
+        list_add_tail(&desc->node, &completed);
+
+        ec->tail++;
+        done++;
+    }
+
+    /*
+     * Reaped slots make room for descriptors that did not fit. The
+     * cleared ctrl words must reach the device before the bodies change.
+     */
+    if (done) {
+        dma_wmb();
+        ex_dma_issue_locked(ec);
+    }
+
+    ec->polls++;
+    ec->completed += done;
+    spin_unlock_irqrestore(&ec->lock, flags);
+
+    if (!done)
+        return 0;
+
+    list_for_each_entry(desc, &completed, node)
+        ex_desc_complete(desc);
+
+    spin_lock_irqsave(&ec->lock, flags);
+    list_for_each_entry_safe(desc, tmp, &completed, node)
+        list_move(&desc->node, &ec->free_list);
+    spin_unlock_irqrestore(&ec->lock, flags);
+
+    return done;
+}
+
+/**
+ * @brief True if the oldest in-flight descriptor has completed
+ */
+static bool ex_dma_has_completions(struct ex_dma_chan *ec)
+{
+    unsigned long flags;
+    bool ready = false;
+
+    spin_lock_irqsave(&ec->lock, flags);
+    if (ec->tail != ec->head) {
+        u32 slot = ec->tail & EX_DMA_RING_MASK;
+
+        ready = le32_to_cpu(READ_ONCE(ec->ring[slot].status)) & EX_DESC_STS_DONE;
+    }
+    spin_unlock_irqrestore(&ec->lock, flags);
+
+    return ready;
+}
+
+/**
+ * @brief Hard IRQ handler: mask, acknowledge, defer to the thread
+ *
+ * The device stays masked while the thread polls, so a sustained stream
+ * of completions costs one interrupt per burst instead of one per
+ * descriptor.
+ */
+static irqreturn_t ex_dma_irq(int irq, void *data)
+{
+    struct ex_dma *ed = data;
+    u32 status = readl(ed->base + EX_DMA_REG_IRQ_STATUS);
+
+    if (!(status & EX_DMA_IRQ_ALL))
+        return IRQ_NONE;
+
+    writel(0, ed->base + EX_DMA_REG_IRQ_ENABLE);
+    writel(status, ed->base + EX_DMA_REG_IRQ_STATUS);
+
+    ed->chan.irqs++;
+    return IRQ_WAKE_THREAD;
+}
+
+/**
+ * @brief Threaded poll loop
+ *
+ * Like NAPI: a pass that uses its whole budget means more work is
+ * queued, so poll again (yielding the CPU in between) without taking
+ * an interrupt. Only when a pass comes up short is the device unmasked,
+ * followed by a recheck for completions that landed in between.
+ */
+static irqreturn_t ex_dma_irq_thread(int irq, void *data)
+{
+    struct ex_dma *ed = data;
+    struct ex_dma_chan *ec = &ed->chan;
+
+    for (;;) {
+        if (ex_dma_poll(ec, ed->budget) == ed->budget) {
+            cond_resched();
+            continue;
+        }
+
+        writel(EX_DMA_IRQ_ALL, ed->base + EX_DMA_REG_IRQ_ENABLE);
+        if (!ex_dma_has_completions(ec))
+            break;
+        writel(0, ed->base + EX_DMA_REG_IRQ_ENABLE);
+    }
+
+    return IRQ_HANDLED;
+}
+
+/**
+ * @brief Assign a cookie and queue a prepared descriptor
+ */
+static dma_cookie_t ex_tx_submit(struct dma_async_tx_descriptor *txd)
+{
+    struct ex_dma_chan *ec = to_ex_chan(txd->chan);
+    struct ex_desc *desc = to_ex_desc(txd);
+    unsigned long flags;
+    dma_cookie_t cookie;
+
+    spin_lock_irqsave(&ec->lock, flags);
+
+    cookie = ec->chan.cookie + 1;
+    if (cookie < DMA_MIN_COOKIE)
+        cookie = DMA_MIN_COOKIE;
+    ec->chan.cookie = cookie;
+    txd->cookie = cookie;
+
+    list_add_tail(&desc->node, &ec->pending);
+
+    spin_unlock_irqrestore(&ec->lock, flags);
+
+    return cookie;
+}
+
+/**
+ * @brief Prepare a memcpy descriptor
+ * @return Descriptor, or NULL if none are free
+ */
+static struct dma_async_tx_descriptor *
+ex_prep_dma_memcpy(struct dma_chan *chan, dma_addr_t dst, dma_addr_t src,
+                   size_t len, unsigned long flags)
+{
+    struct ex_dma_chan *ec = to_ex_chan(chan);
+    struct ex_desc *desc;
+    unsigned long irqflags;
+
+    if (!len || len > EX_DMA_MAX_LEN)
+        return NULL;
+
+    spin_lock_irqsave(&ec->lock, irqflags);
+    desc = list_first_entry_or_null(&ec->free_list, struct ex_desc, node);
+    if (desc)
+        list_del(&desc->node);
+    spin_unlock_irqrestore(&ec->lock, irqflags);
+
+    if (!desc)
+        return NULL;
+
+    desc->src = src;
+    desc->dst = dst;
+    desc->len = len;
+    desc->txd.flags = flags;
+    desc->txd.cookie = -EBUSY;
+    /* Pool descriptors are reused: drop the previous client's callback */
+    desc->txd.callback = NULL;
+    desc->txd.callback_result = NULL;
+    desc->txd.callback_param = NULL;
+
+    return &desc->txd;
+}
+
+/**
+ * @brief Push submitted descriptors to the device
+ */
+static void ex_issue_pending(struct dma_chan *chan)
+{
+    struct ex_dma_chan *ec = to_ex_chan(chan);
+    unsigned long flags;
+
+    spin_lock_irqsave(&ec->lock, flags);
+    ex_dma_issue_locked(ec);
+    spin_unlock_irqrestore(&ec->lock, flags);
+}
+
+/**
+ * @brief Find an unfinished descriptor by cookie (caller holds ec->lock)
+ */
+static struct ex_desc *ex_find_desc_locked(struct ex_dma_chan *ec, dma_cookie_t cookie)
+{
+    struct ex_desc *desc;
+    u32 i;
+
+    for (i = ec->tail; i != ec->head; i++) {
+        desc = ec->slots[i & EX_DMA_RING_MASK];
+        if (desc->txd.cookie == cookie)
+            return desc;
+    }
+    list_for_each_entry(desc, &ec->pending, node) {
+        if (desc->txd.cookie == cookie)
+            return desc;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Report the state of a cookie
+ *
+ * The device reports only whole descriptors, so an unfinished copy's
+ * residue is its full length.
+ */
+static enum dma_status ex_tx_status(struct dma_chan *chan, dma_cookie_t cookie,
+                                    struct dma_tx_state *state)
+{
+    struct ex_dma_chan *ec = to_ex_chan(chan);
+    dma_cookie_t used = READ_ONCE(chan->cookie);
+    dma_cookie_t complete = READ_ONCE(chan->completed_cookie);
+    enum dma_status status = dma_async_is_complete(cookie, complete, used);
+    u32 residue = 0;
+
+    if (status != DMA_COMPLETE && state) {
+        struct ex_desc *desc;
+        unsigned long flags;
+
+        spin_lock_irqsave(&ec->lock, flags);
+        desc = ex_find_desc_locked(ec, cookie);
+        if (desc)
+            residue = desc->len;
+        spin_unlock_irqrestore(&ec->lock, flags);
+    }
+
+    dma_set_tx_state(state, complete, used, residue);
+    return status;
+}
+
+/**
+ * @brief Abort everything in flight and return descriptors to the free list
+ */
+static int ex_terminate_all(struct dma_chan *chan)
+{
+    struct ex_dma_chan *ec = to_ex_chan(chan);
+    void __iomem *base = ec->ed->base;
+    unsigned long flags;
+
+    spin_lock_irqsave(&ec->lock, flags);
+
+    /* Reset clears the device's ring position; configuration is kept */
+    writel(EX_DMA_CTRL_RESET, base + EX_DMA_REG_CTRL);
+
+    for (; ec->tail != ec->head; ec->tail++) {
+        u32 slot = ec->tail & EX_DMA_RING_MASK;
+
+        list_add_tail(&ec->slots[slot]->node, &ec->free_list);
+        ec->slots[slot] = NULL;
+    }
+    list_splice_tail_init(&ec->pending, &ec->free_list);
+    ec->head = 0;
+    ec->tail = 0;
+
+    /*
+     * The device restarts at slot 0: no slot may still say VALID, or a
+     * polling device re-runs aborted copies. writel() orders the clear
+     * before the device restarts.
+     */
+    memset(ec->ring, 0, EX_DMA_RING_SIZE * sizeof(*ec->ring));
+    writel(EX_DMA_CTRL_ENABLE, base + EX_DMA_REG_CTRL);
+
+    spin_unlock_irqrestore(&ec->lock, flags);
+
+    return 0;
+}
+
+/**
+ * @brief Wait for a running poll thread (and its callbacks) to finish
+ */
+static void ex_synchronize(struct dma_chan *chan)
+{
+    struct ex_dma_chan *ec = to_ex_chan(chan);
+
+    synchronize_irq(ec->ed->irq);
+}
+
+/**
+ * @brief Allocate the ring and descriptors and start the channel
+ * @return Number of descriptors allocated, or negative errno
+ */
+static int ex_alloc_chan_resources(struct dma_chan *chan)
+{
+    struct ex_dma_chan *ec = to_ex_chan(chan);
+    struct ex_dma *ed = ec->ed;
+    unsigned int i;
+
+    ec->ring = dma_alloc_coherent(ed->dev, EX_DMA_RING_SIZE * sizeof(*ec->ring),
+                                  &ec->ring_dma, GFP_KERNEL);
+    if (!ec->ring)
+        return -ENOMEM;
+
+    ec->descs = kcalloc(EX_DMA_RING_SIZE, sizeof(*ec->descs), GFP_KERNEL);
+    if (!ec->descs) {
+        dma_free_coherent(ed->dev, EX_DMA_RING_SIZE * sizeof(*ec->ring),
+                          ec->ring, ec->ring_dma);
+        ec->ring = NULL;
+        return -ENOMEM;
+    }
+
+    INIT_LIST_HEAD(&ec->free_list);
+    INIT_LIST_HEAD(&ec->pending);
+    for (i = 0; i < EX_DMA_RING_SIZE; i++) {
+        struct ex_desc *desc = &ec->descs[i];
+
+        dma_async_tx_descriptor_init(&desc->txd, chan);
+        desc->txd.tx_submit = ex_tx_submit;
+        list_add_tail(&desc->node, &ec->free_list);
+    }
+
+    ec->head = 0;
+    ec->tail = 0;
+    chan->cookie = DMA_MIN_COOKIE;
+    chan->completed_cookie = DMA_MIN_COOKIE;
+
+    /* Program ring, coalescing and interrupts, then enable */
+    writel(lower_32_bits(ec->ring_dma), ed->base + EX_DMA_REG_RING_LO);
+    writel(upper_32_bits(ec->ring_dma), ed->base + EX_DMA_REG_RING_HI);
+    writel(EX_DMA_RING_SIZE, ed->base + EX_DMA_REG_RING_SIZE);
+    writel(ed->coalesce_count, ed->base + EX_DMA_REG_COAL_COUNT);
+    writel(ed->coalesce_usecs, ed->base + EX_DMA_REG_COAL_USECS);
+    writel(EX_DMA_IRQ_ALL, ed->base + EX_DMA_REG_IRQ_ENABLE);
+    writel(EX_DMA_CTRL_ENABLE, ed->base + EX_DMA_REG_CTRL);
+
+    return EX_DMA_RING_SIZE;
+}
+
+/**
+ * @brief Stop the channel and free its ring and descriptors
+ */
+static void ex_free_chan_resources(struct dma_chan *chan)
+{
+    struct ex_dma_chan *ec = to_ex_chan(chan);
+    struct ex_dma *ed = ec->ed;
+
+    ex_terminate_all(chan);
+    writel(0, ed->base + EX_DMA_REG_IRQ_ENABLE);
+    writel(0, ed->base + EX_DMA_REG_CTRL);
+    synchronize_irq(ed->irq);
+
+    kfree(ec->descs);
+    ec->descs = NULL;
+    dma_free_coherent(ed->dev, EX_DMA_RING_SIZE * sizeof(*ec->ring),
+                      ec->ring, ec->ring_dma);
+    ec->ring = NULL;
+}
+
+/**
+ * @brief Platform driver probe function
+ * @param pdev Platform device
+ * @return 0 on success, negative error code on failure
+ */
+static int ex_dma_probe(struct platform_device *pdev)
+{
+    struct device_node *np = pdev->dev.of_node;
+    struct dma_device *dd;
+    struct ex_dma *ed;
+    int ret;
+
+    ed = devm_kzalloc(&pdev->dev, sizeof(*ed), GFP_KERNEL);
+    if (!ed)
+        return -ENOMEM;
+
+    ed->dev = &pdev->dev;
+
+    ed->base = devm_platform_ioremap_resource(pdev, 0);
+    if (IS_ERR(ed->base)) {
+        dev_err(&pdev->dev, "Failed to map registers\n");
+        return PTR_ERR(ed->base);
+    }
+
+    ed->irq = platform_get_irq(pdev, 0);
+    if (ed->irq < 0)
+        return ed->irq;
+
+    ret = dma_set_mask_and_coherent(&pdev->dev, DMA_BIT_MASK(32));
+    if (ret) {
+        dev_err(&pdev->dev, "Failed to set DMA mask\n");
+        return ret;
+    }
+
+    /* Module parameters give the defaults; the device tree overrides */
+    ed->coalesce_count = coalesce_count;
+    ed->coalesce_usecs = coalesce_usecs;
+    of_property_read_u32(np, "example,coalesce-count", &ed->coalesce_count);
+    of_property_read_u32(np, "example,coalesce-usecs", &ed->coalesce_usecs);
+    ed->coalesce_count = max(ed->coalesce_count, 1U);
+    ed->budget = clamp(poll_budget, 1U, (unsigned int)EX_DMA_RING_SIZE);
+
+    /* Quiesce the device before its interrupt can fire */
+    writel(0, ed->base + EX_DMA_REG_IRQ_ENABLE);
+    writel(0, ed->base + EX_DMA_REG_CTRL);
+
+    spin_lock_init(&ed->chan.lock);
+    INIT_LIST_HEAD(&ed->chan.free_list);
+    INIT_LIST_HEAD(&ed->chan.pending);
+    ed->chan.ed = ed;
+
+    ret = devm_request_threaded_irq(&pdev->dev, ed->irq, ex_dma_irq,
+                                    ex_dma_irq_thread, 0, dev_name(&pdev->dev), ed);
+    if (ret) {
+        dev_err(&pdev->dev, "Failed to request IRQ %d\n", ed->irq);
+        return ret;
+    }
+
+    dd = &ed->dma;
+    dd->dev = &pdev->dev;
+    dma_cap_set(DMA_MEMCPY, dd->cap_mask);
+    dd->directions = BIT(DMA_MEM_TO_MEM);
+    dd->residue_granularity = DMA_RESIDUE_GRANULARITY_DESCRIPTOR;
+    dd->device_alloc_chan_resources = ex_alloc_chan_resources;
+    dd->device_free_chan_resources = ex_free_chan_resources;
+    dd->device_prep_dma_memcpy = ex_prep_dma_memcpy;
+    dd->device_issue_pending = ex_issue_pending;
+    dd->device_tx_status = ex_tx_status;
+    dd->device_terminate_all = ex_terminate_all;
+    dd->device_synchronize = ex_synchronize;
+
+    INIT_LIST_HEAD(&dd->channels);
+    ed->chan.chan.device = dd;
+    list_add_tail(&ed->chan.chan.device_node, &dd->channels);
+
+    platform_set_drvdata(pdev, ed);
+
+    ret = dma_async_device_register(dd);
+    if (ret) {
+        dev_err(&pdev->dev, "Failed to register DMA device\n");
+        return ret;
+    }
+
+    /* Device tree clients look channels up by index */
+    if (np) {
+        ret = of_dma_controller_register(np, of_dma_xlate_by_chan_id, dd);
+        if (ret) {
+            dev_err(&pdev->dev, "Failed to register OF DMA controller\n");
+            dma_async_device_unregister(dd);
+            return ret;
+        }
+    }
+
+    dev_info(&pdev->dev, "DMA engine: %u descriptors, coalesce %u/%uus, budget %u\n",
+             EX_DMA_RING_SIZE, ed->coalesce_count, ed->coalesce_usecs, ed->budget);
+
+    return 0;
+}
+
+/**
+ * @brief Platform driver remove function
+ * @param pdev Platform device
+ * @return 0 on success
+ */
+static int ex_dma_remove(struct platform_device *pdev)
+{
+    struct ex_dma *ed = platform_get_drvdata(pdev);
+    struct ex_dma_chan *ec = &ed->chan;
+
+    if (pdev->dev.of_node)
+        of_dma_controller_free(pdev->dev.of_node);
+    dma_async_device_unregister(&ed->dma);
+
+    dev_info(&pdev->dev, "DMA engine removed: %llu completions, %llu irqs, %llu polls\n",
+             ec->completed, ec->irqs, ec->polls);
+
+    return 0;
+}
+
+/**
+ * @brief Device tree match table
+ */
+static const struct of_device_id ex_dma_of_match[] = {
+    { .compatible = "example,dma-controller", },
+    { /* sentinel */ }
+};
+MODULE_DEVICE_TABLE(of, ex_dma_of_match);
+
+static struct platform_driver ex_dma_driver = {
+    .probe = ex_dma_probe,
+    .remove = ex_dma_remove,
+    .driver = {
+        .name = DRIVER_NAME,
+        .of_match_table = ex_dma_of_match,
+    },
+};
+
+module_platform_driver(ex_dma_driver);
@@ -7,6 +7,8 @@
  * - DMA mapping and unmapping
  * - Coherent vs streaming DMA
  * - DMA direction handling
+ * - Pool of buffers mapped once and recycled with dma_sync_single_*()
+ * - Scatter-gather transfers from non-contiguous pages via sg_table
  * - Proper cleanup
  * 
  * Build: make
@@ -18,6 +20,10 @@
 #include <linux/platform_device.h>
 #include <linux/dma-mapping.h>
 #include <linux/slab.h>
+#include <linux/mm.h>
+#include <linux/list.h>
+#include <linux/spinlock.h>
+#include <linux/scatterlist.h>
 
 MODULE_LICENSE("GPL");
 MODULE_AUTHOR("Example Author");
@@ -26,6 +32,62 @@ MODULE_VERSION("1.0");
 
 #define DMA_BUFFER_SIZE 4096
 
+/* Buffer pool: DMA_POOL_BUFFERS buffers of PAGE_SIZE << DMA_POOL_ORDER */
+#define DMA_POOL_BUFFERS        32
+#define DMA_POOL_ORDER          0
+#define DMA_POOL_DEMO_TRANSFERS 256
+
+/* Scatter-gather transfer built from individual pages */
+#define DMA_SG_TRANSFER_SIZE    (1024 * 1024)
+
+/**
+ * @brief One pre-mapped buffer owned by a dma_buf_pool
+ */
+struct dma_pool_buf {
+    struct list_head node;
+    struct page *page;
+    void *vaddr;
+    dma_addr_t dma_handle;
+};
+
+/**
+ * @brief Pool of streaming DMA buffers mapped once and recycled
+ * 
+ * Buffers stay mapped for the lifetime of the pool. Ownership moves
+ * between CPU and device with dma_sync_single_for_device/cpu(), which
+ * is at most a cache clean/invalidate of the bytes used, instead of a
+ * map/unmap (IOMMU page-table or swiotlb work) per transfer.
+ * 
+ * dma_pool would hand out coherent memory, which needs no syncs but is
+ * uncached on non-coherent systems; capture buffers the CPU parses
+ * afterwards are faster as cached streaming mappings.
+ */
+struct dma_buf_pool {
+    struct device *dev;
+    enum dma_data_direction dir;
+    size_t buf_size;
+    unsigned int count;
+    struct dma_pool_buf *bufs;
+    
+    spinlock_t lock;                /* Protects free_list; used from IRQ context */
+    struct list_head free_list;
+};
+
+/**
+ * @brief Large transfer described by an sg_table
+ * 
+ * The pages need not be physically contiguous: each DMA segment becomes
+ * one hardware descriptor, and an IOMMU may merge them further.
+ */
+struct dma_sg_transfer {
+    struct page **pages;
+    unsigned int nr_pages;
+    size_t size;
+    enum dma_data_direction dir;
+    struct sg_table sgt;
+    bool mapped;
+};
+
 /**
  * @brief Device private data
  */
@@ -39,6 +101,12 @@ struct dma_device {
     /* Streaming DMA buffer */
     void *streaming_buffer;
     dma_addr_t streaming_dma_handle;
+    
+    /* Pre-mapped buffer pool */
+    struct dma_buf_pool pool;
+    
+    /* Scatter-gather transfer */
+    struct dma_sg_transfer sg_xfer;
 };
 
 /**
@@ -121,6 +189,322 @@ static int streaming_dma_example(struct dma_device *dma_dev)
     return 0;
 }
 
+/**
+ * @brief Unmap and free every buffer in a pool
+ */
+static void dma_buf_pool_destroy(struct dma_buf_pool *pool)
+{
+    unsigned int i;
+
+    for (i = 0; i < pool->count; i++) {
+        struct dma_pool_buf *buf = &pool->bufs[i];
+
+        if (!buf->page)
+            continue;
+
+        dma_free_pages(pool->dev, pool->buf_size, buf->page,
+                       buf->dma_handle, pool->dir);
+    }
+
+    kfree(pool->bufs);
+    pool->bufs = NULL;
+    pool->count = 0;
+    INIT_LIST_HEAD(&pool->free_list);
+}
+
+/**
+ * @brief Allocate and map a pool of buffers
+ * @param pool Pool to initialise
+ * @param dev Device doing the DMA
+ * @param count Number of buffers
+ * @param order Each buffer is PAGE_SIZE << order bytes
+ * @param dir Transfer direction, fixed for the pool
+ * @return 0 on success, negative errno on failure
+ */
+static int dma_buf_pool_init(struct dma_buf_pool *pool, struct device *dev,
+                             unsigned int count, unsigned int order,
+                             enum dma_data_direction dir)
+{
+    unsigned int i;
+
+    pool->dev = dev;
+    pool->dir = dir;
+    pool->buf_size = PAGE_SIZE << order;
+    spin_lock_init(&pool->lock);
+    INIT_LIST_HEAD(&pool->free_list);
+
+    pool->bufs = kcalloc(count, sizeof(*pool->bufs), GFP_KERNEL);
+    if (!pool->bufs)
+        return -ENOMEM;
+    pool->count = count;
+
+    for (i = 0; i < count; i++) {
+        struct dma_pool_buf *buf = &pool->bufs[i];
+
+        /*
+         * Allocated within the device's DMA mask, near its memory node, and
+         * mapped once. Pages above the mask would be bounced through
+         * swiotlb, turning every sync into a memcpy; here a sync is only
+         * cache maintenance.
+         */
+        buf->page = dma_alloc_pages(dev, pool->buf_size, &buf->dma_handle,
+                                    dir, GFP_KERNEL);
+        if (!buf->page)
+            goto fail;
+        buf->vaddr = page_address(buf->page);
+
+        list_add_tail(&buf->node, &pool->free_list);
+    }
+
+    return 0;
+
+fail:
+    dev_err(dev, "Failed to set up pool buffer %u of %u\n", i, count);
+    dma_buf_pool_destroy(pool);
+    return -ENOMEM;
+}
+
+/**
+ * @brief Take a free buffer; the CPU owns it until handed to the device
+ * @return Buffer, or NULL if all buffers are in flight
+ */
+static struct dma_pool_buf *dma_buf_pool_get(struct dma_buf_pool *pool)
+{
+    struct dma_pool_buf *buf;
+    unsigned long flags;
+
+    spin_lock_irqsave(&pool->lock, flags);
+    buf = list_first_entry_or_null(&pool->free_list, struct dma_pool_buf, node);
+    if (buf)
+        list_del(&buf->node);
+    spin_unlock_irqrestore(&pool->lock, flags);
+
+    return buf;
+}
+
+/**
+ * @brief Return a buffer to the pool
+ * 
+ * Buffers are reused LIFO so the next transfer gets a cache-warm one.
+ */
+static void dma_buf_pool_put(struct dma_buf_pool *pool, struct dma_pool_buf *buf)
+{
+    unsigned long flags;
+
+    spin_lock_irqsave(&pool->lock, flags);
+    list_add(&buf->node, &pool->free_list);
+    spin_unlock_irqrestore(&pool->lock, flags);
+}
+
+/**
+ * @brief Hand a buffer to the device
+ * @param len Bytes the device will access; only these are synced
+ */
+static void dma_buf_pool_to_device(struct dma_buf_pool *pool,
+                                   struct dma_pool_buf *buf, size_t len)
+{
+    dma_sync_single_for_device(pool->dev, buf->dma_handle, len, pool->dir);
+}
+
+/**
+ * @brief Take a buffer back from the device once its transfer completed
+ * @param len Bytes the device accessed
+ */
+static void dma_buf_pool_to_cpu(struct dma_buf_pool *pool,
+                                struct dma_pool_buf *buf, size_t len)
+{
+    dma_sync_single_for_cpu(pool->dev, buf->dma_handle, len, pool->dir);
+}
+
+/**
+ * @brief Example: recycle pre-mapped buffers across many transfers
+ * 
+ * Each transfer costs two syncs and two list operations; no buffer is
+ * mapped, unmapped, allocated or freed on the data path.
+ */
+static int dma_pool_example(struct dma_device *dma_dev)
+{
+    struct dma_buf_pool *pool = &dma_dev->pool;
+    unsigned int i;
+    int ret;
+
+    ret = dma_buf_pool_init(pool, dma_dev->dev, DMA_POOL_BUFFERS,
+                            DMA_POOL_ORDER, DMA_TO_DEVICE);
+    if (ret)
+        return ret;
+
+    for (i = 0; i < DMA_POOL_DEMO_TRANSFERS; i++) {
+        struct dma_pool_buf *buf = dma_buf_pool_get(pool);
+        size_t len = pool->buf_size;
+
+        if (!buf) {
+            /* Every buffer in flight: wait for a completion, or drop */
+            dev_warn(dma_dev->dev, "DMA pool exhausted\n");
+            break;
+        }
+
+        /* CPU owns the buffer: fill it */
+        memset(buf->vaddr, i & 0xFF, len);
+
+        dma_buf_pool_to_device(pool, buf, len);
+        /* Example: writel(buf->dma_handle, device_dma_addr_reg); */
+        /* Example: writel(len | DMA_START, device_control_reg); */
+
+        /* The completion handler takes it back and recycles it */
+        dma_buf_pool_to_cpu(pool, buf, len);
+        dma_buf_pool_put(pool, buf);
+    }
+
+    dev_info(dma_dev->dev, "Recycled %u transfers through %u pre-mapped buffers\n",
+             i, pool->count);
+
+    return 0;
+}
+
+/**
+ * @brief Unmap and free a scatter-gather transfer
+ */
+static void dma_sg_transfer_destroy(struct device *dev, struct dma_sg_transfer *xfer)
+{
+    unsigned int i;
+
+    if (xfer->mapped) {
+        dma_unmap_sgtable(dev, &xfer->sgt, xfer->dir, DMA_ATTR_SKIP_CPU_SYNC);
+        xfer->mapped = false;
+    }
+    if (xfer->sgt.sgl)
+        sg_free_table(&xfer->sgt);
+
+    if (xfer->pages) {
+        for (i = 0; i < xfer->nr_pages; i++) {
+            if (xfer->pages[i])
+                __free_page(xfer->pages[i]);
+        }
+        kvfree(xfer->pages);
+        xfer->pages = NULL;
+    }
+    xfer->nr_pages = 0;
+}
+
+/**
+ * @brief Build and map a scatter-gather transfer from order-0 pages
+ * @param dev Device doing the DMA
+ * @param xfer Transfer to initialise
+ * @param size Transfer size in bytes
+ * @param dir Transfer direction
+ * @return 0 on success, negative errno on failure
+ * 
+ * Single pages are always available even when memory is too fragmented
+ * for a large physically contiguous buffer. The mapping is kept, so the
+ * transfer can be resubmitted with only the sync calls.
+ */
+static int dma_sg_transfer_init(struct device *dev, struct dma_sg_transfer *xfer,
+                                size_t size, enum dma_data_direction dir)
+{
+    gfp_t gfp = GFP_KERNEL;
+    unsigned int i;
+    int ret;
+
+    memset(xfer, 0, sizeof(*xfer));
+    xfer->size = size;
+    xfer->dir = dir;
+    xfer->nr_pages = DIV_ROUND_UP(size, PAGE_SIZE);
+
+    xfer->pages = kvcalloc(xfer->nr_pages, sizeof(*xfer->pages), GFP_KERNEL);
+    if (!xfer->pages)
+        return -ENOMEM;
+
+    /* Pages the device can reach directly, or each sync becomes a bounce copy */
+    if (dma_addressing_limited(dev))
+        gfp |= GFP_DMA32;
+
+    for (i = 0; i < xfer->nr_pages; i++) {
+        xfer->pages[i] = alloc_page(gfp);
+        if (!xfer->pages[i]) {
+            ret = -ENOMEM;
+            goto fail;
+        }
+    }
+
+    /* Physically adjacent pages are merged into one segment */
+    ret = sg_alloc_table_from_pages(&xfer->sgt, xfer->pages, xfer->nr_pages,
+                                    0, size, GFP_KERNEL);
+    if (ret)
+        goto fail;
+
+    ret = dma_map_sgtable(dev, &xfer->sgt, dir, DMA_ATTR_SKIP_CPU_SYNC);
+    if (ret)
+        goto fail;
+    xfer->mapped = true;
+
+    return 0;
+
+fail:
+    dma_sg_transfer_destroy(dev, xfer);
+    return ret;
+}
+
+/**
+ * @brief Hand a scatter-gather transfer to the device
+ * 
+ * Programs one descriptor per mapped segment. Use the DMA segments
+ * (for_each_sgtable_dma_sg), not the CPU pages: after an IOMMU merge
+ * there may be fewer of them.
+ */
+static void dma_sg_transfer_submit(struct device *dev, struct dma_sg_transfer *xfer)
+{
+    struct scatterlist *sg;
+    unsigned int i;
+
+    dma_sync_sgtable_for_device(dev, &xfer->sgt, xfer->dir);
+
+    for_each_sgtable_dma_sg(&xfer->sgt, sg, i) {
+        dev_dbg(dev, "SG segment %u: 0x%llx + %u\n", i,
+                (unsigned long long)sg_dma_address(sg), sg_dma_len(sg));
+        /* Example: writel(sg_dma_address(sg), desc_addr_reg(i)); */
+        /* Example: writel(sg_dma_len(sg), desc_len_reg(i)); */
+    }
+
+    /* Example: writel(xfer->sgt.nents | DMA_START, device_control_reg); */
+}
+
+/**
+ * @brief Take a scatter-gather transfer back after completion
+ */
+static void dma_sg_transfer_complete(struct device *dev, struct dma_sg_transfer *xfer)
+{
+    dma_sync_sgtable_for_cpu(dev, &xfer->sgt, xfer->dir);
+}
+
+/**
+ * @brief Example: large transfer without physically contiguous memory
+ */
+static int dma_sg_example(struct dma_device *dma_dev)
+{
+    struct dma_sg_transfer *xfer = &dma_dev->sg_xfer;
+    unsigned int i;
+    int ret;
+
+    ret = dma_sg_transfer_init(dma_dev->dev, xfer, DMA_SG_TRANSFER_SIZE,
+                               DMA_TO_DEVICE);
+    if (ret) {
+        dev_err(dma_dev->dev, "Failed to set up scatter-gather transfer\n");
+        return ret;
+    }
+
+    /* GFP_KERNEL pages are never highmem, so page_address() is valid */
+    for (i = 0; i < xfer->nr_pages; i++)
+        memset(page_address(xfer->pages[i]), 0x5A, PAGE_SIZE);
+
+    dma_sg_transfer_submit(dma_dev->dev, xfer);
+    dma_sg_transfer_complete(dma_dev->dev, xfer);
+
+    dev_info(dma_dev->dev, "Scatter-gather transfer: %zu bytes, %u pages, %u DMA segments\n",
+             xfer->size, xfer->nr_pages, xfer->sgt.nents);
+
+    return 0;
+}
+
 /**
  * @brief Cleanup coherent DMA resources
  */
@@ -192,8 +576,25 @@ static int dma_probe(struct platform_device *pdev)
         return ret;
     }
 
+    /* Example 3: Pre-mapped buffer pool */
+    ret = dma_pool_example(dma_dev);
+    if (ret)
+        goto fail_pool;
+
+    /* Example 4: Scatter-gather transfer */
+    ret = dma_sg_example(dma_dev);
+    if (ret)
+        goto fail_sg;
+
     dev_info(&pdev->dev, "DMA example device probed successfully\n");
     return 0;
+
+fail_sg:
+    dma_buf_pool_destroy(&dma_dev->pool);
+fail_pool:
+    cleanup_streaming_dma(dma_dev);
+    cleanup_coherent_dma(dma_dev);
+    return ret;
 }
 
 /**
@@ -205,6 +606,8 @@ static int dma_remove(struct platform_device *pdev)
 
     dev_info(&pdev->dev, "Removing DMA example device\n");
 
+    dma_sg_transfer_destroy(dma_dev->dev, &dma_dev->sg_xfer);
+    dma_buf_pool_destroy(&dma_dev->pool);
     cleanup_streaming_dma(dma_dev);
     cleanup_coherent_dma(dma_dev);
 
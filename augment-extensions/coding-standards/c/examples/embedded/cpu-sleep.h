@@ -0,0 +1,61 @@
+/**
+ * @file cpu-sleep.h
+ * @brief Cortex-M interrupt masking and WFI sleep primitives
+ *
+ * Header-only; shared by the embedded examples. On hosts (syntax-check
+ * builds) every primitive is a no-op, so sleeps become busy polls.
+ *
+ * Usage:
+ *   static volatile bool done;          // Set by an ISR
+ *   while (!done) {
+ *       cpu_sleep_unless(&done);
+ *   }
+ */
+
+#ifndef EXAMPLES_CPU_SLEEP_H
+#define EXAMPLES_CPU_SLEEP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#if defined(__arm__)
+#define cpu_wait_for_interrupt()    __asm__ volatile ("wfi")
+
+/**
+ * @brief Mask interrupts (PRIMASK); returns the previous state
+ */
+static inline uint32_t irq_save(void) {
+    uint32_t primask;
+    __asm__ volatile ("mrs %0, primask\n\tcpsid i" : "=r" (primask) :: "memory");
+    return primask;
+}
+
+/**
+ * @brief Restore the PRIMASK state returned by irq_save()
+ */
+static inline void irq_restore(uint32_t primask) {
+    __asm__ volatile ("msr primask, %0" :: "r" (primask) : "memory");
+}
+#else
+#define cpu_wait_for_interrupt()    ((void)0)
+static inline uint32_t irq_save(void) { return 0; }
+static inline void irq_restore(uint32_t primask) { (void)primask; }
+#endif
+
+/**
+ * @brief Sleep in WFI unless *flag is already set
+ *
+ * The flag is tested with interrupts masked: an ISR that fires after the
+ * test stays pending, and a pending interrupt wakes WFI even with PRIMASK
+ * set, so the wakeup cannot be lost. The ISR runs on irq_restore().
+ */
+static inline void cpu_sleep_unless(volatile bool *flag) {
+    uint32_t primask = irq_save();
+
+    if (!*flag) {
+        cpu_wait_for_interrupt();
+    }
+    irq_restore(primask);
+}
+
+#endif /* EXAMPLES_CPU_SLEEP_H */
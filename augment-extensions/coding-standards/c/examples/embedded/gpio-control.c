@@ -8,6 +8,8 @@
  * - Bit manipulation for GPIO control
  * - Hardware abstraction layer pattern
  * - Safe register access
+ * - Sleeping delays (SysTick one-shot + WFI) instead of busy loops
+ * - Port-level operations: many pins per single BSRR/MODER access
  * 
  * Target: Generic ARM Cortex-M microcontroller
  * Note: This is a demonstration. Actual addresses depend on your hardware.
@@ -16,6 +18,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "cpu-sleep.h"
+
 // Example GPIO register addresses (adjust for your hardware)
 #define GPIO_BASE_ADDR      0x40020000UL
 #define GPIOA_MODER         (*(volatile uint32_t *)(GPIO_BASE_ADDR + 0x00))
@@ -23,10 +27,40 @@
 #define GPIOA_IDR           (*(volatile uint32_t *)(GPIO_BASE_ADDR + 0x10))
 #define GPIOA_BSRR          (*(volatile uint32_t *)(GPIO_BASE_ADDR + 0x18))
 
+// SysTick (core peripheral, same address on every Cortex-M)
+#define SYST_CSR            (*(volatile uint32_t *)0xE000E010UL)
+#define SYST_RVR            (*(volatile uint32_t *)0xE000E014UL)
+#define SYST_CVR            (*(volatile uint32_t *)0xE000E018UL)
+#define SYST_CSR_ENABLE     (1UL << 0)
+#define SYST_CSR_TICKINT    (1UL << 1)
+#define SYST_CSR_CLKSOURCE  (1UL << 2)   // Processor clock
+#define SYST_MAX_RELOAD     0x00FFFFFFUL // 24-bit counter
+
+#define CPU_CLOCK_HZ        72000000UL
+
 // GPIO pin definitions
 #define LED_PIN             5
 #define BUTTON_PIN          13
 
+// Pin masks; constant arguments fold to a single immediate store
+#define GPIO_PIN_MASK(pin)  ((uint16_t)(1U << (pin)))
+#define LED_MASK            GPIO_PIN_MASK(LED_PIN)
+#define BUTTON_MASK         GPIO_PIN_MASK(BUTTON_PIN)
+
+// Parallel display bus: data on PA0-PA7, write strobe on PA8 (active low)
+#define DISPLAY_DATA_SHIFT  0
+#define DISPLAY_DATA_MASK   ((uint16_t)(0xFFU << DISPLAY_DATA_SHIFT))
+#define DISPLAY_WR_MASK     GPIO_PIN_MASK(8)
+
+/**
+ * @brief Set and clear pins with one BSRR store (compile-time form)
+ * 
+ * Expands to a single str of a constant when both masks are constants.
+ * If a pin is in both masks, set wins (BSRR semantics).
+ */
+#define GPIO_WRITE_MASK(set_mask, clear_mask) \
+    (GPIOA_BSRR = ((uint32_t)(uint16_t)(clear_mask) << 16) | (uint16_t)(set_mask))
+
 // GPIO modes
 typedef enum {
     GPIO_MODE_INPUT  = 0x00,
@@ -91,6 +125,32 @@ gpio_state_t gpio_read(uint8_t pin) {
     return (GPIOA_IDR & (1UL << pin)) ? GPIO_HIGH : GPIO_LOW;
 }
 
+/**
+ * @brief Set and clear several pins at once
+ * @param set_mask Pins to drive high
+ * @param clear_mask Pins to drive low
+ * 
+ * One BSRR store: atomic with respect to ISRs touching other pins, and
+ * all pins change in the same bus cycle.
+ */
+void gpio_write_mask(uint16_t set_mask, uint16_t clear_mask) {
+    GPIO_WRITE_MASK(set_mask, clear_mask);
+}
+
+/**
+ * @brief Toggle the pins in mask
+ * @param mask Pins to toggle
+ * 
+ * The new levels are computed from ODR and applied with one BSRR store,
+ * so an ISR changing other pins in between is never undone (a plain
+ * ODR read-modify-write would overwrite it).
+ */
+void gpio_toggle_mask(uint16_t mask) {
+    uint16_t odr = (uint16_t)GPIOA_ODR;
+
+    GPIO_WRITE_MASK(~odr & mask, odr & mask);
+}
+
 /**
  * @brief Toggle GPIO pin state
  * @param pin Pin number (0-15)
@@ -100,20 +160,88 @@ void gpio_toggle(uint8_t pin) {
         return;  // Invalid pin
     }
 
-    // Read current state and toggle
-    uint32_t current = GPIOA_ODR;
-    GPIOA_ODR = current ^ (1UL << pin);
+    gpio_toggle_mask(GPIO_PIN_MASK(pin));
+}
+
+/**
+ * @brief Write a value to a group of adjacent pins
+ * @param value Value to drive (bit 0 goes to pin 'shift')
+ * @param mask Pins belonging to the bus (already shifted)
+ * @param shift Lowest pin of the bus
+ */
+void gpio_write_bus(uint16_t value, uint16_t mask, uint8_t shift) {
+    uint16_t bits = (uint16_t)(value << shift) & mask;
+
+    GPIO_WRITE_MASK(bits, ~bits & mask);
+}
+
+/**
+ * @brief Spread a 16-bit pin mask to one 2-bit field per pin (MODER layout)
+ */
+static inline uint32_t gpio_spread_mask(uint16_t pins) {
+    uint32_t x = pins;
+
+    x = (x | (x << 8)) & 0x00FF00FFUL;
+    x = (x | (x << 4)) & 0x0F0F0F0FUL;
+    x = (x | (x << 2)) & 0x33333333UL;
+    x = (x | (x << 1)) & 0x55555555UL;
+    return x;  // Bit 2n set for each pin n
 }
 
 /**
- * @brief Simple delay function (busy-wait)
- * @param count Delay count (hardware-dependent)
+ * @brief Configure several pins with the same mode in one MODER update
+ * @param pins Mask of pins to configure
+ * @param mode GPIO mode
  * 
- * Note: In production, use hardware timers instead
+ * Interrupts are masked across the read-modify-write so an ISR
+ * reconfiguring other pins cannot be lost.
+ */
+void gpio_init_mask(uint16_t pins, gpio_mode_t mode) {
+    uint32_t lsb = gpio_spread_mask(pins);
+    uint32_t field_mask = lsb * 0x3U;
+    uint32_t field_value = lsb * (uint32_t)mode;
+    uint32_t primask = irq_save();
+
+    GPIOA_MODER = (GPIOA_MODER & ~field_mask) | field_value;
+
+    irq_restore(primask);
+}
+
+// Set by SysTick_Handler when the current delay shot has elapsed
+static volatile bool systick_expired = false;
+
+/**
+ * @brief SysTick interrupt: end of a one-shot delay
  */
-void delay(volatile uint32_t count) {
-    while (count--) {
-        __asm__ volatile ("nop");  // Prevent optimization
+void SysTick_Handler(void) {
+    SYST_CSR = 0;  // Stop: no further ticks until the next delay
+    systick_expired = true;
+}
+
+/**
+ * @brief Sleep for the specified number of milliseconds
+ * @param ms Milliseconds to delay
+ * 
+ * SysTick is armed as a one-shot for the whole delay (in 24-bit chunks,
+ * ~233 ms at 72 MHz) and the core sleeps in WFI until it fires, instead
+ * of spinning in a calibrated loop. For many concurrent deadlines see the
+ * timer wheel in timer-isr.c.
+ */
+void delay_ms(uint32_t ms) {
+    uint64_t cycles = (uint64_t)ms * (CPU_CLOCK_HZ / 1000UL);
+
+    while (cycles > 0) {
+        uint32_t chunk = (cycles > SYST_MAX_RELOAD) ? SYST_MAX_RELOAD : (uint32_t)cycles;
+
+        systick_expired = false;
+        SYST_RVR = chunk - 1;
+        SYST_CVR = 0;
+        SYST_CSR = SYST_CSR_CLKSOURCE | SYST_CSR_TICKINT | SYST_CSR_ENABLE;
+
+        while (!systick_expired) {
+            cpu_sleep_unless(&systick_expired);
+        }
+        cycles -= chunk;
     }
 }
 
@@ -127,9 +255,38 @@ void led_blink_example(void) {
     // Blink LED 10 times
     for (int i = 0; i < 10; i++) {
         gpio_write(LED_PIN, GPIO_HIGH);
-        delay(500000);
+        delay_ms(250);
         gpio_write(LED_PIN, GPIO_LOW);
-        delay(500000);
+        delay_ms(250);
+    }
+}
+
+/**
+ * @brief Bit-banged parallel display write
+ * @param data Byte to present on PA0-PA7
+ * 
+ * Two stores per byte: data and WR low together, then WR high to latch,
+ * instead of 8 data writes plus two strobe writes.
+ */
+static void display_write_byte(uint8_t data) {
+    uint16_t bits = (uint16_t)((uint16_t)data << DISPLAY_DATA_SHIFT);
+
+    GPIO_WRITE_MASK(bits, (uint16_t)(~bits & DISPLAY_DATA_MASK) | DISPLAY_WR_MASK);
+    GPIO_WRITE_MASK(DISPLAY_WR_MASK, 0);
+}
+
+/**
+ * @brief Parallel bus example
+ */
+void parallel_bus_example(void) {
+    static const uint8_t frame[] = { 0x2A, 0x00, 0x00, 0x00, 0xEF };
+
+    // Data lines and strobe as outputs in one MODER update; strobe idles high
+    gpio_init_mask(DISPLAY_DATA_MASK | DISPLAY_WR_MASK, GPIO_MODE_OUTPUT);
+    gpio_write_mask(DISPLAY_WR_MASK, 0);
+
+    for (unsigned i = 0; i < sizeof(frame); i++) {
+        display_write_byte(frame[i]);
     }
 }
 
@@ -147,7 +304,7 @@ void button_led_example(void) {
     for (int i = 0; i < 100; i++) {
         gpio_state_t button_state = gpio_read(BUTTON_PIN);
         gpio_write(LED_PIN, button_state);
-        delay(10000);
+        delay_ms(10);
     }
 }
 
@@ -161,10 +318,13 @@ int main(void) {
     // Example 2: Button-controlled LED
     button_led_example();
 
+    // Example 3: Parallel bus writes
+    parallel_bus_example();
+
     // Infinite loop (typical for embedded systems)
     while (1) {
         gpio_toggle(LED_PIN);
-        delay(1000000);
+        delay_ms(500);
     }
 
     return 0;  // Never reached
@@ -3,61 +3,140 @@
  * @brief Example demonstrating timer interrupt service routine (ISR)
  * 
  * This example shows:
- * - Timer configuration for periodic interrupts
- * - Interrupt service routine implementation
+ * - Tickless timekeeping: a free-running 1 MHz counter instead of a 1 kHz tick
+ * - One-shot compare interrupts programmed for the next expiry only
+ * - A hashed software timer wheel with microsecond deadlines
+ * - Sleeping with WFI between events instead of busy-waiting
  * - Volatile variables for ISR communication
  * - Atomic operations
  * - Minimal ISR execution time
  * 
- * Target: Generic ARM Cortex-M microcontroller
+ * The core wakes only when a timer is due (plus one counter overflow every
+ * ~71 minutes), so an idle system draws sleep current and delays and
+ * timeouts cost no CPU.
+ * 
+ * Target: Generic ARM Cortex-M microcontroller with a 32-bit TIM2 (e.g. STM32F4)
  * Note: This is a demonstration. Actual addresses depend on your hardware.
  */
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
+
+#include "cpu-sleep.h"
 
 // Timer register addresses (example for STM32-like MCU)
 #define TIM2_BASE           0x40000000UL
 #define TIM2_CR1            (*(volatile uint32_t *)(TIM2_BASE + 0x00))
 #define TIM2_DIER           (*(volatile uint32_t *)(TIM2_BASE + 0x0C))
 #define TIM2_SR             (*(volatile uint32_t *)(TIM2_BASE + 0x10))
+#define TIM2_EGR            (*(volatile uint32_t *)(TIM2_BASE + 0x14))
 #define TIM2_CNT            (*(volatile uint32_t *)(TIM2_BASE + 0x24))
 #define TIM2_PSC            (*(volatile uint32_t *)(TIM2_BASE + 0x28))
 #define TIM2_ARR            (*(volatile uint32_t *)(TIM2_BASE + 0x2C))
+#define TIM2_CCR1           (*(volatile uint32_t *)(TIM2_BASE + 0x34))
 
 // Timer control bits
 #define TIM_CR1_CEN         (1UL << 0)   // Counter enable
-#define TIM_DIER_UIE        (1UL << 0)   // Update interrupt enable
+#define TIM_DIER_UIE        (1UL << 0)   // Update (overflow) interrupt enable
+#define TIM_DIER_CC1IE      (1UL << 1)   // Compare 1 interrupt enable
 #define TIM_SR_UIF          (1UL << 0)   // Update interrupt flag
+#define TIM_SR_CC1IF        (1UL << 1)   // Compare 1 interrupt flag
+#define TIM_EGR_UG          (1UL << 0)   // Reload prescaler and counter
+#define TIM_EGR_CC1G        (1UL << 1)   // Force a compare 1 event
 
 // NVIC (Nested Vectored Interrupt Controller)
 #define NVIC_ISER0          (*(volatile uint32_t *)0xE000E100UL)
 #define TIM2_IRQn           28
 
-// Shared variables between ISR and main (must be volatile)
-static volatile uint32_t tick_count = 0;
+// Timer wheel geometry: 64 slots of 1024 us cover ~65 ms per revolution
+#define TIMER_WHEEL_SLOTS   64
+#define TIMER_SLOT_SHIFT    10
+#define TIMER_WHEEL_SPAN_US ((uint32_t)TIMER_WHEEL_SLOTS << TIMER_SLOT_SHIFT)
+#define TIMER_SLOT(t)       (((t) >> TIMER_SLOT_SHIFT) & (TIMER_WHEEL_SLOTS - 1))
+
+/**
+ * @brief Timer callback, called from TIM2_IRQHandler (keep it short)
+ */
+typedef void (*soft_timer_cb_t)(void *arg);
+
+// Software timer; storage is owned by the caller
+typedef struct soft_timer {
+    struct soft_timer *next;    // Wheel slot list
+    uint32_t deadline_us;       // Absolute expiry on the 32-bit us clock
+    uint32_t period_us;         // Re-arm interval, 0 for one-shot
+    soft_timer_cb_t callback;
+    void *arg;
+    bool armed;
+} soft_timer_t;
+
+// Wheel state, shared between main and the ISR (guarded by irq_save)
+static soft_timer_t *timer_wheel[TIMER_WHEEL_SLOTS];
+static uint64_t wheel_occupied = 0;     // Bit n set if slot n is non-empty
+
+// Upper 32 bits of the 64-bit microsecond clock
+static volatile uint32_t overflow_count = 0;
+
+// Set by the example periodic timer for the main loop
 static volatile bool timer_flag = false;
 
 /**
- * @brief Initialize timer for 1ms periodic interrupts
- * @param sysclk System clock frequency in Hz
+ * @brief Signed distance from b to a on the wrapping 32-bit us clock
+ */
+static inline int32_t time_diff(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b);
+}
+
+/**
+ * @brief Current time in microseconds (32-bit, wraps every ~71 minutes)
+ */
+uint32_t timer_now_us(void) {
+    return TIM2_CNT;
+}
+
+/**
+ * @brief Current time in microseconds since timer_init() (64-bit)
+ */
+uint64_t timer_now_us64(void) {
+    uint32_t high, low;
+
+    // Re-read if the counter overflowed between the two loads
+    do {
+        high = overflow_count;
+        low = TIM2_CNT;
+    } while (high != overflow_count);
+
+    // Overflow pending but not yet serviced (e.g. called with IRQs masked)
+    if ((TIM2_SR & TIM_SR_UIF) && low < 0x80000000UL) {
+        high++;
+    }
+    return ((uint64_t)high << 32) | low;
+}
+
+/**
+ * @brief Initialize TIM2 as a free-running 1 MHz counter
+ * @param sysclk Timer input clock frequency in Hz
+ * 
+ * No periodic interrupt is enabled; compare 1 is armed on demand for
+ * the earliest pending software timer.
  */
 void timer_init(uint32_t sysclk) {
     // Disable timer during configuration
     TIM2_CR1 &= ~TIM_CR1_CEN;
 
-    // Configure prescaler for 1kHz (1ms) tick
+    // Configure prescaler for a 1 MHz (1 us) count
     // PSC = (sysclk / desired_freq) - 1
-    TIM2_PSC = (sysclk / 1000) - 1;
+    TIM2_PSC = (sysclk / 1000000UL) - 1;
 
-    // Auto-reload value for 1ms period
-    TIM2_ARR = 1000 - 1;
+    // Count through the full 32-bit range
+    TIM2_ARR = 0xFFFFFFFFUL;
 
-    // Clear counter
-    TIM2_CNT = 0;
+    // Apply the prescaler now and start from zero
+    TIM2_EGR = TIM_EGR_UG;
+    TIM2_SR = 0;
 
-    // Enable update interrupt
-    TIM2_DIER |= TIM_DIER_UIE;
+    // Only the overflow interrupt runs unconditionally (once per ~71 min)
+    TIM2_DIER = TIM_DIER_UIE;
 
     // Enable TIM2 interrupt in NVIC
     NVIC_ISER0 |= (1UL << TIM2_IRQn);
@@ -66,6 +145,180 @@ void timer_init(uint32_t sysclk) {
     TIM2_CR1 |= TIM_CR1_CEN;
 }
 
+/**
+ * @brief Find the earliest armed deadline
+ * @param now Current time
+ * @param deadline Receives the earliest deadline
+ * @return false if no timer is armed
+ * 
+ * Timers are ordered by their distance from base = now - half a
+ * revolution, so slightly overdue timers (armed while interrupts were
+ * masked) sort first. Slots are visited in that order using the occupancy
+ * bitmap to skip empty ones, and the search stops at the first slot that
+ * holds a deadline within one revolution of base; timers further out share
+ * slots with nearer ones and are only chosen if nothing nearer exists.
+ * Caller holds irq_save().
+ */
+static bool wheel_next_deadline(uint32_t now, uint32_t *deadline) {
+    uint32_t base = now - TIMER_WHEEL_SPAN_US / 2;
+    unsigned start = TIMER_SLOT(base);
+    uint64_t pending = wheel_occupied;
+    bool found = false;
+    uint32_t earliest = 0;
+
+    // Rotate so bit 0 is the slot containing base
+    if (start != 0) {
+        pending = (pending >> start) | (pending << (TIMER_WHEEL_SLOTS - start));
+    }
+
+    while (pending != 0) {
+        unsigned offset = (unsigned)__builtin_ctzll(pending);
+        unsigned slot = (start + offset) & (TIMER_WHEEL_SLOTS - 1);
+
+        for (soft_timer_t *t = timer_wheel[slot]; t != NULL; t = t->next) {
+            if (!found || t->deadline_us - base < earliest - base) {
+                earliest = t->deadline_us;
+                found = true;
+            }
+        }
+        // Within this revolution: later slots cannot be earlier. The slot
+        // holding base also holds the revolution's last partial slot width,
+        // hence the margin.
+        if (found && earliest - base < TIMER_WHEEL_SPAN_US - (1UL << TIMER_SLOT_SHIFT)) {
+            break;
+        }
+        pending &= pending - 1;
+    }
+
+    *deadline = earliest;
+    return found;
+}
+
+/**
+ * @brief Program compare 1 for the earliest deadline, or disable it
+ * 
+ * Caller holds irq_save().
+ */
+static void timer_reprogram(void) {
+    uint32_t now = timer_now_us();
+    uint32_t deadline;
+
+    if (!wheel_next_deadline(now, &deadline)) {
+        TIM2_DIER &= ~TIM_DIER_CC1IE;   // Nothing pending: no wakeups
+        return;
+    }
+
+    TIM2_CCR1 = deadline;
+    TIM2_SR = (uint32_t)~TIM_SR_CC1IF;            // rc_w0: write 0 to clear
+    TIM2_DIER |= TIM_DIER_CC1IE;
+
+    // Deadline already passed (or passed while programming): fire now
+    if (time_diff(deadline, timer_now_us()) <= 0) {
+        TIM2_EGR = TIM_EGR_CC1G;
+    }
+}
+
+/**
+ * @brief Link a timer into its wheel slot (caller holds irq_save())
+ */
+static void wheel_insert(soft_timer_t *t) {
+    unsigned slot = TIMER_SLOT(t->deadline_us);
+
+    t->next = timer_wheel[slot];
+    timer_wheel[slot] = t;
+    wheel_occupied |= (1ULL << slot);
+    t->armed = true;
+}
+
+/**
+ * @brief Unlink a timer from its wheel slot (caller holds irq_save())
+ */
+static void wheel_remove(soft_timer_t *t) {
+    unsigned slot = TIMER_SLOT(t->deadline_us);
+
+    for (soft_timer_t **link = &timer_wheel[slot]; *link != NULL; link = &(*link)->next) {
+        if (*link == t) {
+            *link = t->next;
+            break;
+        }
+    }
+    if (timer_wheel[slot] == NULL) {
+        wheel_occupied &= ~(1ULL << slot);
+    }
+    t->armed = false;
+}
+
+/**
+ * @brief Arm a software timer
+ * @param t Timer (must stay valid while armed)
+ * @param delay_us Time until the first expiry
+ * @param period_us Re-arm interval after each expiry, 0 for one-shot
+ * @param callback Called from interrupt context on expiry
+ * @param arg Passed to callback
+ */
+void soft_timer_start(soft_timer_t *t, uint32_t delay_us, uint32_t period_us,
+                      soft_timer_cb_t callback, void *arg) {
+    uint32_t primask = irq_save();
+
+    if (t->armed) {
+        wheel_remove(t);
+    }
+    t->deadline_us = timer_now_us() + delay_us;
+    t->period_us = period_us;
+    t->callback = callback;
+    t->arg = arg;
+    wheel_insert(t);
+    timer_reprogram();
+
+    irq_restore(primask);
+}
+
+/**
+ * @brief Disarm a software timer (no-op if not armed)
+ */
+void soft_timer_stop(soft_timer_t *t) {
+    uint32_t primask = irq_save();
+
+    if (t->armed) {
+        wheel_remove(t);
+        timer_reprogram();
+    }
+
+    irq_restore(primask);
+}
+
+/**
+ * @brief Run every timer in a slot whose deadline has passed
+ * 
+ * Periodic timers are re-armed relative to their previous deadline, so
+ * they do not drift by the interrupt latency.
+ */
+static void wheel_expire_slot(unsigned slot, uint32_t now) {
+    soft_timer_t **link = &timer_wheel[slot];
+
+    while (*link != NULL) {
+        soft_timer_t *t = *link;
+
+        if (time_diff(t->deadline_us, now) > 0) {
+            link = &t->next;
+            continue;
+        }
+
+        // Unlink before the callback so it may re-arm or stop the timer
+        *link = t->next;
+        t->armed = false;
+        if (t->period_us != 0) {
+            t->deadline_us += t->period_us;
+            wheel_insert(t);
+        }
+        t->callback(t->arg);
+    }
+
+    if (timer_wheel[slot] == NULL) {
+        wheel_occupied &= ~(1ULL << slot);
+    }
+}
+
 /**
  * @brief Timer interrupt service routine
  * 
@@ -77,28 +330,64 @@ void timer_init(uint32_t sysclk) {
  * - Clear interrupt flag
  */
 void TIM2_IRQHandler(void) {
-    // Check if update interrupt occurred
-    if (TIM2_SR & TIM_SR_UIF) {
-        // Clear interrupt flag (MUST do this!)
-        TIM2_SR &= ~TIM_SR_UIF;
+    uint32_t sr = TIM2_SR;
 
-        // Increment tick counter (atomic on 32-bit ARM)
-        tick_count++;
+    // Counter wrapped: extend the clock to 64 bits
+    if (sr & TIM_SR_UIF) {
+        TIM2_SR = (uint32_t)~TIM_SR_UIF;
+        overflow_count++;
+    }
 
-        // Set flag for main loop
-        timer_flag = true;
+    // Earliest deadline reached
+    if (sr & TIM_SR_CC1IF) {
+        TIM2_SR = (uint32_t)~TIM_SR_CC1IF;
+
+        uint32_t now = timer_now_us();
+        uint64_t occupied = wheel_occupied;
+
+        // Deadlines up to now can live in any occupied slot (late interrupts,
+        // timers armed with a zero delay); each slot list is short
+        while (occupied != 0) {
+            unsigned slot = (unsigned)__builtin_ctzll(occupied);
+            occupied &= occupied - 1;
+            wheel_expire_slot(slot, now);
+        }
 
-        // Minimal work in ISR - defer processing to main loop
+        // Program the next wakeup (or none)
+        timer_reprogram();
     }
 }
 
 /**
  * @brief Get current tick count (thread-safe)
- * @return Current tick count
+ * @return Milliseconds since timer_init()
  */
 uint32_t get_tick_count(void) {
-    // Reading 32-bit value is atomic on ARM Cortex-M
-    return tick_count;
+    return (uint32_t)(timer_now_us64() / 1000U);
+}
+
+/**
+ * @brief Set a bool flag; callback for one-shot waits
+ */
+static void set_flag(void *arg) {
+    *(volatile bool *)arg = true;
+}
+
+/**
+ * @brief Sleep for the specified number of microseconds
+ * @param us Microseconds to delay
+ * 
+ * The core sleeps in WFI; other interrupts may wake it early, in which
+ * case it goes back to sleep until the deadline.
+ */
+void delay_us(uint32_t us) {
+    soft_timer_t timer = {0};
+    volatile bool expired = false;
+
+    soft_timer_start(&timer, us, 0, set_flag, (void *)&expired);
+    while (!expired) {
+        cpu_sleep_unless(&expired);
+    }
 }
 
 /**
@@ -106,10 +395,12 @@ uint32_t get_tick_count(void) {
  * @param ms Milliseconds to delay
  */
 void delay_ms(uint32_t ms) {
-    uint32_t start = get_tick_count();
-    while ((get_tick_count() - start) < ms) {
-        // Wait
+    // Split long delays so each deadline stays well inside the 32-bit range
+    while (ms > 1000000UL) {
+        delay_us(1000000000UL);
+        ms -= 1000000UL;
     }
+    delay_us(ms * 1000UL);
 }
 
 /**
@@ -128,23 +419,20 @@ bool check_timer_flag(void) {
  * @brief Example: Periodic task execution
  */
 void periodic_task_example(void) {
-    uint32_t last_tick = 0;
-    const uint32_t TASK_PERIOD_MS = 100;  // Run every 100ms
+    static soft_timer_t task_timer;
+    const uint32_t TASK_PERIOD_US = 100000;  // Run every 100ms
 
-    while (1) {
-        uint32_t current_tick = get_tick_count();
-
-        if ((current_tick - last_tick) >= TASK_PERIOD_MS) {
-            last_tick = current_tick;
+    soft_timer_start(&task_timer, TASK_PERIOD_US, TASK_PERIOD_US,
+                     set_flag, (void *)&timer_flag);
 
+    while (1) {
+        if (check_timer_flag()) {
             // Execute periodic task
             // (In real code, toggle LED, read sensor, etc.)
         }
 
-        // Check for timer events
-        if (check_timer_flag()) {
-            // Handle 1ms timer event
-        }
+        // Nothing to do until the next timer or peripheral interrupt
+        cpu_sleep_unless(&timer_flag);
     }
 }
 
@@ -152,18 +440,25 @@ void periodic_task_example(void) {
  * @brief Example: Timeout detection
  */
 bool wait_with_timeout(uint32_t timeout_ms) {
-    uint32_t start = get_tick_count();
+    soft_timer_t timeout = {0};
+    volatile bool expired = false;
 
-    while (1) {
-        // Check timeout
-        if ((get_tick_count() - start) >= timeout_ms) {
-            return false;  // Timeout occurred
-        }
+    soft_timer_start(&timeout, timeout_ms * 1000UL, 0, set_flag, (void *)&expired);
 
+    while (1) {
         // Check for event (example: button press)
         // if (event_occurred()) {
+        //     soft_timer_stop(&timeout);
         //     return true;
         // }
+
+        // Check timeout
+        if (expired) {
+            return false;  // Timeout occurred
+        }
+
+        // The event's interrupt or the timeout wakes us
+        cpu_sleep_unless(&expired);
     }
 }
 
@@ -171,28 +466,30 @@ bool wait_with_timeout(uint32_t timeout_ms) {
  * @brief Main function
  */
 int main(void) {
-    // Initialize timer (assuming 72MHz system clock)
+    // Initialize timer (assuming 72MHz timer clock)
     timer_init(72000000);
 
     // Example 1: Simple delay
     delay_ms(1000);  // 1 second delay
+    delay_us(250);   // Sub-millisecond deadlines work the same way
 
     // Example 2: Periodic task execution
     // periodic_task_example();  // Uncomment to run
 
     // Example 3: Timeout detection
     bool success = wait_with_timeout(5000);  // 5 second timeout
+    (void)success;
 
     // Main loop
     while (1) {
         // Process timer events
         if (check_timer_flag()) {
-            // Handle 1ms tick
+            // Handle periodic timer event
         }
 
-        // Other main loop tasks
+        // Other main loop tasks, then sleep until the next interrupt
+        cpu_sleep_unless(&timer_flag);
     }
 
     return 0;  // Never reached
 }
-
@@ -4,11 +4,16 @@
  * 
  * This example shows:
  * - UART initialization and configuration
- * - Interrupt-driven UART transmission
- * - Circular buffer for received data
+ * - Circular DMA reception with idle-line detection
+ * - DMA transmission from a TX ring with a completion callback
+ * - Lock-free SPSC rings (../common/spsc-ring.h) for RX and TX data
  * - Hardware abstraction layer
  * - Error handling
  * 
+ * The CPU never touches individual bytes: DMA moves them between the
+ * UART and the rings, and interrupts fire only when the line goes idle,
+ * when the RX ring is half or fully wrapped, or when a TX block is done.
+ * 
  * Target: Generic ARM Cortex-M microcontroller
  * Note: This is a demonstration. Actual addresses depend on your hardware.
  */
@@ -17,150 +22,273 @@
 #include <stdbool.h>
 #include <string.h>
 
+#include "cpu-sleep.h"
+#include "../common/spsc-ring.h"
+
 // UART register addresses (example for STM32-like MCU)
 #define USART1_BASE         0x40013800UL
 #define USART1_SR           (*(volatile uint32_t *)(USART1_BASE + 0x00))
 #define USART1_DR           (*(volatile uint32_t *)(USART1_BASE + 0x04))
 #define USART1_BRR          (*(volatile uint32_t *)(USART1_BASE + 0x08))
 #define USART1_CR1          (*(volatile uint32_t *)(USART1_BASE + 0x0C))
+#define USART1_CR3          (*(volatile uint32_t *)(USART1_BASE + 0x14))
 
 // UART status register bits
 #define USART_SR_TXE        (1UL << 7)   // Transmit data register empty
 #define USART_SR_RXNE       (1UL << 5)   // Read data register not empty
+#define USART_SR_IDLE       (1UL << 4)   // Idle line detected
 #define USART_SR_ORE        (1UL << 3)   // Overrun error
 #define USART_SR_FE         (1UL << 1)   // Framing error
 
 // UART control register bits
 #define USART_CR1_UE        (1UL << 13)  // USART enable
+#define USART_CR1_IDLEIE    (1UL << 4)   // IDLE interrupt enable
 #define USART_CR1_TE        (1UL << 3)   // Transmitter enable
 #define USART_CR1_RE        (1UL << 2)   // Receiver enable
-#define USART_CR1_RXNEIE    (1UL << 5)   // RXNE interrupt enable
+#define USART_CR3_DMAT      (1UL << 7)   // DMA enable for transmit
+#define USART_CR3_DMAR      (1UL << 6)   // DMA enable for receive
+
+// DMA1 registers (STM32F1: channel 4 = USART1_TX, channel 5 = USART1_RX)
+#define DMA1_BASE           0x40020000UL
+#define DMA1_ISR            (*(volatile uint32_t *)(DMA1_BASE + 0x00))
+#define DMA1_IFCR           (*(volatile uint32_t *)(DMA1_BASE + 0x04))
+#define DMA1_CCR(ch)        (*(volatile uint32_t *)(DMA1_BASE + 0x08 + 20 * ((ch) - 1)))
+#define DMA1_CNDTR(ch)      (*(volatile uint32_t *)(DMA1_BASE + 0x0C + 20 * ((ch) - 1)))
+#define DMA1_CPAR(ch)       (*(volatile uint32_t *)(DMA1_BASE + 0x10 + 20 * ((ch) - 1)))
+#define DMA1_CMAR(ch)       (*(volatile uint32_t *)(DMA1_BASE + 0x14 + 20 * ((ch) - 1)))
+#define UART_TX_DMA_CH      4
+#define UART_RX_DMA_CH      5
+
+// DMA channel configuration bits
+#define DMA_CCR_EN          (1UL << 0)   // Channel enable
+#define DMA_CCR_TCIE        (1UL << 1)   // Transfer complete interrupt enable
+#define DMA_CCR_HTIE        (1UL << 2)   // Half transfer interrupt enable
+#define DMA_CCR_DIR         (1UL << 4)   // Memory to peripheral
+#define DMA_CCR_CIRC        (1UL << 5)   // Circular mode
+#define DMA_CCR_MINC        (1UL << 7)   // Memory increment
+#define DMA_CCR_PL_HIGH     (2UL << 12)  // Priority level high
+
+// DMA interrupt flags, 4 bits per channel
+#define DMA_ISR_TCIF(ch)    (1UL << (4 * ((ch) - 1) + 1))
+#define DMA_ISR_HTIF(ch)    (1UL << (4 * ((ch) - 1) + 2))
+#define DMA_IFCR_CGIF(ch)   (1UL << (4 * ((ch) - 1)))
+
+// NVIC (Nested Vectored Interrupt Controller)
+#define NVIC_ISER0          (*(volatile uint32_t *)0xE000E100UL)
+#define NVIC_ISER1          (*(volatile uint32_t *)0xE000E104UL)
+#define DMA1_CH4_IRQn       14
+#define DMA1_CH5_IRQn       15
+#define USART1_IRQn         37
 
-// Circular buffer for received data
+// Rings for received and transmitted data (sizes must be powers of two)
 #define RX_BUFFER_SIZE      256
+#define TX_BUFFER_SIZE      256
 
-typedef struct {
-    uint8_t buffer[RX_BUFFER_SIZE];
-    volatile uint16_t head;
-    volatile uint16_t tail;
-} circular_buffer_t;
+SPSC_RING_ASSERT_SIZE(RX_BUFFER_SIZE);
+SPSC_RING_ASSERT_SIZE(TX_BUFFER_SIZE);
 
-static circular_buffer_t rx_buffer = {0};
+static uint8_t rx_storage[RX_BUFFER_SIZE];
+static uint8_t tx_storage[TX_BUFFER_SIZE];
+
+// RX: produced by DMA (published from ISRs), consumed by main
+static spsc_ring_t rx_buffer;
+
+// TX: produced by main, consumed by DMA (retired in the TC ISR)
+static spsc_ring_t tx_ring;
 
 /**
- * @brief Initialize circular buffer
- * @param cb Pointer to circular buffer
+ * @brief Called from interrupt context when the TX ring has drained
  */
-void buffer_init(circular_buffer_t *cb) {
-    cb->head = 0;
-    cb->tail = 0;
+typedef void (*uart_tx_complete_cb_t)(void);
+
+static uart_tx_complete_cb_t tx_complete_cb = NULL;
+static volatile uint16_t tx_dma_len = 0;     // Bytes in the running DMA transfer
+static uint16_t rx_dma_pos = 0;              // DMA write offset at the last publish
+static uint32_t rx_overruns = 0;             // DMA lapped unread RX data
+
+/**
+ * @brief Initialize UART with DMA reception and transmission
+ * @param baudrate Desired baud rate
+ * @param sysclk System clock frequency in Hz
+ */
+void uart_init(uint32_t baudrate, uint32_t sysclk) {
+    // Disable UART during configuration
+    USART1_CR1 &= ~USART_CR1_UE;
+
+    // Configure baud rate
+    // BRR = sysclk / baudrate
+    USART1_BRR = sysclk / baudrate;
+
+    // Initialize RX/TX rings
+    spsc_ring_init(&rx_buffer, rx_storage, RX_BUFFER_SIZE);
+    spsc_ring_init(&tx_ring, tx_storage, TX_BUFFER_SIZE);
+    rx_dma_pos = 0;
+    tx_dma_len = 0;
+
+    // RX: circular DMA from DR into rx_buffer, never stopped
+    DMA1_CCR(UART_RX_DMA_CH) = 0;
+    DMA1_CPAR(UART_RX_DMA_CH) = (uint32_t)(uintptr_t)&USART1_DR;
+    DMA1_CMAR(UART_RX_DMA_CH) = (uint32_t)(uintptr_t)rx_storage;
+    DMA1_CNDTR(UART_RX_DMA_CH) = RX_BUFFER_SIZE;
+    DMA1_CCR(UART_RX_DMA_CH) = DMA_CCR_MINC | DMA_CCR_CIRC | DMA_CCR_HTIE |
+                               DMA_CCR_TCIE | DMA_CCR_PL_HIGH | DMA_CCR_EN;
+
+    // TX: memory to DR, armed per block by uart_tx_kick()
+    DMA1_CCR(UART_TX_DMA_CH) = 0;
+    DMA1_CPAR(UART_TX_DMA_CH) = (uint32_t)(uintptr_t)&USART1_DR;
+
+    // Route both directions through DMA
+    USART1_CR3 = USART_CR3_DMAR | USART_CR3_DMAT;
+
+    // Enable UART, transmitter, receiver, and idle-line interrupt
+    USART1_CR1 = USART_CR1_UE | USART_CR1_TE | USART_CR1_RE | USART_CR1_IDLEIE;
+
+    // Enable DMA and USART interrupts in NVIC
+    NVIC_ISER0 = (1UL << DMA1_CH4_IRQn) | (1UL << DMA1_CH5_IRQn);
+    NVIC_ISER1 = (1UL << (USART1_IRQn - 32));
 }
 
 /**
- * @brief Write byte to circular buffer
- * @param cb Pointer to circular buffer
- * @param data Byte to write
- * @return true if successful, false if buffer full
+ * @brief Register the TX completion callback
+ * @param cb Function called when all queued bytes have been sent, or NULL
  */
-bool buffer_write(circular_buffer_t *cb, uint8_t data) {
-    uint16_t next_head = (cb->head + 1) % RX_BUFFER_SIZE;
-    
-    if (next_head == cb->tail) {
-        return false;  // Buffer full
-    }
-    
-    cb->buffer[cb->head] = data;
-    cb->head = next_head;
-    return true;
+void uart_set_tx_callback(uart_tx_complete_cb_t cb) {
+    tx_complete_cb = cb;
 }
 
 /**
- * @brief Read byte from circular buffer
- * @param cb Pointer to circular buffer
- * @param data Pointer to store read byte
- * @return true if successful, false if buffer empty
+ * @brief Publish bytes written by the RX DMA since the last call
+ * 
+ * The DMA write offset is RX_BUFFER_SIZE - CNDTR. Called from the idle
+ * line, half-transfer and transfer-complete interrupts, so a burst is
+ * visible at the latest when the line goes quiet or half the ring fills,
+ * and never more than half a ring arrives between two calls.
  */
-bool buffer_read(circular_buffer_t *cb, uint8_t *data) {
-    if (cb->head == cb->tail) {
-        return false;  // Buffer empty
-    }
-    
-    *data = cb->buffer[cb->tail];
-    cb->tail = (cb->tail + 1) % RX_BUFFER_SIZE;
-    return true;
+static void uart_rx_publish(void) {
+    uint16_t pos = (uint16_t)((RX_BUFFER_SIZE - DMA1_CNDTR(UART_RX_DMA_CH)) & (RX_BUFFER_SIZE - 1));
+    uint16_t arrived = (uint16_t)((pos - rx_dma_pos) & (RX_BUFFER_SIZE - 1));
+
+    rx_dma_pos = pos;
+    spsc_ring_commit_write(&rx_buffer, arrived);
 }
 
 /**
- * @brief Get number of bytes available in buffer
- * @param cb Pointer to circular buffer
- * @return Number of bytes available
+ * @brief Drop RX data the DMA has already overwritten
+ * 
+ * The DMA cannot be told to stop at the tail, so a slow consumer sees more
+ * than RX_BUFFER_SIZE bytes pending. Called by the consumer before reading.
  */
-uint16_t buffer_available(const circular_buffer_t *cb) {
-    return (cb->head - cb->tail + RX_BUFFER_SIZE) % RX_BUFFER_SIZE;
+static void uart_rx_check_overrun(void) {
+    if (spsc_ring_count(&rx_buffer) > RX_BUFFER_SIZE) {
+        rx_overruns++;
+        spsc_ring_discard(&rx_buffer);
+    }
 }
 
 /**
- * @brief Initialize UART
- * @param baudrate Desired baud rate
- * @param sysclk System clock frequency in Hz
+ * @brief Start a DMA transfer for the next contiguous block of the TX ring
+ * 
+ * Called from main (when data is queued on an idle channel) and from the
+ * TX complete interrupt. The caller must keep the TX DMA interrupt from
+ * running concurrently.
  */
-void uart_init(uint32_t baudrate, uint32_t sysclk) {
-    // Disable UART during configuration
-    USART1_CR1 &= ~USART_CR1_UE;
+static void uart_tx_kick(void) {
+    const uint8_t *span;
 
-    // Configure baud rate
-    // BRR = sysclk / baudrate
-    USART1_BRR = sysclk / baudrate;
+    if (tx_dma_len != 0) {
+        return;  // Busy
+    }
 
-    // Enable UART, transmitter, receiver, and RX interrupt
-    USART1_CR1 = USART_CR1_UE | USART_CR1_TE | USART_CR1_RE | USART_CR1_RXNEIE;
+    // Up to the write position, or to the end of the buffer if it wrapped
+    uint16_t len = (uint16_t)spsc_ring_peek_read(&tx_ring, &span);
+    if (len == 0) {
+        return;  // Nothing to send
+    }
 
-    // Initialize RX buffer
-    buffer_init(&rx_buffer);
+    tx_dma_len = len;
+    DMA1_CCR(UART_TX_DMA_CH) = 0;
+    DMA1_CMAR(UART_TX_DMA_CH) = (uint32_t)(uintptr_t)span;
+    DMA1_CNDTR(UART_TX_DMA_CH) = len;
+    DMA1_CCR(UART_TX_DMA_CH) = DMA_CCR_MINC | DMA_CCR_DIR | DMA_CCR_TCIE | DMA_CCR_EN;
 }
 
 /**
- * @brief UART interrupt service routine
+ * @brief UART interrupt service routine (idle line and errors only)
  */
 void USART1_IRQHandler(void) {
-    // Check for receive interrupt
-    if (USART1_SR & USART_SR_RXNE) {
-        uint8_t data = (uint8_t)(USART1_DR & 0xFF);
-        
-        // Store in circular buffer
-        if (!buffer_write(&rx_buffer, data)) {
-            // Buffer overflow - data lost
-        }
-    }
+    uint32_t sr = USART1_SR;
 
-    // Check for errors
-    if (USART1_SR & (USART_SR_ORE | USART_SR_FE)) {
-        // Clear error by reading DR
+    if (sr & (USART_SR_IDLE | USART_SR_ORE | USART_SR_FE)) {
+        // Clear IDLE/error flags: SR read followed by DR read
         (void)USART1_DR;
     }
+
+    if (sr & USART_SR_IDLE) {
+        // Burst finished: make everything received so far visible
+        uart_rx_publish();
+    }
+}
+
+/**
+ * @brief RX DMA interrupt (half and full ring)
+ */
+void DMA1_Channel5_IRQHandler(void) {
+    if (DMA1_ISR & (DMA_ISR_HTIF(UART_RX_DMA_CH) | DMA_ISR_TCIF(UART_RX_DMA_CH))) {
+        DMA1_IFCR = DMA_IFCR_CGIF(UART_RX_DMA_CH);
+        uart_rx_publish();
+    }
+}
+
+/**
+ * @brief TX DMA interrupt: retire the finished block, start the next one
+ */
+void DMA1_Channel4_IRQHandler(void) {
+    if (DMA1_ISR & DMA_ISR_TCIF(UART_TX_DMA_CH)) {
+        DMA1_IFCR = DMA_IFCR_CGIF(UART_TX_DMA_CH);
+
+        spsc_ring_commit_read(&tx_ring, tx_dma_len);
+        tx_dma_len = 0;
+        uart_tx_kick();
+
+        if (tx_dma_len == 0 && tx_complete_cb != NULL) {
+            tx_complete_cb();
+        }
+    }
+}
+
+/**
+ * @brief Queue bytes for DMA transmission (non-blocking)
+ * @param data Bytes to send
+ * @param len Number of bytes
+ * @return Number of bytes queued (less than len if the TX ring is full)
+ */
+uint16_t uart_write(const uint8_t *data, uint16_t len) {
+    uint16_t queued = (uint16_t)spsc_ring_write_n(&tx_ring, data, len);
+
+    // Start DMA if idle; mask its interrupt so it cannot race the kick
+    DMA1_CCR(UART_TX_DMA_CH) &= ~DMA_CCR_TCIE;
+    uart_tx_kick();
+    DMA1_CCR(UART_TX_DMA_CH) |= DMA_CCR_TCIE;
+
+    return queued;
 }
 
 /**
  * @brief Send single byte via UART
  * @param data Byte to send
+ * @return true if queued, false if the TX ring is full
  */
-void uart_send_byte(uint8_t data) {
-    // Wait for transmit register to be empty
-    while (!(USART1_SR & USART_SR_TXE)) {
-        // Wait
-    }
-    
-    USART1_DR = data;
+bool uart_send_byte(uint8_t data) {
+    return uart_write(&data, 1) == 1;
 }
 
 /**
  * @brief Send string via UART
  * @param str Null-terminated string to send
+ * @return Number of bytes queued
  */
-void uart_send_string(const char *str) {
-    while (*str) {
-        uart_send_byte((uint8_t)*str++);
-    }
+uint16_t uart_send_string(const char *str) {
+    return uart_write((const uint8_t *)str, (uint16_t)strlen(str));
 }
 
 /**
@@ -169,7 +297,19 @@ void uart_send_string(const char *str) {
  * @return true if byte received, false if no data available
  */
 bool uart_receive_byte(uint8_t *data) {
-    return buffer_read(&rx_buffer, data);
+    uart_rx_check_overrun();
+    return spsc_ring_read(&rx_buffer, data);
+}
+
+/**
+ * @brief Receive up to len bytes from UART (non-blocking)
+ * @param data Destination buffer
+ * @param len Maximum number of bytes
+ * @return Number of bytes copied
+ */
+uint16_t uart_read(uint8_t *data, uint16_t len) {
+    uart_rx_check_overrun();
+    return (uint16_t)spsc_ring_read_n(&rx_buffer, data, len);
 }
 
 /**
@@ -177,20 +317,33 @@ bool uart_receive_byte(uint8_t *data) {
  * @return Number of bytes available
  */
 uint16_t uart_available(void) {
-    return buffer_available(&rx_buffer);
+    uart_rx_check_overrun();
+    return (uint16_t)spsc_ring_count(&rx_buffer);
+}
+
+/**
+ * @brief Number of times RX DMA overwrote unread data
+ * @return Overrun count since uart_init()
+ */
+uint32_t uart_rx_overruns(void) {
+    return rx_overruns;
 }
 
 /**
  * @brief Example: Echo received characters
  */
 void uart_echo_example(void) {
-    uint8_t data;
+    uint8_t data[64];
     
     while (1) {
-        if (uart_receive_byte(&data)) {
-            // Echo back received character
-            uart_send_byte(data);
+        uint16_t n;
+        while ((n = uart_read(data, sizeof(data))) > 0) {
+            // Echo back received bytes (dropped if TX ring is full)
+            (void)uart_write(data, n);
         }
+
+        // Sleep until the next idle-line or DMA interrupt
+        cpu_wait_for_interrupt();
     }
 }
 
@@ -198,8 +351,8 @@ void uart_echo_example(void) {
  * @brief Main function
  */
 int main(void) {
-    // Initialize UART (115200 baud, 72MHz system clock)
-    uart_init(115200, 72000000);
+    // Initialize UART (921600 baud, 72MHz system clock)
+    uart_init(921600, 72000000);
 
     // Send startup message
     uart_send_string("UART Example Started\r\n");
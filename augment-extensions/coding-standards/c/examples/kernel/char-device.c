@@ -8,11 +8,29 @@
  * - Device number allocation
  * - Module initialization and cleanup
  * - Kernel memory allocation
+ * - Multi-page ring shared with userspace through mmap
+ * - Blocking and non-blocking reads with poll()/epoll wakeups
+ * - Per-CPU statistics in sysfs, dev_dbg() and tracepoints for tracing
+ * 
+ * Data written to the device is appended to a ring; read() consumes it.
+ * A consumer may instead mmap the ring (layout in chardev-ring.h) and
+ * read records in place, advancing the tail itself, with poll() to sleep
+ * when the ring is empty: no copy and no syscall per record.
+ * 
+ * Locking:
+ * - Writers serialize on ring_write_lock, readers on ring_read_lock, so
+ *   any number of each may share the device while the ring itself stays
+ *   single-producer/single-consumer and a reader never blocks a writer
+ * - head and tail are published with release stores and read with
+ *   acquire loads; neither lock is needed to look at the fill level
+ * - While the ring is mapped the mapping owns tail and read() fails
+ *   with -EBUSY
+ * - Statistics are per-CPU and summed only when sysfs is read
  * 
  * Build: make
  * Load: sudo insmod char-device.ko
  * Test: echo "test" > /dev/chardev0
- *       cat /dev/chardev0
+ *       dd if=/dev/chardev0 bs=4096 count=1 status=none
  * Unload: sudo rmmod char-device
  */
 
@@ -23,10 +41,25 @@
 #include <linux/device.h>
 #include <linux/slab.h>
 #include <linux/uaccess.h>
+#include <linux/vmalloc.h>
+#include <linux/mm.h>
+#include <linux/poll.h>
+#include <linux/wait.h>
+#include <linux/mutex.h>
+#include <linux/percpu.h>
+#include <linux/atomic.h>
+
+#include "chardev-ring.h"
+
+#define CREATE_TRACE_POINTS
+#include "chardev_trace.h"
 
 #define DEVICE_NAME "chardev"
 #define CLASS_NAME  "chardev_class"
-#define BUFFER_SIZE 1024
+
+#define RING_SIZE       CHARDEV_RING_DATA_SIZE
+#define RING_MASK       (RING_SIZE - 1)
+#define RING_MMAP_SIZE  (PAGE_SIZE + RING_SIZE)
 
 MODULE_LICENSE("GPL");
 MODULE_AUTHOR("Example Author");
@@ -38,72 +71,310 @@ static struct class *chardev_class = NULL;
 static struct device *chardev_device = NULL;
 static struct cdev chardev_cdev;
 
-// Device buffer
-static char *device_buffer = NULL;
-static size_t buffer_size = 0;
+// Ring: one header page followed by the data pages, all mappable
+static void *ring_area = NULL;
+static struct chardev_ring_header *ring_hdr = NULL;
+static u8 *ring_data = NULL;
+
+// One producer and one consumer at a time
+static DEFINE_MUTEX(ring_write_lock);
+static DEFINE_MUTEX(ring_read_lock);
+
+// Readers/pollers waiting for data, pollers waiting for space
+static DECLARE_WAIT_QUEUE_HEAD(ring_wait);
+
+// Number of live VMAs mapping the ring
+static atomic_t ring_mappings = ATOMIC_INIT(0);
+
+// Data path counters; each CPU only touches its own copy
+struct chardev_stats {
+    u64 reads;
+    u64 read_bytes;
+    u64 writes;
+    u64 write_bytes;
+    u64 full;
+};
+
+static DEFINE_PER_CPU(struct chardev_stats, chardev_stats);
+
+/**
+ * @brief Bytes written and not yet consumed
+ * 
+ * tail lives in a page userspace can write, so the result is untrusted:
+ * anything above RING_SIZE means the consumer corrupted it.
+ */
+static u32 ring_used(void) {
+    return smp_load_acquire(&ring_hdr->head) - READ_ONCE(ring_hdr->tail);
+}
+
+/**
+ * @brief Wake waiters for the given poll events, if there are any
+ */
+static void ring_wake(__poll_t events) {
+    if (wq_has_sleeper(&ring_wait)) {
+        wake_up_interruptible_poll(&ring_wait, events);
+    }
+}
 
 /**
  * @brief Device open function
  */
 static int chardev_open(struct inode *inode, struct file *file) {
-    pr_info("chardev: Device opened\n");
-    return 0;
+    dev_dbg(chardev_device, "opened by %s (%d)\n", current->comm, task_pid_nr(current));
+    return stream_open(inode, file);
 }
 
 /**
  * @brief Device release function
  */
 static int chardev_release(struct inode *inode, struct file *file) {
-    pr_info("chardev: Device closed\n");
+    dev_dbg(chardev_device, "released by %s (%d)\n", current->comm, task_pid_nr(current));
     return 0;
 }
 
 /**
  * @brief Device read function
+ * 
+ * Consumes up to count bytes from the ring. Blocks while the ring is
+ * empty unless the file is O_NONBLOCK. Fails with -EBUSY while the ring
+ * is mapped, since the mapping's consumer owns tail.
  */
 static ssize_t chardev_read(struct file *file, char __user *user_buffer,
                             size_t count, loff_t *offset) {
+    u32 avail, tail, pos, first;
     size_t to_read;
+    ssize_t ret;
     
-    if (*offset >= buffer_size) {
-        return 0;  // EOF
+    if (count == 0) {
+        return 0;
     }
     
-    to_read = min(count, buffer_size - (size_t)*offset);
+    if (mutex_lock_interruptible(&ring_read_lock)) {
+        return -ERESTARTSYS;
+    }
+    
+    while ((avail = ring_used()) == 0 || atomic_read(&ring_mappings)) {
+        if (atomic_read(&ring_mappings)) {
+            ret = -EBUSY;
+            goto out;
+        }
+        mutex_unlock(&ring_read_lock);
+        
+        if (file->f_flags & O_NONBLOCK) {
+            return -EAGAIN;
+        }
+        if (wait_event_interruptible(ring_wait,
+                                     ring_used() != 0 || atomic_read(&ring_mappings))) {
+            return -ERESTARTSYS;
+        }
+        if (mutex_lock_interruptible(&ring_read_lock)) {
+            return -ERESTARTSYS;
+        }
+    }
+    
+    if (avail > RING_SIZE) {
+        ret = -EIO;
+        goto out;
+    }
+    
+    tail = READ_ONCE(ring_hdr->tail);
+    pos = tail & RING_MASK;
+    to_read = min_t(size_t, count, avail);
+    first = min_t(size_t, to_read, RING_SIZE - pos);
     
-    if (copy_to_user(user_buffer, device_buffer + *offset, to_read)) {
-        return -EFAULT;
+    // At most two copies: up to the end of the data pages, then wrapped
+    if (copy_to_user(user_buffer, ring_data + pos, first) ||
+        copy_to_user(user_buffer + first, ring_data, to_read - first)) {
+        ret = -EFAULT;
+        goto out;
     }
     
-    *offset += to_read;
-    pr_info("chardev: Read %zu bytes\n", to_read);
+    smp_store_release(&ring_hdr->tail, tail + to_read);
+    ret = to_read;
     
-    return to_read;
+    this_cpu_inc(chardev_stats.reads);
+    this_cpu_add(chardev_stats.read_bytes, to_read);
+    trace_chardev_read(to_read, smp_load_acquire(&ring_hdr->head), tail + to_read);
+    
+out:
+    mutex_unlock(&ring_read_lock);
+    if (ret > 0) {
+        ring_wake(EPOLLOUT | EPOLLWRNORM);
+    }
+    return ret;
 }
 
 /**
  * @brief Device write function
+ * 
+ * Appends as much of the data as fits. The producer never waits for the
+ * consumer: a full ring gives a short write, or -EAGAIN if nothing fits.
  */
 static ssize_t chardev_write(struct file *file, const char __user *user_buffer,
                              size_t count, loff_t *offset) {
+    u32 head, used, pos, first;
     size_t to_write;
+    ssize_t ret;
     
-    if (count > BUFFER_SIZE) {
-        return -EINVAL;
+    if (count == 0) {
+        return 0;
+    }
+    
+    if (mutex_lock_interruptible(&ring_write_lock)) {
+        return -ERESTARTSYS;
+    }
+    
+    head = ring_hdr->head;
+    used = head - smp_load_acquire(&ring_hdr->tail);
+    if (used > RING_SIZE) {
+        ret = -EIO;
+        goto out;
+    }
+    if (used == RING_SIZE) {
+        this_cpu_inc(chardev_stats.full);
+        trace_chardev_full(count);
+        ret = -EAGAIN;
+        goto out;
+    }
+    
+    pos = head & RING_MASK;
+    to_write = min_t(size_t, count, RING_SIZE - used);
+    first = min_t(size_t, to_write, RING_SIZE - pos);
+    
+    if (copy_from_user(ring_data + pos, user_buffer, first) ||
+        copy_from_user(ring_data, user_buffer + first, to_write - first)) {
+        ret = -EFAULT;
+        goto out;
+    }
+    
+    // Publish the data before the new head becomes visible
+    smp_store_release(&ring_hdr->head, head + to_write);
+    ret = to_write;
+    
+    this_cpu_inc(chardev_stats.writes);
+    this_cpu_add(chardev_stats.write_bytes, to_write);
+    trace_chardev_write(to_write, head + to_write, READ_ONCE(ring_hdr->tail));
+    
+out:
+    mutex_unlock(&ring_write_lock);
+    if (ret > 0) {
+        ring_wake(EPOLLIN | EPOLLRDNORM);
     }
+    return ret;
+}
+
+/**
+ * @brief Device poll function
+ * 
+ * Readable while the ring holds data, writable while it has space. A
+ * consumer that advances tail through the mapping does not wake writers
+ * polling for EPOLLOUT; only read() does.
+ */
+static __poll_t chardev_poll(struct file *file, poll_table *wait) {
+    __poll_t mask = 0;
+    u32 used;
+    
+    poll_wait(file, &ring_wait, wait);
+    
+    used = ring_used();
+    if (used > RING_SIZE) {
+        return EPOLLERR;
+    }
+    if (used != 0) {
+        mask |= EPOLLIN | EPOLLRDNORM;
+    }
+    if (used != RING_SIZE) {
+        mask |= EPOLLOUT | EPOLLWRNORM;
+    }
+    
+    return mask;
+}
+
+/**
+ * @brief Count VMAs copied by fork() or split by munmap()/mprotect()
+ */
+static void chardev_vm_open(struct vm_area_struct *vma) {
+    atomic_inc(&ring_mappings);
+}
+
+/**
+ * @brief Drop a VMA; wakes readers once the last mapping is gone
+ */
+static void chardev_vm_close(struct vm_area_struct *vma) {
+    if (atomic_dec_and_test(&ring_mappings)) {
+        ring_wake(EPOLLIN | EPOLLRDNORM);
+    }
+}
+
+static const struct vm_operations_struct chardev_vm_ops = {
+    .open = chardev_vm_open,
+    .close = chardev_vm_close,
+};
+
+/**
+ * @brief Device mmap function
+ * 
+ * Maps the header page and data pages. The mapping must be shared so the
+ * consumer's tail updates reach the driver.
+ */
+static int chardev_mmap(struct file *file, struct vm_area_struct *vma) {
+    unsigned long size = vma->vm_end - vma->vm_start;
+    int ret;
     
-    to_write = min(count, (size_t)BUFFER_SIZE);
+    if (vma->vm_pgoff != 0 || size > RING_MMAP_SIZE) {
+        return -EINVAL;
+    }
+    if (!(vma->vm_flags & VM_SHARED)) {
+        return -EINVAL;
+    }
     
-    if (copy_from_user(device_buffer, user_buffer, to_write)) {
-        return -EFAULT;
+    ret = remap_vmalloc_range(vma, ring_area, 0);
+    if (ret < 0) {
+        return ret;
     }
     
-    buffer_size = to_write;
-    pr_info("chardev: Wrote %zu bytes\n", to_write);
+    // vm_ops->open is not called for the initial mapping
+    vma->vm_ops = &chardev_vm_ops;
+    chardev_vm_open(vma);
+    dev_dbg(chardev_device, "ring mapped by %s (%d)\n", current->comm, task_pid_nr(current));
     
-    return to_write;
+    return 0;
 }
 
+/**
+ * @brief sysfs stats attribute: per-CPU counters summed at read time
+ * 
+ * Counters are read without stopping writers, so the totals are a
+ * snapshot, not an atomic cut across CPUs.
+ */
+static ssize_t stats_show(struct device *dev, struct device_attribute *attr, char *buf) {
+    struct chardev_stats total = { 0 };
+    int cpu;
+    
+    for_each_possible_cpu(cpu) {
+        const struct chardev_stats *s = per_cpu_ptr(&chardev_stats, cpu);
+        
+        total.reads += READ_ONCE(s->reads);
+        total.read_bytes += READ_ONCE(s->read_bytes);
+        total.writes += READ_ONCE(s->writes);
+        total.write_bytes += READ_ONCE(s->write_bytes);
+        total.full += READ_ONCE(s->full);
+    }
+    
+    return sysfs_emit(buf, "reads %llu\nread_bytes %llu\nwrites %llu\n"
+                      "write_bytes %llu\nfull %llu\nused %u\nmapped %d\n",
+                      total.reads, total.read_bytes, total.writes,
+                      total.write_bytes, total.full, ring_used(),
+                      atomic_read(&ring_mappings));
+}
+static DEVICE_ATTR_RO(stats);
+
+static struct attribute *chardev_attrs[] = {
+    &dev_attr_stats.attr,
+    NULL,
+};
+ATTRIBUTE_GROUPS(chardev);
+
 // File operations structure
 static struct file_operations fops = {
     .owner = THIS_MODULE,
@@ -111,6 +382,8 @@ static struct file_operations fops = {
     .release = chardev_release,
     .read = chardev_read,
     .write = chardev_write,
+    .poll = chardev_poll,
+    .mmap = chardev_mmap,
 };
 
 /**
@@ -122,12 +395,21 @@ static int __init chardev_init(void) {
     
     pr_info("chardev: Initializing module\n");
     
-    // Allocate device buffer
-    device_buffer = kmalloc(BUFFER_SIZE, GFP_KERNEL);
-    if (!device_buffer) {
-        pr_err("chardev: Failed to allocate buffer\n");
+    BUILD_BUG_ON(RING_SIZE & RING_MASK);
+    BUILD_BUG_ON(RING_SIZE % PAGE_SIZE);
+    BUILD_BUG_ON(sizeof(struct chardev_ring_header) > PAGE_SIZE);
+    
+    // Allocate the ring; vmalloc_user() zeroes it and allows mmap
+    ring_area = vmalloc_user(RING_MMAP_SIZE);
+    if (!ring_area) {
+        pr_err("chardev: Failed to allocate ring\n");
         return -ENOMEM;
     }
+    ring_hdr = ring_area;
+    ring_data = (u8 *)ring_area + PAGE_SIZE;
+    ring_hdr->magic = CHARDEV_RING_MAGIC;
+    ring_hdr->data_offset = PAGE_SIZE;
+    ring_hdr->data_size = RING_SIZE;
     
     // Allocate device number
     ret = alloc_chrdev_region(&dev, 0, 1, DEVICE_NAME);
@@ -156,8 +438,9 @@ static int __init chardev_init(void) {
         goto fail_class;
     }
     
-    // Create device
-    chardev_device = device_create(chardev_class, NULL, dev, NULL, DEVICE_NAME "0");
+    // Create device with its sysfs attributes
+    chardev_device = device_create_with_groups(chardev_class, NULL, dev, NULL,
+                                               chardev_groups, DEVICE_NAME "0");
     if (IS_ERR(chardev_device)) {
         pr_err("chardev: Failed to create device\n");
         ret = PTR_ERR(chardev_device);
@@ -174,7 +457,7 @@ fail_class:
 fail_cdev:
     unregister_chrdev_region(dev, 1);
 fail_alloc:
-    kfree(device_buffer);
+    vfree(ring_area);
     return ret;
 }
 
@@ -188,7 +471,7 @@ static void __exit chardev_exit(void) {
     class_destroy(chardev_class);
     cdev_del(&chardev_cdev);
     unregister_chrdev_region(dev, 1);
-    kfree(device_buffer);
+    vfree(ring_area);
     
     pr_info("chardev: Module unloaded\n");
 }
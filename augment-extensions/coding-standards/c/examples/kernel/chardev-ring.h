@@ -0,0 +1,57 @@
+/**
+ * @file chardev-ring.h
+ * @brief Shared-memory ring layout exported by char-device.c via mmap
+ *
+ * Included by the driver and by userspace consumers. The mapping is one
+ * header page followed by CHARDEV_RING_DATA_SIZE bytes of data:
+ *
+ *   offset 0            struct chardev_ring_header
+ *   offset data_offset  data[data_size]
+ *
+ * head and tail are free-running byte counters; the fill level is
+ * head - tail and a position in data[] is (index & (data_size - 1)).
+ * The driver is the only producer and advances head. The consumer
+ * advances tail, either through read() or directly in the mapping.
+ *
+ * Userspace consumer:
+ *   size_t len = sysconf(_SC_PAGESIZE) + CHARDEV_RING_DATA_SIZE;
+ *   void *map = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+ *   struct chardev_ring_header *hdr = map;
+ *   const uint8_t *data = (const uint8_t *)map + hdr->data_offset;
+ *
+ *   for (;;) {
+ *       uint32_t head = __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE);
+ *       uint32_t tail = hdr->tail;
+ *       if (head == tail) {
+ *           poll(&(struct pollfd){ .fd = fd, .events = POLLIN }, 1, -1);
+ *           continue;
+ *       }
+ *       consume(data, tail & (hdr->data_size - 1), head - tail);
+ *       __atomic_store_n(&hdr->tail, head, __ATOMIC_RELEASE);
+ *   }
+ */
+
+#ifndef CHARDEV_RING_H
+#define CHARDEV_RING_H
+
+#include <linux/types.h>
+
+#define CHARDEV_RING_MAGIC      0x43524e47  /* "CRNG" */
+
+/** Data area size; a power of two and a multiple of any page size */
+#define CHARDEV_RING_DATA_SIZE  (64 * 1024)
+
+/** Keeps producer and consumer indices on separate cache lines */
+#define CHARDEV_RING_ALIGN      __attribute__((aligned(64)))
+
+struct chardev_ring_header {
+    __u32 magic;
+    __u32 data_offset;      /* Offset of data[] from the start of the mapping */
+    __u32 data_size;        /* Bytes in data[] */
+    __u32 reserved;
+
+    __u32 head CHARDEV_RING_ALIGN;     /* Written by the driver only */
+    __u32 tail CHARDEV_RING_ALIGN;     /* Written by the consumer only */
+};
+
+#endif /* CHARDEV_RING_H */
@@ -0,0 +1,75 @@
+/**
+ * @file chardev_trace.h
+ * @brief Tracepoints for the char-device.c data path
+ *
+ * Disabled tracepoints cost a patched-out branch, so they can stay on
+ * the read/write path where logging would flood dmesg. Enable with:
+ *   echo 1 > /sys/kernel/tracing/events/chardev/enable
+ *   cat /sys/kernel/tracing/trace_pipe
+ */
+
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM chardev
+
+#if !defined(_CHARDEV_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _CHARDEV_TRACE_H
+
+#include <linux/tracepoint.h>
+
+DECLARE_EVENT_CLASS(chardev_xfer,
+    TP_PROTO(size_t len, u32 head, u32 tail),
+    TP_ARGS(len, head, tail),
+
+    TP_STRUCT__entry(
+        __field(size_t, len)
+        __field(u32, head)
+        __field(u32, tail)
+    ),
+
+    TP_fast_assign(
+        __entry->len = len;
+        __entry->head = head;
+        __entry->tail = tail;
+    ),
+
+    TP_printk("len=%zu head=%u tail=%u used=%u",
+              __entry->len, __entry->head, __entry->tail,
+              __entry->head - __entry->tail)
+);
+
+/* Bytes appended by write(); head is the new head */
+DEFINE_EVENT(chardev_xfer, chardev_write,
+    TP_PROTO(size_t len, u32 head, u32 tail),
+    TP_ARGS(len, head, tail)
+);
+
+/* Bytes consumed by read(); tail is the new tail */
+DEFINE_EVENT(chardev_xfer, chardev_read,
+    TP_PROTO(size_t len, u32 head, u32 tail),
+    TP_ARGS(len, head, tail)
+);
+
+/* write() found no space; the consumer is falling behind */
+TRACE_EVENT(chardev_full,
+    TP_PROTO(size_t len),
+    TP_ARGS(len),
+
+    TP_STRUCT__entry(
+        __field(size_t, len)
+    ),
+
+    TP_fast_assign(
+        __entry->len = len;
+    ),
+
+    TP_printk("len=%zu", __entry->len)
+);
+
+#endif /* _CHARDEV_TRACE_H */
+
+/* Must be outside the include guard */
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE chardev_trace
+#include <trace/define_trace.h>
@@ -7,11 +7,16 @@
  * - Read/write operations in /proc
  * - Kernel-user space data transfer
  * - Sequence file interface
+ * - Statistics endpoint: per-CPU counters summed at read time
+ * - seq_operations iterator that streams a table one row at a time
+ * - Binary fixed-record format for collectors (layout in proc-stats.h)
  * 
  * Build: make
  * Load: sudo insmod proc-file.ko
  * Test: cat /proc/example_proc
  *       echo "value" > /proc/example_proc
+ *       cat /proc/example_stats
+ *       od -A d -t x4 /proc/example_stats_bin
  * Unload: sudo rmmod proc-file
  */
 
@@ -21,8 +26,15 @@
 #include <linux/seq_file.h>
 #include <linux/uaccess.h>
 #include <linux/slab.h>
+#include <linux/mutex.h>
+#include <linux/percpu.h>
+#include <linux/ktime.h>
+
+#include "proc-stats.h"
 
 #define PROC_NAME "example_proc"
+#define PROC_STATS_NAME "example_stats"
+#define PROC_STATS_BIN_NAME "example_stats_bin"
 #define BUFFER_SIZE 256
 
 MODULE_LICENSE("GPL");
@@ -31,19 +43,73 @@ MODULE_DESCRIPTION("Example /proc file interface");
 MODULE_VERSION("1.0");
 
 static struct proc_dir_entry *proc_entry = NULL;
+static struct proc_dir_entry *stats_entry = NULL;
+static struct proc_dir_entry *stats_bin_entry = NULL;
+
+// Stored data; proc_lock serializes writers against each other and show
+static DEFINE_MUTEX(proc_lock);
 static char *proc_buffer = NULL;
 static size_t proc_buffer_size = 0;
 
+/**
+ * @brief Counter IDs; add an entry here and in proc_stat_names[]
+ */
+enum proc_stat_id {
+    PROC_STAT_DATA_READS,
+    PROC_STAT_DATA_WRITES,
+    PROC_STAT_DATA_BYTES,
+    PROC_STAT_DATA_TRUNCATED,
+    PROC_STAT_SCRAPES,
+    PROC_STAT_COUNT
+};
+
+static const char * const proc_stat_names[PROC_STAT_COUNT] = {
+    [PROC_STAT_DATA_READS] = "data_reads",
+    [PROC_STAT_DATA_WRITES] = "data_writes",
+    [PROC_STAT_DATA_BYTES] = "data_bytes",
+    [PROC_STAT_DATA_TRUNCATED] = "data_truncated",
+    [PROC_STAT_SCRAPES] = "scrapes",
+};
+
+// Each CPU increments its own copy without locks or shared cache lines
+static DEFINE_PER_CPU(u64 [PROC_STAT_COUNT], proc_stats);
+
+/**
+ * @brief Add to a counter on the current CPU
+ */
+static inline void proc_stat_add(enum proc_stat_id id, u64 n) {
+    this_cpu_add(proc_stats[id], n);
+}
+
+/**
+ * @brief Sum a counter over all CPUs
+ * 
+ * Runs only when the stats are read. Writers are not stopped, so the
+ * result is a snapshot rather than an atomic cut across CPUs.
+ */
+static u64 proc_stat_sum(enum proc_stat_id id) {
+    u64 sum = 0;
+    int cpu;
+    
+    for_each_possible_cpu(cpu) {
+        sum += READ_ONCE(per_cpu(proc_stats, cpu)[id]);
+    }
+    
+    return sum;
+}
+
 /**
  * @brief Show function for seq_file
  */
 static int proc_show(struct seq_file *m, void *v) {
+    mutex_lock(&proc_lock);
     if (proc_buffer_size > 0) {
         seq_printf(m, "Stored data: %s\n", proc_buffer);
         seq_printf(m, "Buffer size: %zu bytes\n", proc_buffer_size);
     } else {
         seq_printf(m, "No data stored\n");
     }
+    mutex_unlock(&proc_lock);
     
     seq_printf(m, "Module loaded at: %s %s\n", __DATE__, __TIME__);
     return 0;
@@ -53,6 +119,7 @@ static int proc_show(struct seq_file *m, void *v) {
  * @brief Open function for proc file
  */
 static int proc_open(struct inode *inode, struct file *file) {
+    proc_stat_add(PROC_STAT_DATA_READS, 1);
     return single_open(file, proc_show, NULL);
 }
 
@@ -61,23 +128,30 @@ static int proc_open(struct inode *inode, struct file *file) {
  */
 static ssize_t proc_write(struct file *file, const char __user *user_buffer,
                           size_t count, loff_t *offset) {
+    char data[BUFFER_SIZE];
     size_t to_copy;
     
     if (count > BUFFER_SIZE - 1) {
-        pr_warn("proc_file: Input too large, truncating\n");
+        pr_warn_ratelimited("proc_file: Input too large, truncating\n");
+        proc_stat_add(PROC_STAT_DATA_TRUNCATED, 1);
         to_copy = BUFFER_SIZE - 1;
     } else {
         to_copy = count;
     }
     
-    if (copy_from_user(proc_buffer, user_buffer, to_copy)) {
+    // Copy outside the lock so a faulting user page cannot stall readers
+    if (copy_from_user(data, user_buffer, to_copy)) {
         return -EFAULT;
     }
+    data[to_copy] = '\0';  // Null-terminate
     
-    proc_buffer[to_copy] = '\0';  // Null-terminate
+    mutex_lock(&proc_lock);
+    memcpy(proc_buffer, data, to_copy + 1);
     proc_buffer_size = to_copy;
+    mutex_unlock(&proc_lock);
     
-    pr_info("proc_file: Received %zu bytes\n", to_copy);
+    proc_stat_add(PROC_STAT_DATA_WRITES, 1);
+    proc_stat_add(PROC_STAT_DATA_BYTES, to_copy);
     return to_copy;
 }
 
@@ -90,6 +164,105 @@ static const struct proc_ops proc_fops = {
     .proc_release = single_release,
 };
 
+/**
+ * @brief Iterator start: position 0 is the header, then one counter per row
+ * 
+ * seq_file calls start/show/next/stop once per page of output, so a
+ * table of any length is streamed a page at a time, never built whole.
+ */
+static void *stats_seq_start(struct seq_file *m, loff_t *pos) {
+    if (*pos == 0) {
+        proc_stat_add(PROC_STAT_SCRAPES, 1);
+        return SEQ_START_TOKEN;
+    }
+    if (*pos > PROC_STAT_COUNT) {
+        return NULL;
+    }
+    return (void *)&proc_stat_names[*pos - 1];
+}
+
+/**
+ * @brief Iterator next: advance to the following counter
+ */
+static void *stats_seq_next(struct seq_file *m, void *v, loff_t *pos) {
+    ++*pos;
+    return stats_seq_start(m, pos);
+}
+
+/**
+ * @brief Iterator stop: nothing is held between calls
+ */
+static void stats_seq_stop(struct seq_file *m, void *v) {
+}
+
+/**
+ * @brief Counter ID for an iterator element
+ */
+static enum proc_stat_id stats_seq_id(void *v) {
+    return (const char * const *)v - proc_stat_names;
+}
+
+/**
+ * @brief Text row: "name value"
+ */
+static int stats_seq_show(struct seq_file *m, void *v) {
+    enum proc_stat_id id;
+    
+    if (v == SEQ_START_TOKEN) {
+        seq_puts(m, "counter value\n");
+        return 0;
+    }
+    
+    id = stats_seq_id(v);
+    seq_printf(m, "%s %llu\n", proc_stat_names[id], proc_stat_sum(id));
+    return 0;
+}
+
+/**
+ * @brief Binary record: struct proc_stats_header, then one
+ *        struct proc_stats_record per counter
+ */
+static int stats_bin_seq_show(struct seq_file *m, void *v) {
+    struct proc_stats_record rec;
+    enum proc_stat_id id;
+    
+    if (v == SEQ_START_TOKEN) {
+        struct proc_stats_header hdr = {
+            .version = PROC_STATS_VERSION,
+            .record_size = sizeof(struct proc_stats_record),
+            .count = PROC_STAT_COUNT,
+            .monotonic_ns = ktime_get_ns(),
+        };
+        
+        memcpy(hdr.magic, PROC_STATS_MAGIC, sizeof(hdr.magic));
+        seq_write(m, &hdr, sizeof(hdr));
+        return 0;
+    }
+    
+    id = stats_seq_id(v);
+    memset(&rec, 0, sizeof(rec));
+    rec.id = id;
+    rec.value = proc_stat_sum(id);
+    strscpy(rec.name, proc_stat_names[id], sizeof(rec.name));
+    
+    seq_write(m, &rec, sizeof(rec));
+    return 0;
+}
+
+static const struct seq_operations stats_seq_ops = {
+    .start = stats_seq_start,
+    .next = stats_seq_next,
+    .stop = stats_seq_stop,
+    .show = stats_seq_show,
+};
+
+static const struct seq_operations stats_bin_seq_ops = {
+    .start = stats_seq_start,
+    .next = stats_seq_next,
+    .stop = stats_seq_stop,
+    .show = stats_bin_seq_show,
+};
+
 /**
  * @brief Module initialization
  */
@@ -113,6 +286,18 @@ static int __init proc_file_init(void) {
         return -ENOMEM;
     }
     
+    // Create read-only stats entries
+    stats_entry = proc_create_seq(PROC_STATS_NAME, 0444, NULL, &stats_seq_ops);
+    stats_bin_entry = proc_create_seq(PROC_STATS_BIN_NAME, 0444, NULL, &stats_bin_seq_ops);
+    if (!stats_entry || !stats_bin_entry) {
+        pr_err("proc_file: Failed to create stats entries\n");
+        proc_remove(stats_bin_entry);
+        proc_remove(stats_entry);
+        proc_remove(proc_entry);
+        kfree(proc_buffer);
+        return -ENOMEM;
+    }
+    
     pr_info("proc_file: Created /proc/%s\n", PROC_NAME);
     return 0;
 }
@@ -121,6 +306,8 @@ static int __init proc_file_init(void) {
  * @brief Module cleanup
  */
 static void __exit proc_file_exit(void) {
+    proc_remove(stats_bin_entry);
+    proc_remove(stats_entry);
     proc_remove(proc_entry);
     kfree(proc_buffer);
     pr_info("proc_file: Module unloaded\n");
@@ -0,0 +1,48 @@
+/**
+ * @file proc-stats.h
+ * @brief Binary record format of /proc/example_stats_bin (proc-file.c)
+ *
+ * Included by the module and by collectors. A read returns one header
+ * followed by header.count records, in native byte order and of fixed
+ * size, so a collector can read() them into an array without parsing
+ * text:
+ *
+ *   struct proc_stats_header hdr;
+ *   struct proc_stats_record rec[64];
+ *   read(fd, &hdr, sizeof(hdr));
+ *   if (memcmp(hdr.magic, PROC_STATS_MAGIC, sizeof(hdr.magic)) != 0) ...
+ *   read(fd, rec, hdr.count * hdr.record_size);
+ *
+ * The magic is four bytes, not a number, so it reads "PSTB" in a hexdump
+ * whatever the byte order of the rest of the data.
+ *
+ * Counters are monotonically increasing; rates come from the difference
+ * between two scrapes and their monotonic_ns timestamps.
+ */
+
+#ifndef PROC_STATS_H
+#define PROC_STATS_H
+
+#include <linux/types.h>
+
+#define PROC_STATS_MAGIC        "PSTB"      /* Compare sizeof(magic) bytes; no NUL */
+#define PROC_STATS_VERSION      1
+#define PROC_STATS_NAME_LEN     24
+
+struct proc_stats_header {
+    char magic[4];              /* PROC_STATS_MAGIC */
+    __u16 version;
+    __u16 record_size;          /* sizeof(struct proc_stats_record) */
+    __u32 count;                /* Records that follow */
+    __u32 reserved;
+    __u64 monotonic_ns;         /* CLOCK_MONOTONIC time of the scrape */
+};
+
+struct proc_stats_record {
+    __u32 id;
+    __u32 reserved;
+    __u64 value;                /* Sum over all CPUs */
+    char name[PROC_STATS_NAME_LEN];     /* NUL-padded */
+};
+
+#endif /* PROC_STATS_H */
@@ -6,12 +6,14 @@
  * - Module initialization and cleanup
  * - Module parameters
  * - Kernel logging (printk)
+ * - Log sites gated by static keys: a NOP when disabled, flipped at runtime
  * - Module metadata
  * - Error handling in init
  * 
  * Build: make
  * Load: sudo insmod simple-module.ko
  * Load with param: sudo insmod simple-module.ko debug_level=2
+ * Change at runtime: echo 1 | sudo tee /sys/module/simple_module/parameters/debug_level
  * Check logs: dmesg | tail
  * Unload: sudo rmmod simple-module
  */
@@ -20,15 +22,87 @@
 #include <linux/kernel.h>
 #include <linux/init.h>
 #include <linux/slab.h>
+#include <linux/moduleparam.h>
+#include <linux/jump_label.h>
 
 MODULE_LICENSE("GPL");
 MODULE_AUTHOR("Example Author <author@example.com>");
 MODULE_DESCRIPTION("Simple example kernel module");
 MODULE_VERSION("1.0");
 
+/*
+ * Static keys for the info and verbose log sites. While a key is false
+ * its sites compile to a NOP that jumps over the printk; enabling it
+ * patches the NOP into a jump. Disabled instrumentation therefore costs
+ * neither a load of debug_level nor a call.
+ */
+static DEFINE_STATIC_KEY_FALSE(log_info_enabled);
+static DEFINE_STATIC_KEY_FALSE(log_verbose_enabled);
+
+#define log_info(fmt, ...)                                              \
+    do {                                                                \
+        if (static_branch_unlikely(&log_info_enabled))                  \
+            pr_info("simple_module: INFO: " fmt "\n", ##__VA_ARGS__);   \
+    } while (0)
+
+#define log_verbose(fmt, ...)                                           \
+    do {                                                                \
+        if (static_branch_unlikely(&log_verbose_enabled))               \
+            printk(KERN_DEBUG "simple_module: DEBUG: " fmt "\n", ##__VA_ARGS__); \
+    } while (0)
+
 // Module parameters
 static int debug_level = 0;
-module_param(debug_level, int, 0644);
+
+/**
+ * @brief Point the static keys at a debug level
+ * 
+ * static_branch_enable/disable() patch code and may sleep; they are only
+ * called from process context (parameter writes and init).
+ */
+static void debug_level_apply(int level) {
+    if (level >= 1) {
+        static_branch_enable(&log_info_enabled);
+    } else {
+        static_branch_disable(&log_info_enabled);
+    }
+    
+    if (level >= 2) {
+        static_branch_enable(&log_verbose_enabled);
+    } else {
+        static_branch_disable(&log_verbose_enabled);
+    }
+}
+
+/**
+ * @brief Setter for debug_level (insmod argument or sysfs write)
+ * 
+ * The module parameter lock serializes concurrent writers, so the keys
+ * always match the stored level.
+ */
+static int debug_level_set(const char *val, const struct kernel_param *kp) {
+    int level;
+    int ret;
+    
+    ret = kstrtoint(val, 0, &level);
+    if (ret) {
+        return ret;
+    }
+    if (level < 0 || level > 2) {
+        return -EINVAL;
+    }
+    
+    *(int *)kp->arg = level;
+    debug_level_apply(level);
+    return 0;
+}
+
+static const struct kernel_param_ops debug_level_ops = {
+    .set = debug_level_set,
+    .get = param_get_int,
+};
+
+module_param_cb(debug_level, &debug_level_ops, &debug_level, 0644);
 MODULE_PARM_DESC(debug_level, "Debug level (0=off, 1=info, 2=verbose)");
 
 static char *message = "Hello";
@@ -38,34 +112,20 @@ MODULE_PARM_DESC(message, "Custom message to display");
 // Module data
 static void *module_data = NULL;
 
-/**
- * @brief Helper function to demonstrate kernel logging
- */
-static void log_message(int level, const char *msg) {
-    switch (level) {
-        case 0:
-            pr_err("simple_module: ERROR: %s\n", msg);
-            break;
-        case 1:
-            pr_info("simple_module: INFO: %s\n", msg);
-            break;
-        case 2:
-            pr_debug("simple_module: DEBUG: %s\n", msg);
-            break;
-        default:
-            pr_warn("simple_module: WARN: %s\n", msg);
-    }
-}
-
 /**
  * @brief Module initialization function
  * @return 0 on success, negative error code on failure
  */
 static int __init simple_module_init(void) {
+    int i;
+    
     pr_info("simple_module: Initializing module\n");
     pr_info("simple_module: Debug level: %d\n", debug_level);
     pr_info("simple_module: Message: %s\n", message);
     
+    // Parameters are parsed before init; make sure the keys agree
+    debug_level_apply(debug_level);
+    
     // Allocate some memory (example)
     module_data = kmalloc(1024, GFP_KERNEL);
     if (!module_data) {
@@ -73,13 +133,11 @@ static int __init simple_module_init(void) {
         return -ENOMEM;
     }
     
-    if (debug_level >= 1) {
-        log_message(1, "Module data allocated successfully");
-    }
+    log_info("Module data allocated successfully");
     
-    // Simulate initialization work
-    if (debug_level >= 2) {
-        log_message(2, "Performing detailed initialization");
+    // Simulate initialization work; disabled log sites here cost a NOP
+    for (i = 0; i < 4; i++) {
+        log_verbose("Performing initialization step %d", i);
     }
     
     pr_info("simple_module: Module loaded successfully\n");
@@ -97,9 +155,7 @@ static void __exit simple_module_exit(void) {
         kfree(module_data);
         module_data = NULL;
         
-        if (debug_level >= 1) {
-            log_message(1, "Module data freed");
-        }
+        log_info("Module data freed");
     }
     
     pr_info("simple_module: Module unloaded\n");
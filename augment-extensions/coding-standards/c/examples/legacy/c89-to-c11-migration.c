@@ -5,13 +5,16 @@
  * This file shows before/after examples of migrating legacy C89 code
  * to modern C11 standards while maintaining compatibility.
  * 
- * Compile C89: gcc -std=c89 -DUSE_C89 -o legacy c89-to-c11-migration.c
- * Compile C11: gcc -std=c11 -o modern c89-to-c11-migration.c
+ * Compile C89: gcc -std=c89 -DUSE_C89 -o legacy c89-to-c11-migration.c compat-alloc.c
+ * Compile C11: gcc -std=c11 -o modern c89-to-c11-migration.c compat-alloc.c
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+
+#include "compat-alloc.h"
 
 #ifdef USE_C89
 /* C89 version */
@@ -166,6 +169,139 @@ Buffer_C11* create_buffer_c11(size_t size) {
 }
 #endif
 
+/*
+ * One malloc() per buffer is slow and fragments the heap of a long-running
+ * process. The same buffers, from compat-alloc.h: an arena freed in one go
+ * per request, or a size-class pool. The code below is shared by both
+ * standards; COMPAT_FLEX_SIZE() sizes either declaration correctly.
+ */
+#ifdef USE_C89
+typedef Buffer_C89 Buffer;
+#define create_buffer_malloc create_buffer_c89
+#else
+typedef Buffer_C11 Buffer;
+#define create_buffer_malloc create_buffer_c11
+#endif
+
+#define BUFFER_BYTES(size) COMPAT_FLEX_SIZE(Buffer, data, size)
+
+Buffer* create_buffer_arena(compat_arena_t *arena, size_t size) {
+    Buffer *buf = COMPAT_ARENA_ALLOC(arena, BUFFER_BYTES(size));
+    if (buf) {
+        buf->length = size;
+    }
+    return buf;
+}
+
+Buffer* create_buffer_pool(compat_pool_t *pool, size_t size) {
+    Buffer *buf = COMPAT_POOL_ALLOC(pool, BUFFER_BYTES(size));
+    if (buf) {
+        buf->length = size;
+    }
+    return buf;
+}
+
+void destroy_buffer_pool(compat_pool_t *pool, Buffer *buf) {
+    if (buf) {
+        COMPAT_POOL_FREE(pool, buf, BUFFER_BYTES(buf->length));
+    }
+}
+
+#define REQUESTS 20000
+#define BUFFERS_PER_REQUEST 16
+
+/* Message sizes from a fixed LCG, so every strategy sees the same ones */
+static size_t next_message_size(unsigned long *seed) {
+    *seed = *seed * 1103515245UL + 12345UL;
+    return 16 + (size_t)((*seed >> 16) % 1485);
+}
+
+/**
+ * @brief Handle REQUESTS requests of BUFFERS_PER_REQUEST buffers each
+ * @param strategy 0 = malloc/free, 1 = pool, 2 = arena reset per request
+ * @return Checksum of the bytes written, or 0 if an allocation failed
+ */
+static unsigned long run_requests(int strategy, compat_pool_t *pool, compat_arena_t *arena) {
+    Buffer *bufs[BUFFERS_PER_REQUEST];
+    unsigned long seed = 1;
+    unsigned long checksum = 0;
+    long r;
+    int i;
+    
+    for (r = 0; r < REQUESTS; r++) {
+        for (i = 0; i < BUFFERS_PER_REQUEST; i++) {
+            size_t size = next_message_size(&seed);
+            
+            if (strategy == 0) {
+                bufs[i] = create_buffer_malloc(size);
+            } else if (strategy == 1) {
+                bufs[i] = create_buffer_pool(pool, size);
+            } else {
+                bufs[i] = create_buffer_arena(arena, size);
+            }
+            if (bufs[i] == NULL) {
+                return 0;
+            }
+            bufs[i]->data[0] = (char)r;
+            bufs[i]->data[size - 1] = (char)i;
+            checksum += (unsigned char)bufs[i]->data[0] + (unsigned char)bufs[i]->data[size - 1];
+        }
+        
+        /* End of request: release its buffers */
+        if (strategy == 2) {
+            compat_arena_reset(arena);
+            continue;
+        }
+        for (i = 0; i < BUFFERS_PER_REQUEST; i++) {
+            if (strategy == 0) {
+                free(bufs[i]);
+            } else {
+                destroy_buffer_pool(pool, bufs[i]);
+            }
+        }
+    }
+    return checksum;
+}
+
+void example_flexible_arrays(void) {
+    static const char *const names[] = { "malloc/free", "size-class pool", "arena" };
+    compat_pool_t pool;
+    compat_arena_t arena;
+    Buffer *buf = create_buffer_malloc(32);
+    int strategy;
+    
+    if (buf == NULL) {
+        fprintf(stderr, "Error: allocation failed\n");
+        return;
+    }
+    strcpy(buf->data, "flexible array member");
+    printf("Buffer of %lu bytes: %s\n", (unsigned long)buf->length, buf->data);
+    free(buf);
+    
+    compat_pool_init(&pool);
+    if (compat_arena_init(&arena, 8 * 1024) < 0) {
+        return;
+    }
+    
+    printf("%d requests x %d buffers of 16-1500 bytes:\n", REQUESTS, BUFFERS_PER_REQUEST);
+    for (strategy = 0; strategy < 3; strategy++) {
+        clock_t start = clock();
+        unsigned long checksum = run_requests(strategy, &pool, &arena);
+        double ms = (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+        
+        if (checksum == 0) {
+            fprintf(stderr, "Error: allocation failed\n");
+            break;
+        }
+        printf("  %-16s %8.2f ms (checksum %lu)\n", names[strategy], ms, checksum);
+    }
+    printf("  Pool slabs: %lu, arena blocks: %lu (malloc calls in total)\n",
+           pool.slab_mallocs, arena.block_mallocs);
+    
+    compat_arena_destroy(&arena);
+    compat_pool_destroy(&pool);
+}
+
 /**
  * EXAMPLE 5: Inline Functions
  */
@@ -251,6 +387,10 @@ int main(void) {
     example_static_assertions();
     printf("\n");
     
+    printf("Example 4: Flexible Array Members\n");
+    example_flexible_arrays();
+    printf("\n");
+    
     printf("Example 5: Inline Functions\n");
     example_inline_functions();
     printf("\n");
@@ -0,0 +1,279 @@
+/**
+ * @file compat-alloc.c
+ * @brief Arena and size-class pool allocators (see compat-alloc.h)
+ * 
+ * Written in C89 so that the same file builds with every toolchain the
+ * legacy examples support.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "compat-alloc.h"
+
+#define POISON_ALLOC    0xCD
+#define POISON_FREE     0xDD
+
+/* Block header; the data that follows starts at ARENA_HEADER_SIZE */
+struct compat_arena_block {
+    struct compat_arena_block *next;
+    size_t size;
+};
+
+#define ARENA_HEADER_SIZE COMPAT_ALIGN_UP(sizeof(struct compat_arena_block), COMPAT_MAX_ALIGN)
+
+/* Largest block: header plus data plus an alignment round-up fit in size_t */
+#define ARENA_MAX_SIZE ((size_t)-1 - ARENA_HEADER_SIZE - COMPAT_MAX_ALIGN)
+
+/* Slab header; slots start at SLAB_HEADER_SIZE */
+struct compat_pool_slab {
+    struct compat_pool_slab *next;
+};
+
+#define SLAB_HEADER_SIZE COMPAT_ALIGN_UP(sizeof(struct compat_pool_slab), COMPAT_MAX_ALIGN)
+
+static void poison(void *ptr, int value, size_t size) {
+#ifdef COMPAT_ALLOC_DEBUG
+    memset(ptr, value, size);
+#else
+    (void)ptr;
+    (void)value;
+    (void)size;
+#endif
+}
+
+static unsigned char *block_data(struct compat_arena_block *block) {
+    return (unsigned char *)block + ARENA_HEADER_SIZE;
+}
+
+/**
+ * @brief Push a new block of at least size bytes onto the arena
+ * @return The block, or NULL if out of memory or size is too large
+ */
+static struct compat_arena_block *arena_grow(compat_arena_t *arena, size_t size) {
+    struct compat_arena_block *block;
+    
+    if (size < arena->block_size) {
+        size = arena->block_size;
+    }
+    /* ARENA_HEADER_SIZE + size would wrap to a tiny malloc() */
+    if (size > ARENA_MAX_SIZE) {
+        return NULL;
+    }
+    
+    /* malloc() memory is aligned for any type, so block_data() is too */
+    block = malloc(ARENA_HEADER_SIZE + size);
+    if (block == NULL) {
+        return NULL;
+    }
+    block->size = size;
+    block->next = arena->blocks;
+    arena->blocks = block;
+    arena->used = 0;
+    arena->block_mallocs++;
+    poison(block_data(block), POISON_FREE, size);
+    return block;
+}
+
+int compat_arena_init(compat_arena_t *arena, size_t block_size) {
+    if (block_size == 0) {
+        return -1;
+    }
+    arena->blocks = NULL;
+    arena->used = 0;
+    arena->block_size = block_size;
+    arena->block_mallocs = 0;
+    return 0;
+}
+
+void *compat_arena_alloc(compat_arena_t *arena, size_t size, size_t align) {
+    struct compat_arena_block *block = arena->blocks;
+    size_t offset;
+    void *ptr;
+    
+    if (align == 0 || (align & (align - 1)) != 0 || align > COMPAT_MAX_ALIGN) {
+        return NULL;
+    }
+    
+    /* Blocks start max-aligned, so aligning the offset aligns the pointer */
+    offset = COMPAT_ALIGN_UP(arena->used, align);
+    if (block == NULL || offset > block->size || size > block->size - offset) {
+        block = arena_grow(arena, size);
+        if (block == NULL) {
+            return NULL;
+        }
+        offset = 0;
+    }
+    
+    ptr = block_data(block) + offset;
+    arena->used = offset + size;
+    poison(ptr, POISON_ALLOC, size);
+    return ptr;
+}
+
+void compat_arena_reset(compat_arena_t *arena) {
+    struct compat_arena_block *block = arena->blocks;
+    size_t total = 0;
+    
+    if (block == NULL) {
+        return;
+    }
+    
+    if (block->next != NULL) {
+        /* Grew this round: replace the chain with one block that fits it */
+        while (block != NULL) {
+            struct compat_arena_block *next = block->next;
+            
+            total += block->size;
+            free(block);
+            block = next;
+        }
+        arena->blocks = NULL;
+        arena->block_size = total;
+        arena_grow(arena, total);     /* On failure the next alloc retries */
+        return;
+    }
+    
+    poison(block_data(block), POISON_FREE, arena->used);
+    arena->used = 0;
+}
+
+void compat_arena_destroy(compat_arena_t *arena) {
+    struct compat_arena_block *block = arena->blocks;
+    
+    while (block != NULL) {
+        struct compat_arena_block *next = block->next;
+        
+        free(block);
+        block = next;
+    }
+    arena->blocks = NULL;
+    arena->used = 0;
+}
+
+/**
+ * @brief Smallest class that holds size bytes
+ * @return Class index, or COMPAT_POOL_CLASSES if size is too large
+ */
+static int pool_class(size_t size) {
+    size_t class_size = COMPAT_POOL_MIN_CLASS;
+    int index = 0;
+    
+    while (index < COMPAT_POOL_CLASSES && class_size < size) {
+        class_size <<= 1;
+        index++;
+    }
+    return index;
+}
+
+static size_t pool_slot_size(int index) {
+    return COMPAT_ALIGN_UP((size_t)COMPAT_POOL_MIN_CLASS << index, COMPAT_MAX_ALIGN);
+}
+
+/**
+ * @brief Carve a new slab into free slots of one class
+ * @return 0 on success, -1 if out of memory
+ */
+static int pool_refill(compat_pool_t *pool, int index) {
+    size_t slot_size = pool_slot_size(index);
+    size_t count = (COMPAT_POOL_SLAB_SIZE - SLAB_HEADER_SIZE) / slot_size;
+    struct compat_pool_slab *slab;
+    unsigned char *slot;
+    size_t i;
+    
+    if (count == 0) {
+        count = 1;
+    }
+    slab = malloc(SLAB_HEADER_SIZE + count * slot_size);
+    if (slab == NULL) {
+        return -1;
+    }
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->slab_mallocs++;
+    
+    /* Push back to front so slots are handed out in address order */
+    slot = (unsigned char *)slab + SLAB_HEADER_SIZE + count * slot_size;
+    for (i = 0; i < count; i++) {
+        slot -= slot_size;
+        poison(slot, POISON_FREE, slot_size);
+        *(void **)slot = pool->free_lists[index];
+        pool->free_lists[index] = slot;
+    }
+    return 0;
+}
+
+void compat_pool_init(compat_pool_t *pool) {
+    int i;
+    
+    for (i = 0; i < COMPAT_POOL_CLASSES; i++) {
+        pool->free_lists[i] = NULL;
+    }
+    pool->slabs = NULL;
+    pool->slab_mallocs = 0;
+    pool->large_mallocs = 0;
+}
+
+void *compat_pool_alloc(compat_pool_t *pool, size_t size) {
+    int index = pool_class(size);
+    void *slot;
+    
+    if (index == COMPAT_POOL_CLASSES) {
+        pool->large_mallocs++;
+        return malloc(size);
+    }
+    
+    if (pool->free_lists[index] == NULL && pool_refill(pool, index) < 0) {
+        return NULL;
+    }
+    slot = pool->free_lists[index];
+    pool->free_lists[index] = *(void **)slot;
+
+#ifdef COMPAT_ALLOC_DEBUG
+    {
+        /* Everything after the free-list link must still be poison */
+        const unsigned char *bytes = slot;
+        size_t slot_size = pool_slot_size(index);
+        size_t i;
+        
+        for (i = sizeof(void *); i < slot_size; i++) {
+            if (bytes[i] != POISON_FREE) {
+                fprintf(stderr, "compat_pool: slot %p written after free (offset %lu)\n",
+                        slot, (unsigned long)i);
+                abort();
+            }
+        }
+    }
+#endif
+    poison(slot, POISON_ALLOC, size);
+    return slot;
+}
+
+void compat_pool_free(compat_pool_t *pool, void *ptr, size_t size) {
+    int index = pool_class(size);
+    
+    if (ptr == NULL) {
+        return;
+    }
+    if (index == COMPAT_POOL_CLASSES) {
+        free(ptr);
+        return;
+    }
+    
+    poison(ptr, POISON_FREE, pool_slot_size(index));
+    *(void **)ptr = pool->free_lists[index];
+    pool->free_lists[index] = ptr;
+}
+
+void compat_pool_destroy(compat_pool_t *pool) {
+    struct compat_pool_slab *slab = pool->slabs;
+    
+    while (slab != NULL) {
+        struct compat_pool_slab *next = slab->next;
+        
+        free(slab);
+        slab = next;
+    }
+    compat_pool_init(pool);
+}
@@ -0,0 +1,159 @@
+/**
+ * @file compat-alloc.h
+ * @brief Arena and size-class pool allocators for C89 through C11
+ * 
+ * Two replacements for one malloc() per object:
+ * - Arena: bump allocation from large blocks, freed all at once with
+ *   compat_arena_reset(), e.g. at the end of every request
+ * - Pool: fixed size classes with a free list each; alloc and free are a
+ *   pointer pop and push, and freed slots are reused instead of
+ *   fragmenting the heap
+ * 
+ * Every pointer returned is aligned to COMPAT_MAX_ALIGN (or to the
+ * requested alignment), so any object, including a struct with a flexible
+ * array member, can live there. The code is plain C89; only the alignment
+ * query uses _Alignof when the compiler has it.
+ * 
+ * Build with -DCOMPAT_ALLOC_DEBUG to poison memory: fresh allocations are
+ * filled with 0xCD, released memory with 0xDD, and a pool slot written
+ * after it was freed aborts at its next allocation.
+ * 
+ * Usage:
+ *   compat_arena_t arena;
+ *   compat_arena_init(&arena, 64 * 1024);
+ *   msg = COMPAT_ARENA_NEW(&arena, Message);
+ *   buf = COMPAT_ARENA_ALLOC(&arena, COMPAT_FLEX_SIZE(Buffer, data, len));
+ *   compat_arena_reset(&arena);
+ * 
+ *   compat_pool_t pool;
+ *   compat_pool_init(&pool);
+ *   p = COMPAT_POOL_ALLOC(&pool, size);
+ *   COMPAT_POOL_FREE(&pool, p, size);
+ */
+
+#ifndef LEGACY_COMPAT_ALLOC_H
+#define LEGACY_COMPAT_ALLOC_H
+
+#include <stddef.h>
+
+/* ---- Alignment ---- */
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+    #define COMPAT_ALIGNOF(type) _Alignof(type)
+    #define COMPAT_MAX_ALIGN _Alignof(max_align_t)
+#else
+    /* Every fundamental type C89 has; its alignment is the strictest */
+    typedef union {
+        long l;
+        double d;
+        long double ld;
+        void *p;
+        void (*fp)(void);
+    } compat_max_align_t;
+
+    /* Padding after a char is the alignment of what follows it */
+    #define COMPAT_ALIGNOF(type) offsetof(struct { char c; type t; }, t)
+    #define COMPAT_MAX_ALIGN COMPAT_ALIGNOF(compat_max_align_t)
+#endif
+
+/* Round n up to a multiple of align (a power of two) */
+#define COMPAT_ALIGN_UP(n, align) (((n) + ((align) - 1)) & ~((size_t)(align) - 1))
+
+/*
+ * Bytes for a struct whose last member is a flexible array (C99) or the
+ * C89 data[1] hack, holding count elements. Counts from the member's
+ * offset, so the same expression is right for both declarations.
+ */
+#define COMPAT_FLEX_SIZE(type, member, count) \
+    (offsetof(type, member) + (count) * sizeof(((type *)0)->member[0]))
+
+/* ---- Arena ---- */
+
+struct compat_arena_block;
+
+typedef struct {
+    struct compat_arena_block *blocks;  /* Newest first */
+    size_t used;                        /* Bytes used in the newest block */
+    size_t block_size;                  /* Capacity of a regular block */
+    unsigned long block_mallocs;        /* malloc() calls so far */
+} compat_arena_t;
+
+/**
+ * @brief Prepare an arena; its first block is allocated on first use
+ * @param block_size Usable bytes per block
+ * @return 0 on success, -1 if block_size is 0
+ */
+int compat_arena_init(compat_arena_t *arena, size_t block_size);
+
+/**
+ * @brief Allocate from the arena
+ * @param align Power of two, at most COMPAT_MAX_ALIGN
+ * @return Memory valid until the next reset, or NULL on error
+ * 
+ * Requests larger than a block get a block of their own.
+ */
+void *compat_arena_alloc(compat_arena_t *arena, size_t size, size_t align);
+
+/**
+ * @brief Release everything allocated since the last reset
+ * 
+ * Keeps one block. If the arena had to grow, the blocks are merged into a
+ * single block big enough for all of them, so a workload that repeats
+ * stops calling malloc() after its first round.
+ */
+void compat_arena_reset(compat_arena_t *arena);
+
+/**
+ * @brief Free every block
+ */
+void compat_arena_destroy(compat_arena_t *arena);
+
+#define COMPAT_ARENA_NEW(arena, type) \
+    ((type *)compat_arena_alloc((arena), sizeof(type), COMPAT_ALIGNOF(type)))
+#define COMPAT_ARENA_ALLOC(arena, size) \
+    compat_arena_alloc((arena), (size), COMPAT_MAX_ALIGN)
+
+/* ---- Size-class pool ---- */
+
+#define COMPAT_POOL_MIN_CLASS   32      /* Smallest slot in bytes */
+#define COMPAT_POOL_CLASSES     7       /* 32, 64, ..., 2048 */
+#define COMPAT_POOL_MAX_SIZE    (COMPAT_POOL_MIN_CLASS << (COMPAT_POOL_CLASSES - 1))
+#define COMPAT_POOL_SLAB_SIZE   (16 * 1024)
+
+struct compat_pool_slab;
+
+typedef struct {
+    void *free_lists[COMPAT_POOL_CLASSES];
+    struct compat_pool_slab *slabs;
+    unsigned long slab_mallocs;         /* Slabs allocated so far */
+    unsigned long large_mallocs;        /* Requests above COMPAT_POOL_MAX_SIZE */
+} compat_pool_t;
+
+/**
+ * @brief Prepare an empty pool; slabs are allocated on demand
+ */
+void compat_pool_init(compat_pool_t *pool);
+
+/**
+ * @brief Allocate size bytes from the smallest class that fits
+ * @return Memory aligned to COMPAT_MAX_ALIGN, or NULL if out of memory
+ * 
+ * Sizes above COMPAT_POOL_MAX_SIZE fall through to malloc().
+ */
+void *compat_pool_alloc(compat_pool_t *pool, size_t size);
+
+/**
+ * @brief Return memory to its class
+ * @param size The size passed to compat_pool_alloc()
+ */
+void compat_pool_free(compat_pool_t *pool, void *ptr, size_t size);
+
+/**
+ * @brief Free every slab; outstanding pool memory becomes invalid
+ */
+void compat_pool_destroy(compat_pool_t *pool);
+
+#define COMPAT_POOL_ALLOC(pool, size) compat_pool_alloc((pool), (size))
+#define COMPAT_POOL_FREE(pool, ptr, size) compat_pool_free((pool), (ptr), (size))
+
+#endif /* LEGACY_COMPAT_ALLOC_H */
@@ -8,13 +8,22 @@
  * - Compiler-specific workarounds
  * - Feature detection
  * - Graceful degradation
+ * - Arena and pool allocators (compat-alloc.h) behind COMPAT_* macros
  * 
- * Compile: gcc -Wall -Wextra -std=c11 -o compat compatibility-layer.c
+ * Compile: gcc -Wall -Wextra -std=c11 -o compat compatibility-layer.c compat-alloc.c
  */
 
+/* usleep() is XSI; strict -std= modes hide it otherwise */
+#if !defined(_WIN32) && !defined(_XOPEN_SOURCE)
+    #define _XOPEN_SOURCE 500
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdarg.h>
+
+#include "compat-alloc.h"
 
 /**
  * SECTION 1: Compiler Detection
@@ -159,21 +168,16 @@
 #endif
 
 /**
- * SECTION 7: Safe String Functions
+ * SECTION 7: Safe String and Byte Functions
  */
 
-/* Safe string copy (compatible with all platforms) */
-static COMPAT_INLINE size_t compat_strlcpy(char *dst, const char *src, size_t size) {
-    size_t src_len = strlen(src);
-    
-    if (size > 0) {
-        size_t copy_len = (src_len >= size) ? size - 1 : src_len;
-        memcpy(dst, src, copy_len);
-        dst[copy_len] = '\0';
-    }
-    
-    return src_len;
-}
+/*
+ * compat_strlcpy()/compat_strnlen() (word at a time), compat_bswap*(),
+ * compat_load_be*()/compat_store_be*(), COMPAT_LIKELY/UNLIKELY and
+ * COMPAT_PREFETCH. Shared with the networking examples, so they live in a
+ * header; it picks up COMPAT_INLINE from SECTION 4.
+ */
+#include "../common/compat-fast.h"
 
 /**
  * SECTION 8: Example Usage
@@ -207,6 +211,52 @@ COMPAT_STATIC_ASSERT(sizeof(uint8_t) == 1, "uint8_t must be 1 byte");
 COMPAT_STATIC_ASSERT(sizeof(uint16_t) == 2, "uint16_t must be 2 bytes");
 COMPAT_STATIC_ASSERT(sizeof(uint32_t) == 4, "uint32_t must be 4 bytes");
 
+/**
+ * SECTION 10: Allocators
+ */
+
+/* Same layout as the migration example's buffers */
+typedef struct {
+    size_t length;
+    char data[1];
+} compat_message_t;
+
+static void compat_allocator_demo(void) {
+    compat_arena_t arena;
+    compat_pool_t pool;
+    compat_message_t *msg;
+    double *values;
+    void *block;
+    
+    if (compat_arena_init(&arena, 4096) < 0) {
+        return;
+    }
+    compat_pool_init(&pool);
+    
+    /* Arena: per-request scratch, released by one reset */
+    msg = COMPAT_ARENA_ALLOC(&arena, COMPAT_FLEX_SIZE(compat_message_t, data, 64));
+    values = COMPAT_ARENA_NEW(&arena, double);
+    if (msg != NULL && values != NULL) {
+        msg->length = 64;
+        compat_strlcpy(msg->data, "arena message", msg->length);
+        *values = 3.5;
+        printf("Arena: '%s', double aligned to %lu: %s\n", msg->data,
+               (unsigned long)COMPAT_ALIGNOF(double),
+               ((size_t)values % COMPAT_ALIGNOF(double)) == 0 ? "yes" : "no");
+    }
+    compat_arena_reset(&arena);
+    
+    /* Pool: freed slots are reused by the next request of the same class */
+    block = COMPAT_POOL_ALLOC(&pool, 100);
+    COMPAT_POOL_FREE(&pool, block, 100);
+    printf("Pool: 100-byte slot reused: %s, max alignment %lu\n",
+           COMPAT_POOL_ALLOC(&pool, 120) == block ? "yes" : "no",
+           (unsigned long)COMPAT_MAX_ALIGN);
+    
+    compat_pool_destroy(&pool);
+    compat_arena_destroy(&arena);
+}
+
 /**
  * Main function
  */
@@ -226,6 +276,22 @@ int main(void) {
     compat_strlcpy(buffer, "Hello, World!", sizeof(buffer));
     printf("Truncated string: %s\n", buffer);
     
+    printf("String length (at most 64): %lu\n",
+           (unsigned long)compat_strnlen("Hello, World!", 64));
+    
+    /* Test byte order helpers */
+    {
+        unsigned char wire[4];
+        
+        compat_store_be32(wire, 0x12345678UL);
+        printf("Big-endian bytes: %02x %02x %02x %02x, loaded back: 0x%08lx\n",
+               wire[0], wire[1], wire[2], wire[3], (unsigned long)compat_load_be32(wire));
+        printf("compat_bswap16(0x1234) = 0x%04x\n", (unsigned)compat_bswap16(0x1234));
+        if (COMPAT_UNLIKELY(compat_load_be16(wire) != 0x1234)) {
+            compat_fatal_error("byte order helpers are broken");
+        }
+    }
+    
     /* Test platform sleep */
     printf("Sleeping for 100ms...\n");
     compat_sleep_ms(100);
@@ -234,6 +300,9 @@ int main(void) {
     /* Test logging */
     compat_log("Log message: %d + %d = %d\n", 5, 3, 5 + 3);
     
+    /* Test allocators */
+    compat_allocator_demo();
+    
     return EXIT_SUCCESS;
 }
 
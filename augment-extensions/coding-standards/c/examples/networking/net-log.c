@@ -0,0 +1,260 @@
+/**
+ * @file net-log.c
+ * @brief Per-thread SPSC log rings drained by a background thread
+ * 
+ * Each producing thread lazily registers one ring. Only that thread advances
+ * head and only the drain thread advances tail, so a record costs one
+ * vsnprintf() and a release store; no lock is taken after registration.
+ * Records are formatted in place in a span of the shared byte ring
+ * (../common/spsc-ring.h) and printed from it, so nothing is copied.
+ */
+
+#define _GNU_SOURCE  /* localtime_r, nanosleep */
+
+#include "net-log.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "../common/spsc-ring.h"
+
+#define NET_LOG_RING_SLOTS   256            /* Records per thread; power of two */
+#define NET_LOG_RECORD_SIZE  256            /* Power of two: records never straddle the wrap */
+#define NET_LOG_MESSAGE_MAX  (NET_LOG_RECORD_SIZE - sizeof(struct timespec) - sizeof(net_log_level_t))
+#define NET_LOG_IDLE_NS      5000000L       /* Drain interval when all rings are empty */
+#define NET_LOG_CACHE_LINE   64
+
+/* One formatted log record */
+typedef struct {
+    struct timespec timestamp;
+    net_log_level_t level;
+    char text[NET_LOG_MESSAGE_MAX];
+} net_log_record_t;
+
+_Static_assert(sizeof(net_log_record_t) == NET_LOG_RECORD_SIZE,
+               "log records must tile the ring exactly");
+
+/* Per-thread ring of whole records */
+typedef struct net_log_ring {
+    spsc_ring_t spsc;                                   /* Producer: owner thread */
+    atomic_ullong dropped;
+    struct net_log_ring *next;                          /* Registry link */
+    _Alignas(NET_LOG_CACHE_LINE) uint8_t storage[NET_LOG_RING_SLOTS * NET_LOG_RECORD_SIZE];
+} net_log_ring_t;
+
+atomic_int net_log_level = NET_LOG_INFO;
+atomic_uint net_log_sample_rate = 1;
+
+static atomic_bool net_log_running = false;
+static pthread_t net_log_thread;
+static pthread_mutex_t net_log_registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static _Atomic(net_log_ring_t *) net_log_rings = NULL;
+static _Thread_local net_log_ring_t *net_log_thread_ring = NULL;
+
+static const char *const net_log_level_names[] = { "ERROR", "WARN", "INFO", "DEBUG" };
+
+/**
+ * @brief Print one record with a local timestamp
+ */
+static void net_log_emit(FILE *out, const struct timespec *timestamp,
+                         net_log_level_t level, const char *text) {
+    struct tm tm;
+    size_t len = strlen(text);
+
+    localtime_r(&timestamp->tv_sec, &tm);
+    fprintf(out, "%02d:%02d:%02d.%03ld %-5s %s%s",
+            tm.tm_hour, tm.tm_min, tm.tm_sec, timestamp->tv_nsec / 1000000L,
+            net_log_level_names[level], text,
+            (len > 0 && text[len - 1] == '\n') ? "" : "\n");
+}
+
+/**
+ * @brief Get the calling thread's ring, registering it on first use
+ */
+static net_log_ring_t *net_log_get_ring(void) {
+    if (net_log_thread_ring != NULL) {
+        return net_log_thread_ring;
+    }
+
+    net_log_ring_t *ring = aligned_alloc(NET_LOG_CACHE_LINE, sizeof(*ring));
+    if (ring == NULL) {
+        return NULL;
+    }
+    spsc_ring_init(&ring->spsc, ring->storage, sizeof(ring->storage));
+    atomic_init(&ring->dropped, 0);
+
+    /* Rings are only ever prepended, so the drain thread can walk the list
+     * without the lock once it has loaded the head */
+    pthread_mutex_lock(&net_log_registry_lock);
+    ring->next = atomic_load_explicit(&net_log_rings, memory_order_relaxed);
+    atomic_store_explicit(&net_log_rings, ring, memory_order_release);
+    pthread_mutex_unlock(&net_log_registry_lock);
+
+    net_log_thread_ring = ring;
+    return ring;
+}
+
+void net_log_write(net_log_level_t level, const char *fmt, ...) {
+    va_list args;
+
+    if (!atomic_load_explicit(&net_log_running, memory_order_acquire)) {
+        struct timespec now;
+        char text[NET_LOG_MESSAGE_MAX];
+
+        /* Not started (or already stopped): fall back to synchronous output */
+        va_start(args, fmt);
+        vsnprintf(text, sizeof(text), fmt, args);
+        va_end(args);
+        timespec_get(&now, TIME_UTC);
+        net_log_emit(stdout, &now, level, text);
+        return;
+    }
+
+    net_log_ring_t *ring = net_log_get_ring();
+    if (ring == NULL) {
+        return;
+    }
+
+    /* Format straight into the ring: the span always holds whole records */
+    uint8_t *span;
+    if (spsc_ring_peek_write(&ring->spsc, &span) < sizeof(net_log_record_t)) {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    net_log_record_t *record = (net_log_record_t *)(void *)span;
+    timespec_get(&record->timestamp, TIME_UTC);
+    record->level = level;
+    va_start(args, fmt);
+    vsnprintf(record->text, sizeof(record->text), fmt, args);
+    va_end(args);
+
+    /* Publish the record to the drain thread */
+    spsc_ring_commit_write(&ring->spsc, sizeof(*record));
+}
+
+/**
+ * @brief Print every pending record from every ring
+ * @return Number of records printed
+ */
+static size_t net_log_drain(void) {
+    size_t drained = 0;
+    net_log_ring_t *ring = atomic_load_explicit(&net_log_rings, memory_order_acquire);
+
+    for (; ring != NULL; ring = ring->next) {
+        /* Two spans cover everything pending: up to the end of storage, then
+         * from the start; records published meanwhile wait for the next pass */
+        for (int pass = 0; pass < 2; pass++) {
+            const uint8_t *span;
+            uint32_t len = spsc_ring_peek_read(&ring->spsc, &span);
+
+            if (len == 0) {
+                break;
+            }
+            for (uint32_t off = 0; off < len; off += sizeof(net_log_record_t)) {
+                const net_log_record_t *record = (const net_log_record_t *)(const void *)(span + off);
+                net_log_emit(stdout, &record->timestamp, record->level, record->text);
+                drained++;
+            }
+
+            /* Hand the records back to the producer */
+            spsc_ring_commit_read(&ring->spsc, len);
+        }
+    }
+
+    if (drained > 0) {
+        fflush(stdout);
+    }
+    return drained;
+}
+
+/**
+ * @brief Drain thread: empty the rings, sleep briefly when there is nothing
+ */
+static void *net_log_drain_main(void *arg) {
+    const struct timespec idle = { 0, NET_LOG_IDLE_NS };
+
+    (void)arg;
+    while (1) {
+        bool stopping = !atomic_load_explicit(&net_log_running, memory_order_acquire);
+
+        if (net_log_drain() == 0 && !stopping) {
+            nanosleep(&idle, NULL);
+        }
+        if (stopping) {
+            break;  /* The drain after observing the stop was the final one */
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Parse a level name from the environment
+ */
+static net_log_level_t net_log_parse_level(const char *name, net_log_level_t fallback) {
+    for (size_t i = 0; i < sizeof(net_log_level_names) / sizeof(net_log_level_names[0]); i++) {
+        const char *expected = net_log_level_names[i];
+        size_t j = 0;
+
+        while (name[j] != '\0' && expected[j] != '\0' &&
+               (name[j] == expected[j] || name[j] == expected[j] + ('a' - 'A'))) {
+            j++;
+        }
+        if (name[j] == '\0' && expected[j] == '\0') {
+            return (net_log_level_t)i;
+        }
+    }
+    return fallback;
+}
+
+int net_log_init(net_log_level_t level, unsigned sample_rate) {
+    const char *env_level = getenv("NET_LOG_LEVEL");
+    const char *env_sample = getenv("NET_LOG_SAMPLE");
+
+    if (env_level != NULL) {
+        level = net_log_parse_level(env_level, level);
+    }
+    if (env_sample != NULL && atoi(env_sample) > 0) {
+        sample_rate = (unsigned)atoi(env_sample);
+    }
+    if (sample_rate == 0) {
+        sample_rate = 1;
+    }
+
+    atomic_store(&net_log_level, (int)level);
+    atomic_store(&net_log_sample_rate, sample_rate);
+    atomic_store(&net_log_running, true);
+
+    if (pthread_create(&net_log_thread, NULL, net_log_drain_main, NULL) != 0) {
+        atomic_store(&net_log_running, false);
+        fprintf(stderr, "net_log_init: could not start drain thread\n");
+        return -1;
+    }
+    return 0;
+}
+
+void net_log_shutdown(void) {
+    unsigned long long dropped = 0;
+
+    if (!atomic_exchange(&net_log_running, false)) {
+        return;
+    }
+    pthread_join(net_log_thread, NULL);
+
+    net_log_ring_t *ring = atomic_exchange(&net_log_rings, NULL);
+    while (ring != NULL) {
+        net_log_ring_t *next = ring->next;
+        dropped += atomic_load(&ring->dropped);
+        free(ring);
+        ring = next;
+    }
+
+    if (dropped > 0) {
+        fprintf(stderr, "net-log: %llu records dropped (ring full)\n", dropped);
+    }
+}
@@ -0,0 +1,99 @@
+/**
+ * @file net-log.h
+ * @brief Non-blocking, sampled logging shared by the networking examples
+ * 
+ * Log sites format their record straight into a ring owned by the calling
+ * thread. A background thread drains every ring to stdout, so the data path
+ * never takes the stdio lock or waits on terminal I/O. When a ring is full
+ * the record is dropped and counted instead of blocking.
+ * 
+ * Usage:
+ *   net_log_init(NET_LOG_INFO, 1);
+ *   NET_LOG(NET_LOG_INFO, "listening on port %u", port);
+ *   NET_LOG_SAMPLED(NET_LOG_DEBUG, "received %zd bytes", n);  // 1 in N
+ *   net_log_shutdown();
+ * 
+ * The environment variables NET_LOG_LEVEL (error, warn, info, debug) and
+ * NET_LOG_SAMPLE (N) override the defaults passed to net_log_init().
+ */
+
+#ifndef NETWORKING_NET_LOG_H
+#define NETWORKING_NET_LOG_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+/* Severity levels; a record is emitted when level <= the current level */
+typedef enum {
+    NET_LOG_ERROR,
+    NET_LOG_WARN,
+    NET_LOG_INFO,
+    NET_LOG_DEBUG
+} net_log_level_t;
+
+/* Current level and sampling rate; read on every log site */
+extern atomic_int net_log_level;
+extern atomic_uint net_log_sample_rate;
+
+/**
+ * @brief Start the drain thread
+ * @param level Default level if NET_LOG_LEVEL is unset
+ * @param sample_rate Default 1-in-N rate for NET_LOG_SAMPLED sites
+ * @return 0 on success, -1 on error (records are then written synchronously)
+ */
+int net_log_init(net_log_level_t level, unsigned sample_rate);
+
+/**
+ * @brief Drain what is left, stop the drain thread and report drops
+ * 
+ * Call once every producing thread has stopped logging. Later records are
+ * written synchronously; net_log_init() must not be called again.
+ */
+void net_log_shutdown(void);
+
+/**
+ * @brief Format a record into the calling thread's ring
+ * 
+ * Prefer the NET_LOG macros, which skip argument evaluation when the level
+ * is disabled.
+ */
+void net_log_write(net_log_level_t level, const char *fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief Check whether a level is currently enabled
+ */
+static inline bool net_log_enabled(net_log_level_t level) {
+    return (int)level <= atomic_load_explicit(&net_log_level, memory_order_relaxed);
+}
+
+/**
+ * @brief Per-site 1-in-N sampling; the first call at a site always passes
+ */
+static inline bool net_log_sample(unsigned *countdown) {
+    if (*countdown == 0) {
+        *countdown = atomic_load_explicit(&net_log_sample_rate, memory_order_relaxed) - 1;
+        return true;
+    }
+    (*countdown)--;
+    return false;
+}
+
+/* Log a record if its level is enabled */
+#define NET_LOG(level, ...)                              \
+    do {                                                 \
+        if (net_log_enabled(level)) {                    \
+            net_log_write((level), __VA_ARGS__);         \
+        }                                                \
+    } while (0)
+
+/* Log one in every NET_LOG_SAMPLE records from this site and thread */
+#define NET_LOG_SAMPLED(level, ...)                                       \
+    do {                                                                  \
+        static _Thread_local unsigned net_log_countdown_;                 \
+        if (net_log_enabled(level) && net_log_sample(&net_log_countdown_)) { \
+            net_log_write((level), __VA_ARGS__);                          \
+        }                                                                 \
+    } while (0)
+
+#endif /* NETWORKING_NET_LOG_H */
@@ -5,28 +5,126 @@
  * This example demonstrates:
  * - TCP socket creation and binding
  * - Connection handling
- * - Non-blocking I/O
+ * - Non-blocking I/O with an edge-triggered epoll event loop
  * - Error handling
  * - Resource cleanup
  * 
- * Compile: gcc -Wall -Wextra -std=c11 -o tcp-server tcp-server.c
- * Run: ./tcp-server 8080
+ * Engines:
+ * - epoll (default): one process multiplexes every client; each connection
+ *   keeps its own state so partial sends resume on EPOLLOUT
+ * - uring: completion-based io_uring loop with multishot accept/recv, a
+ *   provided-buffer ring and batched submission (Linux 6.0+)
+ * - blocking: the original accept()-then-serve loop, one client at a time
+ * 
+ * With --workers N the epoll or uring engine runs N threads, each pinned to a
+ * CPU with its own SO_REUSEPORT listener and event loop. The kernel load-balances new
+ * connections across the listeners, so no two workers ever wait on the same
+ * accept queue. Per-worker counters are summed and printed at shutdown.
+ * 
+ * Connection events and sampled per-message records go through net-log,
+ * so the data path never blocks on stdout (see NET_LOG_LEVEL/NET_LOG_SAMPLE).
+ * 
+ * Compile: gcc -Wall -Wextra -std=c11 -pthread -o tcp-server tcp-server.c net-log.c
+ * Run: ./tcp-server [--engine epoll|uring|blocking] [--workers N] 8080
  * Test: telnet localhost 8080
  */
 
+#define _GNU_SOURCE  /* usleep, sigaction, MSG_NOSIGNAL, CPU affinity, syscall */
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdbool.h>
 #include <unistd.h>
 #include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sched.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <fcntl.h>
 
+#include "net-log.h"
+
+/* The io_uring engine needs multishot recv and provided-buffer rings */
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#if defined(IORING_RECV_MULTISHOT) && defined(IORING_ACCEPT_MULTISHOT)
+#define HAVE_IO_URING 1
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+#endif
+#endif
+#ifndef HAVE_IO_URING
+#define HAVE_IO_URING 0
+#endif
+
 #define BUFFER_SIZE 1024
-#define MAX_PENDING 5
+#define MAX_PENDING SOMAXCONN
+#define MAX_EVENTS  64
+#define MAX_WORKERS 256
+#define CACHE_LINE_SIZE 64
+
+/* Server engines selectable with --engine */
+typedef enum {
+    ENGINE_EPOLL,
+    ENGINE_URING,
+    ENGINE_BLOCKING
+} server_engine_t;
+
+/* Per-connection state for the event loop */
+typedef struct connection {
+    int fd;
+    struct sockaddr_in addr;
+    char buffer[BUFFER_SIZE];
+    size_t pending_off;         /* First unsent byte in buffer */
+    size_t pending_len;         /* Bytes in buffer waiting to be sent */
+    bool close_after_flush;     /* Client sent "quit" */
+    struct connection *prev;    /* Links in event_loop_t.connections */
+    struct connection *next;
+} connection_t;
+
+/* Counters owned by a single event loop; only read once it has stopped */
+typedef struct {
+    unsigned long long accepts;
+    unsigned long long bytes_in;
+    unsigned long long bytes_out;
+    unsigned long long active_connections;
+    unsigned long long peak_connections;
+    unsigned long long syscalls;        /* Data-path system calls made */
+} server_stats_t;
+
+/* Event loop state: one epoll set, its listener and its live connections */
+typedef struct {
+    int epoll_fd;
+    int server_fd;
+    int wakeup_fd;              /* eventfd signalled at shutdown, or -1 */
+    connection_t *connections;
+    server_stats_t stats;
+} event_loop_t;
+
+/* One worker thread; aligned so neighbouring workers' counters never share
+ * a cache line */
+typedef struct {
+    _Alignas(CACHE_LINE_SIZE) pthread_t thread;
+    int id;
+    int cpu;
+    int status;
+    server_engine_t engine;
+    event_loop_t loop;
+} worker_t;
+
+/* Set from SIGINT/SIGTERM to leave the event loop */
+static volatile sig_atomic_t shutdown_requested = 0;
+
+static const char welcome_message[] = "Welcome to TCP server!\r\n";
 
 /**
  * @brief Set socket to non-blocking mode
@@ -48,8 +146,10 @@ static int set_nonblocking(int sockfd) {
 
 /**
  * @brief Create and configure TCP server socket
+ * @param port Port to listen on
+ * @param reuse_port Set SO_REUSEPORT so several listeners can share the port
  */
-static int create_server_socket(uint16_t port) {
+static int create_server_socket(uint16_t port, bool reuse_port) {
     int sockfd;
     struct sockaddr_in server_addr;
     int reuse = 1;
@@ -68,6 +168,15 @@ static int create_server_socket(uint16_t port) {
         return -1;
     }
     
+    /* Each SO_REUSEPORT listener gets its own accept queue; the kernel
+     * hashes incoming connections across them */
+    if (reuse_port &&
+        setsockopt(sockfd, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse)) < 0) {
+        perror("setsockopt(SO_REUSEPORT)");
+        close(sockfd);
+        return -1;
+    }
+    
     /* Bind to address */
     memset(&server_addr, 0, sizeof(server_addr));
     server_addr.sin_family = AF_INET;
@@ -87,10 +196,29 @@ static int create_server_socket(uint16_t port) {
         return -1;
     }
     
-    printf("TCP server listening on port %u\n", port);
+    if (!reuse_port) {
+        printf("TCP server listening on port %u\n", port);
+    }
     return sockfd;
 }
 
+/**
+ * @brief Log a connection event with the peer address
+ * 
+ * Uses the reentrant inet_ntop() and skips formatting when INFO is off.
+ */
+static void log_peer_event(const char *event, const struct sockaddr_in *addr) {
+    char ip[INET_ADDRSTRLEN];
+
+    if (!net_log_enabled(NET_LOG_INFO)) {
+        return;
+    }
+    if (inet_ntop(AF_INET, &addr->sin_addr, ip, sizeof(ip)) == NULL) {
+        strcpy(ip, "?");
+    }
+    net_log_write(NET_LOG_INFO, "%s %s:%u", event, ip, ntohs(addr->sin_port));
+}
+
 /**
  * @brief Handle client connection
  */
@@ -98,9 +226,7 @@ static void handle_client(int client_fd, struct sockaddr_in *client_addr) {
     char buffer[BUFFER_SIZE];
     ssize_t bytes_read;
     
-    printf("New connection from %s:%u\n",
-           inet_ntoa(client_addr->sin_addr),
-           ntohs(client_addr->sin_port));
+    log_peer_event("New connection from", client_addr);
     
     /* Send welcome message */
     const char *welcome = "Welcome to TCP server!\r\n";
@@ -123,12 +249,12 @@ static void handle_client(int client_fd, struct sockaddr_in *client_addr) {
             break;
         } else if (bytes_read == 0) {
             /* Connection closed by client */
-            printf("Client disconnected\n");
+            NET_LOG(NET_LOG_INFO, "Client disconnected");
             break;
         }
         
         buffer[bytes_read] = '\0';
-        printf("Received: %s", buffer);
+        NET_LOG_SAMPLED(NET_LOG_DEBUG, "Received: %s", buffer);
         
         /* Echo back to client */
         if (send(client_fd, buffer, bytes_read, 0) < 0) {
@@ -138,60 +264,1262 @@ static void handle_client(int client_fd, struct sockaddr_in *client_addr) {
         
         /* Check for quit command */
         if (strncmp(buffer, "quit", 4) == 0) {
-            printf("Client requested disconnect\n");
+            NET_LOG(NET_LOG_INFO, "Client requested disconnect");
             break;
         }
     }
 }
 
 /**
- * @brief Main server loop
+ * @brief Signal handler for SIGINT and SIGTERM
  */
-int main(int argc, char *argv[]) {
-    int server_fd, client_fd;
+static void shutdown_handler(int signum) {
+    (void)signum;
+    shutdown_requested = 1;
+}
+
+/**
+ * @brief Install shutdown handlers without SA_RESTART so epoll_wait() returns
+ * @return 0 on success, -1 on error
+ */
+static int install_shutdown_handlers(void) {
+    struct sigaction sa;
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = shutdown_handler;
+    sigemptyset(&sa.sa_mask);
+
+    if (sigaction(SIGINT, &sa, NULL) < 0 || sigaction(SIGTERM, &sa, NULL) < 0) {
+        perror("sigaction");
+        return -1;
+    }
+
+    /* Peers resetting mid-send must not kill the whole server */
+    signal(SIGPIPE, SIG_IGN);
+    return 0;
+}
+
+/**
+ * @brief Unlink a connection from its loop and release it
+ *
+ * Closing the descriptor also removes it from the epoll set.
+ */
+static void connection_close(event_loop_t *loop, connection_t *conn) {
+    log_peer_event("Disconnected", &conn->addr);
+
+    if (conn->prev != NULL) {
+        conn->prev->next = conn->next;
+    } else {
+        loop->connections = conn->next;
+    }
+    if (conn->next != NULL) {
+        conn->next->prev = conn->prev;
+    }
+    loop->stats.active_connections--;
+
+    close(conn->fd);
+    free(conn);
+}
+
+/**
+ * @brief Send as much pending output as the socket accepts
+ * @return 1 when drained, 0 when the socket is full, -1 on error
+ */
+static int connection_flush(event_loop_t *loop, connection_t *conn) {
+    while (conn->pending_off < conn->pending_len) {
+        ssize_t sent = send(conn->fd, conn->buffer + conn->pending_off,
+                            conn->pending_len - conn->pending_off, MSG_NOSIGNAL);
+        loop->stats.syscalls++;
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return 0;  /* Resume on the next EPOLLOUT edge */
+            }
+            perror("send");
+            return -1;
+        }
+        conn->pending_off += (size_t)sent;
+        loop->stats.bytes_out += (unsigned long long)sent;
+    }
+
+    conn->pending_off = 0;
+    conn->pending_len = 0;
+    return 1;
+}
+
+/**
+ * @brief Drive a connection until the socket would block
+ *
+ * With edge-triggered notification, readiness is only reported once per
+ * state change, so both directions are drained here until EAGAIN. Reading
+ * stops while an echo is still pending, which applies backpressure to a
+ * client that sends faster than it reads.
+ *
+ * @return 0 to keep the connection, -1 to close it
+ */
+static int connection_service(event_loop_t *loop, connection_t *conn) {
+    while (1) {
+        int flushed = connection_flush(loop, conn);
+        if (flushed < 0) {
+            return -1;
+        }
+        if (flushed == 0) {
+            return 0;
+        }
+        if (conn->close_after_flush) {
+            return -1;
+        }
+
+        ssize_t bytes_read = recv(conn->fd, conn->buffer, sizeof(conn->buffer), 0);
+        loop->stats.syscalls++;
+        if (bytes_read < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return 0;
+            }
+            perror("recv");
+            return -1;
+        }
+        if (bytes_read == 0) {
+            return -1;  /* Connection closed by client */
+        }
+
+        conn->pending_len = (size_t)bytes_read;
+        loop->stats.bytes_in += (unsigned long long)bytes_read;
+        NET_LOG_SAMPLED(NET_LOG_DEBUG, "fd %d: received %zd bytes", conn->fd, bytes_read);
+        if (conn->pending_len >= 4 && strncmp(conn->buffer, "quit", 4) == 0) {
+            conn->close_after_flush = true;
+        }
+    }
+}
+
+/**
+ * @brief Accept every queued connection and register it with epoll
+ */
+static void accept_connections(event_loop_t *loop) {
+    while (1) {
+        struct sockaddr_in client_addr;
+        socklen_t client_len = sizeof(client_addr);
+        int client_fd = accept(loop->server_fd, (struct sockaddr *)&client_addr, &client_len);
+        loop->stats.syscalls++;
+
+        if (client_fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                perror("accept");  /* e.g. EMFILE; retried on the next edge */
+            }
+            return;
+        }
+
+        if (set_nonblocking(client_fd) < 0) {
+            close(client_fd);
+            continue;
+        }
+
+        connection_t *conn = calloc(1, sizeof(*conn));
+        if (conn == NULL) {
+            perror("calloc");
+            close(client_fd);
+            continue;
+        }
+        conn->fd = client_fd;
+        conn->addr = client_addr;
+
+        log_peer_event("New connection from", &client_addr);
+
+        /* Queue the welcome message as the first pending output */
+        memcpy(conn->buffer, welcome_message, sizeof(welcome_message) - 1);
+        conn->pending_len = sizeof(welcome_message) - 1;
+
+        /* EPOLLOUT is edge-triggered too, so it only fires when a full
+         * socket becomes writable again and never busy-loops */
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.ptr = conn;
+        if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, client_fd, &ev) < 0) {
+            perror("epoll_ctl(EPOLL_CTL_ADD)");
+            close(client_fd);
+            free(conn);
+            continue;
+        }
+
+        conn->next = loop->connections;
+        if (loop->connections != NULL) {
+            loop->connections->prev = conn;
+        }
+        loop->connections = conn;
+
+        loop->stats.accepts++;
+        loop->stats.active_connections++;
+        if (loop->stats.active_connections > loop->stats.peak_connections) {
+            loop->stats.peak_connections = loop->stats.active_connections;
+        }
+
+        if (connection_service(loop, conn) < 0) {
+            connection_close(loop, conn);
+        }
+    }
+}
+
+/**
+ * @brief Add a descriptor to the loop's epoll set with a data tag
+ */
+static int event_loop_watch(event_loop_t *loop, int fd, uint32_t events, void *tag) {
+    struct epoll_event ev;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.ptr = tag;
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        perror("epoll_ctl(EPOLL_CTL_ADD)");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Serve all clients of one listener from an edge-triggered epoll loop
+ *
+ * The listener and wakeup descriptors are tagged with pointers to their
+ * fields in the loop; every other event carries its connection_t. The
+ * wakeup eventfd is level-triggered and never read, so one write wakes every
+ * worker sharing it. Connections still open at shutdown are closed before
+ * returning.
+ *
+ * @param loop Loop with server_fd and wakeup_fd set; other fields are reset
+ * @return 0 on clean shutdown, -1 on error
+ */
+static int run_event_loop(event_loop_t *loop) {
+    struct epoll_event events[MAX_EVENTS];
+    bool running = true;
+    int status = 0;
+
+    loop->connections = NULL;
+    memset(&loop->stats, 0, sizeof(loop->stats));
+
+    if (set_nonblocking(loop->server_fd) < 0) {
+        return -1;
+    }
+
+    loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (loop->epoll_fd < 0) {
+        perror("epoll_create1");
+        return -1;
+    }
+
+    if (event_loop_watch(loop, loop->server_fd, EPOLLIN | EPOLLET, &loop->server_fd) < 0 ||
+        (loop->wakeup_fd >= 0 &&
+         event_loop_watch(loop, loop->wakeup_fd, EPOLLIN, &loop->wakeup_fd) < 0)) {
+        close(loop->epoll_fd);
+        return -1;
+    }
+
+    while (running && !shutdown_requested) {
+        int ready = epoll_wait(loop->epoll_fd, events, MAX_EVENTS, -1);
+        loop->stats.syscalls++;
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("epoll_wait");
+            status = -1;
+            break;
+        }
+
+        for (int i = 0; i < ready; i++) {
+            void *tag = events[i].data.ptr;
+
+            if (tag == &loop->wakeup_fd) {
+                running = false;
+                continue;
+            }
+            if (tag == &loop->server_fd) {
+                accept_connections(loop);
+                continue;
+            }
+
+            connection_t *conn = tag;
+            if ((events[i].events & (EPOLLERR | EPOLLHUP)) != 0 ||
+                connection_service(loop, conn) < 0) {
+                connection_close(loop, conn);
+            }
+        }
+    }
+
+    /* Report how many connections shutdown interrupted */
+    unsigned long long still_open = loop->stats.active_connections;
+    while (loop->connections != NULL) {
+        connection_close(loop, loop->connections);
+    }
+    loop->stats.active_connections = still_open;
+    close(loop->epoll_fd);
+    return status;
+}
+
+#if HAVE_IO_URING
+/*
+ * io_uring engine
+ *
+ * The ring is driven directly through the io_uring_setup/enter/register
+ * system calls so the example has no library dependency. Every loop
+ * iteration makes one io_uring_enter() call that both submits all queued
+ * SQEs and waits for at least one completion.
+ *
+ * Received data lands in a registered provided-buffer ring; the echo is sent
+ * straight out of that buffer and the buffer is handed back to the kernel
+ * once the send completes. Each connection keeps at most one send in flight
+ * and queues further buffers by ID, so echoes cannot be reordered.
+ */
+
+#define URING_ENTRIES     256
+#define URING_BUF_COUNT   1024          /* Provided buffers; power of two */
+#define URING_BUF_GROUP   0
+#define URING_NO_BUFFER   0xFFFFu
+#define URING_OP_MASK     0x7u
+
+/* Operation encoded in the low bits of SQE user_data */
+typedef enum {
+    URING_OP_ACCEPT = 1,
+    URING_OP_RECV,
+    URING_OP_SEND,
+    URING_OP_WAKEUP
+} uring_op_t;
+
+/* Mapped submission/completion rings plus the provided-buffer ring */
+typedef struct {
+    int ring_fd;
+    unsigned sq_entries;
+    unsigned sq_mask;
+    unsigned cq_mask;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_array;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    unsigned sq_pending;                /* SQEs published but not submitted */
+    void *sq_ring;
+    size_t sq_ring_size;
+    void *cq_ring;
+    size_t cq_ring_size;
+    size_t sqes_size;
+    struct io_uring_buf_ring *buf_ring;
+    size_t buf_ring_size;
+    uint8_t *buf_pool;
+    uint16_t buf_tail;                  /* Local copy of buf_ring->tail */
+    bool buf_recycled;                  /* A buffer went back since the last reap */
+    uint16_t buf_len[URING_BUF_COUNT];  /* Bytes received into each buffer */
+    uint16_t buf_next[URING_BUF_COUNT]; /* Send-queue links between buffers */
+} uring_t;
+
+/* Per-connection state for the io_uring engine */
+typedef struct uring_conn {
+    int fd;
+    unsigned inflight;                  /* Operations the kernel still owns */
+    bool recv_armed;                    /* Multishot recv is active */
+    bool sending;
+    bool closing;
+    bool close_after_flush;             /* Client sent "quit" */
+    const uint8_t *send_ptr;
+    size_t send_len;
+    uint16_t send_bid;                  /* Buffer being sent, or URING_NO_BUFFER */
+    uint16_t queue_head;                /* Received buffers waiting to be sent */
+    uint16_t queue_tail;
+    struct uring_conn *prev;            /* Links in the live connection list */
+    struct uring_conn *next;
+    struct uring_conn *next_starved;    /* Waiting for buffers after ENOBUFS */
+} uring_conn_t;
+
+/* io_uring engine state for one listener */
+typedef struct {
+    uring_t ring;
+    event_loop_t *loop;                 /* Listener, wakeup fd and counters */
+    uring_conn_t *connections;
+    uring_conn_t *starved;
+    bool accept_paused;                 /* Out of descriptors; re-armed on release */
+    bool running;
+} uring_loop_t;
+
+static int uring_setup(unsigned entries, struct io_uring_params *params) {
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete,
+                       unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete,
+                        flags, NULL, 0);
+}
+
+static int uring_register(int ring_fd, unsigned opcode, void *arg, unsigned nr_args) {
+    return (int)syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args);
+}
+
+/**
+ * @brief Unmap the rings and buffers and close the ring descriptor
+ */
+static void uring_destroy(uring_t *ring) {
+    if (ring->ring_fd >= 0) {
+        close(ring->ring_fd);
+    }
+    if (ring->sqes != NULL && ring->sqes != MAP_FAILED) {
+        munmap(ring->sqes, ring->sqes_size);
+    }
+    if (ring->cq_ring != NULL && ring->cq_ring != MAP_FAILED &&
+        ring->cq_ring != ring->sq_ring) {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    if (ring->sq_ring != NULL && ring->sq_ring != MAP_FAILED) {
+        munmap(ring->sq_ring, ring->sq_ring_size);
+    }
+    if (ring->buf_ring != NULL && ring->buf_ring != MAP_FAILED) {
+        munmap(ring->buf_ring, ring->buf_ring_size);
+    }
+    free(ring->buf_pool);
+}
+
+/**
+ * @brief Return a provided buffer to the kernel
+ */
+static void uring_recycle_buffer(uring_t *ring, uint16_t bid) {
+    struct io_uring_buf *buf =
+        &ring->buf_ring->bufs[ring->buf_tail & (URING_BUF_COUNT - 1)];
+
+    buf->addr = (uint64_t)(uintptr_t)(ring->buf_pool + (size_t)bid * BUFFER_SIZE);
+    buf->len = BUFFER_SIZE;
+    buf->bid = bid;
+    ring->buf_tail++;
+    ring->buf_recycled = true;
+
+    /* Publish the entry before the kernel can observe the new tail */
+    __atomic_store_n(&ring->buf_ring->tail, ring->buf_tail, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Create the ring, map it and register the provided-buffer ring
+ * @return 0 on success, -1 on error
+ */
+static int uring_init(uring_t *ring) {
+    struct io_uring_params params;
+    struct io_uring_buf_reg reg;
+
+    memset(ring, 0, sizeof(*ring));
+    ring->ring_fd = -1;
+
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN |
+                   IORING_SETUP_CQSIZE;
+    params.cq_entries = URING_ENTRIES * 8;  /* Multishot ops post many CQEs */
+
+    ring->ring_fd = uring_setup(URING_ENTRIES, &params);
+    if (ring->ring_fd < 0) {
+        perror("io_uring_setup");
+        return -1;
+    }
+
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size = params.cq_off.cqes +
+                         params.cq_entries * sizeof(struct io_uring_cqe);
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0 &&
+        ring->cq_ring_size > ring->sq_ring_size) {
+        ring->sq_ring_size = ring->cq_ring_size;
+    }
+
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, ring->ring_fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED) {
+        perror("mmap(IORING_OFF_SQ_RING)");
+        uring_destroy(ring);
+        return -1;
+    }
+
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+        ring->cq_ring = ring->sq_ring;
+    } else {
+        ring->cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, ring->ring_fd,
+                             IORING_OFF_CQ_RING);
+        if (ring->cq_ring == MAP_FAILED) {
+            perror("mmap(IORING_OFF_CQ_RING)");
+            uring_destroy(ring);
+            return -1;
+        }
+    }
+
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring->ring_fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        perror("mmap(IORING_OFF_SQES)");
+        uring_destroy(ring);
+        return -1;
+    }
+
+    uint8_t *sq = ring->sq_ring;
+    uint8_t *cq = ring->cq_ring;
+    ring->sq_entries = params.sq_entries;
+    ring->sq_head = (unsigned *)(sq + params.sq_off.head);
+    ring->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+    ring->sq_mask = *(unsigned *)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned *)(sq + params.sq_off.array);
+    ring->cq_head = (unsigned *)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+    ring->cq_mask = *(unsigned *)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+
+    /* Provided-buffer ring: the kernel picks a buffer per recv completion */
+    ring->buf_ring_size = sizeof(struct io_uring_buf) * URING_BUF_COUNT;
+    ring->buf_ring = mmap(NULL, ring->buf_ring_size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ring->buf_pool = malloc((size_t)URING_BUF_COUNT * BUFFER_SIZE);
+    if (ring->buf_ring == MAP_FAILED || ring->buf_pool == NULL) {
+        perror("buffer ring allocation");
+        uring_destroy(ring);
+        return -1;
+    }
+
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uint64_t)(uintptr_t)ring->buf_ring;
+    reg.ring_entries = URING_BUF_COUNT;
+    reg.bgid = URING_BUF_GROUP;
+    if (uring_register(ring->ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        perror("io_uring_register(IORING_REGISTER_PBUF_RING)");
+        uring_destroy(ring);
+        return -1;
+    }
+
+    for (unsigned bid = 0; bid < URING_BUF_COUNT; bid++) {
+        uring_recycle_buffer(ring, (uint16_t)bid);
+    }
+    return 0;
+}
+
+/**
+ * @brief Submit queued SQEs and optionally wait for completions
+ * @return 0 on success, -1 on error (errno set)
+ */
+static int uring_submit(uring_loop_t *ul, unsigned wait_for) {
+    uring_t *ring = &ul->ring;
+    unsigned flags = (wait_for > 0) ? IORING_ENTER_GETEVENTS : 0;
+
+    ul->loop->stats.syscalls++;
+    int submitted = uring_enter(ring->ring_fd, ring->sq_pending, wait_for, flags);
+    if (submitted < 0) {
+        return -1;
+    }
+    ring->sq_pending -= (unsigned)submitted;
+    return 0;
+}
+
+/**
+ * @brief Claim and clear the next SQE, flushing the queue if it is full
+ */
+static struct io_uring_sqe *uring_get_sqe(uring_loop_t *ul) {
+    uring_t *ring = &ul->ring;
+    unsigned tail = *ring->sq_tail;
+
+    while (tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) >= ring->sq_entries) {
+        if (uring_submit(ul, 0) < 0 && errno != EINTR && errno != EAGAIN &&
+            errno != EBUSY) {
+            perror("io_uring_enter");
+            return NULL;
+        }
+    }
+
+    struct io_uring_sqe *sqe = &ring->sqes[tail & ring->sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+    ring->sq_array[tail & ring->sq_mask] = tail & ring->sq_mask;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ring->sq_pending++;
+    return sqe;
+}
+
+static uint64_t uring_tag(uring_conn_t *conn, uring_op_t op) {
+    return (uint64_t)(uintptr_t)conn | (uint64_t)op;
+}
+
+/**
+ * @brief Queue a multishot accept on the listener
+ */
+static void uring_arm_accept(uring_loop_t *ul) {
+    struct io_uring_sqe *sqe = uring_get_sqe(ul);
+    if (sqe == NULL) {
+        ul->running = false;
+        return;
+    }
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = ul->loop->server_fd;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->user_data = uring_tag(NULL, URING_OP_ACCEPT);
+}
+
+/**
+ * @brief Queue a multishot recv that draws buffers from the provided ring
+ */
+static void uring_arm_recv(uring_loop_t *ul, uring_conn_t *conn) {
+    struct io_uring_sqe *sqe = uring_get_sqe(ul);
+    if (sqe == NULL) {
+        return;
+    }
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = conn->fd;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_BUF_GROUP;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->user_data = uring_tag(conn, URING_OP_RECV);
+    conn->recv_armed = true;
+    conn->inflight++;
+}
+
+/**
+ * @brief Queue the current send of a connection
+ */
+static void uring_arm_send(uring_loop_t *ul, uring_conn_t *conn) {
+    struct io_uring_sqe *sqe = uring_get_sqe(ul);
+    if (sqe == NULL) {
+        return;
+    }
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = conn->fd;
+    sqe->addr = (uint64_t)(uintptr_t)conn->send_ptr;
+    sqe->len = (unsigned)conn->send_len;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = uring_tag(conn, URING_OP_SEND);
+    conn->sending = true;
+    conn->inflight++;
+}
+
+/**
+ * @brief Stop reading and writing; the connection is freed once idle
+ */
+static void uring_conn_begin_close(uring_loop_t *ul, uring_conn_t *conn) {
+    if (conn->closing) {
+        return;
+    }
+    conn->closing = true;
+
+    /* Terminates the multishot recv and any pending send */
+    shutdown(conn->fd, SHUT_RDWR);
+
+    while (conn->queue_head != URING_NO_BUFFER) {
+        uint16_t bid = conn->queue_head;
+        conn->queue_head = ul->ring.buf_next[bid];
+        uring_recycle_buffer(&ul->ring, bid);
+    }
+    conn->queue_tail = URING_NO_BUFFER;
+}
+
+/**
+ * @brief Free a connection once the kernel holds no operations on it
+ */
+static void uring_conn_release(uring_loop_t *ul, uring_conn_t *conn) {
+    for (uring_conn_t **link = &ul->starved; *link != NULL; link = &(*link)->next_starved) {
+        if (*link == conn) {
+            *link = conn->next_starved;
+            break;
+        }
+    }
+
+    if (conn->prev != NULL) {
+        conn->prev->next = conn->next;
+    } else {
+        ul->connections = conn->next;
+    }
+    if (conn->next != NULL) {
+        conn->next->prev = conn->prev;
+    }
+    ul->loop->stats.active_connections--;
+
+    NET_LOG(NET_LOG_INFO, "Client fd %d disconnected", conn->fd);
+    close(conn->fd);
+    free(conn);
+
+    /* A descriptor is free again: resume accepting */
+    if (ul->accept_paused && ul->running) {
+        ul->accept_paused = false;
+        uring_arm_accept(ul);
+    }
+}
+
+/**
+ * @brief Start sending the next queued buffer, if any
+ */
+static void uring_conn_send_next(uring_loop_t *ul, uring_conn_t *conn) {
+    if (conn->sending || conn->closing) {
+        return;
+    }
+
+    if (conn->queue_head == URING_NO_BUFFER) {
+        if (conn->close_after_flush) {
+            uring_conn_begin_close(ul, conn);
+        }
+        return;
+    }
+
+    uint16_t bid = conn->queue_head;
+    conn->queue_head = ul->ring.buf_next[bid];
+    if (conn->queue_head == URING_NO_BUFFER) {
+        conn->queue_tail = URING_NO_BUFFER;
+    }
+
+    conn->send_bid = bid;
+    conn->send_ptr = ul->ring.buf_pool + (size_t)bid * BUFFER_SIZE;
+    conn->send_len = ul->ring.buf_len[bid];
+    uring_arm_send(ul, conn);
+}
+
+/**
+ * @brief Handle a completion from the multishot accept
+ */
+static void uring_on_accept(uring_loop_t *ul, const struct io_uring_cqe *cqe) {
+    if ((cqe->flags & IORING_CQE_F_MORE) == 0 && ul->running) {
+        if (cqe->res == -EMFILE || cqe->res == -ENFILE ||
+            cqe->res == -ENOBUFS || cqe->res == -ENOMEM) {
+            /* Re-arming now would fail again at once; wait for a release */
+            ul->accept_paused = true;
+        } else {
+            uring_arm_accept(ul);
+        }
+    }
+
+    if (cqe->res < 0) {
+        if (cqe->res != -EAGAIN && cqe->res != -ECONNABORTED) {
+            NET_LOG(NET_LOG_ERROR, "accept: %s", strerror(-cqe->res));
+        }
+        return;
+    }
+
+    uring_conn_t *conn = calloc(1, sizeof(*conn));
+    if (conn == NULL) {
+        perror("calloc");
+        close(cqe->res);
+        return;
+    }
+    conn->fd = cqe->res;
+    conn->send_bid = URING_NO_BUFFER;
+    conn->queue_head = URING_NO_BUFFER;
+    conn->queue_tail = URING_NO_BUFFER;
+
+    conn->next = ul->connections;
+    if (ul->connections != NULL) {
+        ul->connections->prev = conn;
+    }
+    ul->connections = conn;
+
+    ul->loop->stats.accepts++;
+    ul->loop->stats.active_connections++;
+    if (ul->loop->stats.active_connections > ul->loop->stats.peak_connections) {
+        ul->loop->stats.peak_connections = ul->loop->stats.active_connections;
+    }
+
+    NET_LOG(NET_LOG_INFO, "New connection on fd %d", conn->fd);
+
+    conn->send_ptr = (const uint8_t *)welcome_message;
+    conn->send_len = sizeof(welcome_message) - 1;
+    uring_arm_send(ul, conn);
+    uring_arm_recv(ul, conn);
+}
+
+/**
+ * @brief Handle a completion from a connection's multishot recv
+ */
+static void uring_on_recv(uring_loop_t *ul, uring_conn_t *conn,
+                          const struct io_uring_cqe *cqe) {
+    uring_t *ring = &ul->ring;
+
+    if ((cqe->flags & IORING_CQE_F_MORE) == 0) {
+        conn->recv_armed = false;
+        conn->inflight--;
+    }
+
+    if (cqe->res > 0 && (cqe->flags & IORING_CQE_F_BUFFER) != 0) {
+        uint16_t bid = (uint16_t)(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+        const uint8_t *data = ring->buf_pool + (size_t)bid * BUFFER_SIZE;
+
+        ul->loop->stats.bytes_in += (unsigned long long)cqe->res;
+        NET_LOG_SAMPLED(NET_LOG_DEBUG, "fd %d: received %d bytes", conn->fd, cqe->res);
+        if (conn->closing) {
+            uring_recycle_buffer(ring, bid);
+            return;
+        }
+
+        ring->buf_len[bid] = (uint16_t)cqe->res;
+        ring->buf_next[bid] = URING_NO_BUFFER;
+        if (conn->queue_tail == URING_NO_BUFFER) {
+            conn->queue_head = bid;
+        } else {
+            ring->buf_next[conn->queue_tail] = bid;
+        }
+        conn->queue_tail = bid;
+
+        if (cqe->res >= 4 && memcmp(data, "quit", 4) == 0) {
+            conn->close_after_flush = true;
+        }
+        uring_conn_send_next(ul, conn);
+    } else if (cqe->res == -ENOBUFS) {
+        /* Every buffer is queued for sending; retry once some are recycled */
+        if (!conn->closing && !conn->recv_armed) {
+            conn->next_starved = ul->starved;
+            ul->starved = conn;
+        }
+        return;
+    } else {
+        uring_conn_begin_close(ul, conn);  /* EOF or error */
+        return;
+    }
+
+    if (!conn->recv_armed && !conn->closing && !conn->close_after_flush) {
+        uring_arm_recv(ul, conn);
+    }
+}
+
+/**
+ * @brief Handle a send completion; resubmit short sends
+ */
+static void uring_on_send(uring_loop_t *ul, uring_conn_t *conn,
+                          const struct io_uring_cqe *cqe) {
+    conn->inflight--;
+    conn->sending = false;
+
+    if (cqe->res > 0) {
+        ul->loop->stats.bytes_out += (unsigned long long)cqe->res;
+    }
+
+    if (cqe->res > 0 && (size_t)cqe->res < conn->send_len && !conn->closing) {
+        conn->send_ptr += cqe->res;
+        conn->send_len -= (size_t)cqe->res;
+        uring_arm_send(ul, conn);
+        return;
+    }
+
+    if (conn->send_bid != URING_NO_BUFFER) {
+        uring_recycle_buffer(&ul->ring, conn->send_bid);
+        conn->send_bid = URING_NO_BUFFER;
+    }
+
+    if (cqe->res < 0) {
+        uring_conn_begin_close(ul, conn);
+        return;
+    }
+    uring_conn_send_next(ul, conn);
+}
+
+/**
+ * @brief Re-arm recv on connections that ran out of provided buffers
+ *
+ * Only called once a buffer has been recycled: re-arming with the ring
+ * still empty would just fail with ENOBUFS again.
+ */
+static void uring_rearm_starved(uring_loop_t *ul) {
+    uring_conn_t *conn = ul->starved;
+
+    ul->starved = NULL;
+    while (conn != NULL) {
+        uring_conn_t *next = conn->next_starved;
+        conn->next_starved = NULL;
+        if (!conn->closing && !conn->recv_armed) {
+            uring_arm_recv(ul, conn);
+        }
+        conn = next;
+    }
+}
+
+/**
+ * @brief Process every available completion
+ */
+static void uring_reap(uring_loop_t *ul) {
+    uring_t *ring = &ul->ring;
+    unsigned head = *ring->cq_head;
+    unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+
+    while (head != tail) {
+        const struct io_uring_cqe *cqe = &ring->cqes[head & ring->cq_mask];
+        uring_op_t op = (uring_op_t)(cqe->user_data & URING_OP_MASK);
+        uring_conn_t *conn = (uring_conn_t *)(uintptr_t)(cqe->user_data & ~(uint64_t)URING_OP_MASK);
+
+        switch (op) {
+            case URING_OP_ACCEPT:
+                uring_on_accept(ul, cqe);
+                break;
+            case URING_OP_RECV:
+                uring_on_recv(ul, conn, cqe);
+                break;
+            case URING_OP_SEND:
+                uring_on_send(ul, conn, cqe);
+                break;
+            case URING_OP_WAKEUP:
+                ul->running = false;
+                break;
+        }
+
+        if (conn != NULL && conn->closing && conn->inflight == 0) {
+            uring_conn_release(ul, conn);
+        }
+
+        head++;
+        /* Free the CQE slot before handlers queue more work */
+        __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+        if (head == tail) {
+            tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+        }
+    }
+
+    if (ul->starved != NULL && ring->buf_recycled) {
+        uring_rearm_starved(ul);
+    }
+    ring->buf_recycled = false;
+}
+
+/**
+ * @brief Serve all clients of one listener from an io_uring completion loop
+ *
+ * Uses the same event_loop_t as the epoll engine for the listener, wakeup
+ * descriptor and counters, so it slots into the worker pool unchanged.
+ * Connections still open at shutdown are closed after the ring is torn
+ * down, which cancels their outstanding operations.
+ *
+ * @return 0 on clean shutdown, -1 on error
+ */
+static int run_uring_loop(event_loop_t *loop) {
+    uring_loop_t ul;
+    int status = 0;
+
+    memset(&ul, 0, sizeof(ul));
+    ul.loop = loop;
+    ul.running = true;
+    loop->connections = NULL;
+    memset(&loop->stats, 0, sizeof(loop->stats));
+
+    if (uring_init(&ul.ring) < 0) {
+        return -1;
+    }
+
+    uring_arm_accept(&ul);
+    if (loop->wakeup_fd >= 0) {
+        struct io_uring_sqe *sqe = uring_get_sqe(&ul);
+        if (sqe != NULL) {
+            sqe->opcode = IORING_OP_POLL_ADD;
+            sqe->fd = loop->wakeup_fd;
+            sqe->poll32_events = POLLIN;
+            sqe->user_data = uring_tag(NULL, URING_OP_WAKEUP);
+        }
+    }
+
+    while (ul.running && !shutdown_requested) {
+        if (uring_submit(&ul, 1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EBUSY) {
+                perror("io_uring_enter");
+                status = -1;
+                break;
+            }
+        }
+        uring_reap(&ul);
+    }
+
+    unsigned long long still_open = loop->stats.active_connections;
+    uring_destroy(&ul.ring);
+    while (ul.connections != NULL) {
+        uring_conn_t *conn = ul.connections;
+        ul.connections = conn->next;
+        close(conn->fd);
+        free(conn);
+    }
+    loop->stats.active_connections = still_open;
+    return status;
+}
+#endif /* HAVE_IO_URING */
+
+/**
+ * @brief Worker thread: pin to a CPU and run an event loop on its listener
+ */
+static void *worker_main(void *arg) {
+    worker_t *worker = arg;
+    cpu_set_t cpus;
+
+    CPU_ZERO(&cpus);
+    CPU_SET(worker->cpu, &cpus);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0) {
+        fprintf(stderr, "Worker %d: could not pin to CPU %d\n", worker->id, worker->cpu);
+    }
+
+#if HAVE_IO_URING
+    if (worker->engine == ENGINE_URING) {
+        worker->status = run_uring_loop(&worker->loop);
+        return NULL;
+    }
+#endif
+    worker->status = run_event_loop(&worker->loop);
+    return NULL;
+}
+
+/**
+ * @brief Print one line of counters
+ */
+static void print_stats(const char *label, const server_stats_t *stats) {
+    printf("%-10s accepts=%llu bytes_in=%llu bytes_out=%llu active=%llu peak=%llu "
+           "syscalls=%llu\n",
+           label, stats->accepts, stats->bytes_in, stats->bytes_out,
+           stats->active_connections, stats->peak_connections, stats->syscalls);
+}
+
+/**
+ * @brief Run N pinned workers, each with its own SO_REUSEPORT listener
+ *
+ * SIGINT/SIGTERM are blocked before the workers start so only the main
+ * thread receives them via sigwait(); it then signals the shared eventfd,
+ * joins every worker and prints per-worker and combined counters.
+ *
+ * @return 0 on clean shutdown, -1 on error
+ */
+static int run_worker_pool(uint16_t port, int num_workers, server_engine_t engine) {
+    worker_t *workers;
+    server_stats_t total;
+    sigset_t shutdown_signals;
+    long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int wakeup_fd;
+    int started = 0;
+    int status = 0;
+    int signum;
+
+    if (num_cpus < 1) {
+        num_cpus = 1;
+    }
+
+    sigemptyset(&shutdown_signals);
+    sigaddset(&shutdown_signals, SIGINT);
+    sigaddset(&shutdown_signals, SIGTERM);
+    if (pthread_sigmask(SIG_BLOCK, &shutdown_signals, NULL) != 0) {
+        fprintf(stderr, "pthread_sigmask failed\n");
+        return -1;
+    }
+
+    wakeup_fd = eventfd(0, EFD_CLOEXEC);
+    if (wakeup_fd < 0) {
+        perror("eventfd");
+        return -1;
+    }
+
+    workers = aligned_alloc(CACHE_LINE_SIZE, sizeof(*workers) * (size_t)num_workers);
+    if (workers == NULL) {
+        perror("aligned_alloc");
+        close(wakeup_fd);
+        return -1;
+    }
+    memset(workers, 0, sizeof(*workers) * (size_t)num_workers);
+
+    for (started = 0; started < num_workers; started++) {
+        worker_t *worker = &workers[started];
+
+        worker->id = started;
+        worker->engine = engine;
+        worker->cpu = (int)(started % num_cpus);
+        worker->loop.wakeup_fd = wakeup_fd;
+        worker->loop.server_fd = create_server_socket(port, true);
+        if (worker->loop.server_fd < 0) {
+            status = -1;
+            break;
+        }
+
+        if (pthread_create(&worker->thread, NULL, worker_main, worker) != 0) {
+            fprintf(stderr, "pthread_create failed for worker %d\n", started);
+            close(worker->loop.server_fd);
+            status = -1;
+            break;
+        }
+    }
+
+    if (status == 0) {
+        printf("TCP server listening on port %u with %d workers\n", port, num_workers);
+        if (sigwait(&shutdown_signals, &signum) == 0) {
+            printf("Received signal %d, shutting down...\n", signum);
+        }
+    }
+
+    /* Wake every worker blocked in epoll_wait() */
+    shutdown_requested = 1;
+    if (eventfd_write(wakeup_fd, 1) < 0) {
+        perror("eventfd_write");
+    }
+
+    for (int i = 0; i < started; i++) {
+        pthread_join(workers[i].thread, NULL);
+        close(workers[i].loop.server_fd);
+        if (workers[i].status < 0) {
+            status = -1;
+        }
+    }
+
+    /* Flush worker log records before the summary */
+    net_log_shutdown();
+
+    memset(&total, 0, sizeof(total));
+    for (int i = 0; i < started; i++) {
+        char label[32];
+        const server_stats_t *stats = &workers[i].loop.stats;
+
+        snprintf(label, sizeof(label), "worker %d", i);
+        print_stats(label, stats);
+
+        total.accepts += stats->accepts;
+        total.bytes_in += stats->bytes_in;
+        total.bytes_out += stats->bytes_out;
+        total.active_connections += stats->active_connections;
+        total.peak_connections += stats->peak_connections;
+        total.syscalls += stats->syscalls;
+    }
+    print_stats("total", &total);
+
+    free(workers);
+    close(wakeup_fd);
+    return status;
+}
+
+/**
+ * @brief Original one-client-at-a-time accept loop
+ */
+static void run_blocking_server(int server_fd) {
+    int client_fd;
     struct sockaddr_in client_addr;
     socklen_t client_len;
+
+    while (!shutdown_requested) {
+        client_len = sizeof(client_addr);
+        client_fd = accept(server_fd, (struct sockaddr *)&client_addr, &client_len);
+        
+        if (client_fd < 0) {
+            if (errno != EINTR) {
+                perror("accept");
+            }
+            continue;
+        }
+        
+        /* Handle client (single-threaded for simplicity) */
+        handle_client(client_fd, &client_addr);
+        
+        /* Close client connection */
+        close(client_fd);
+    }
+}
+
+/**
+ * @brief Print command line usage
+ */
+static void print_usage(const char *program) {
+    fprintf(stderr, "Usage: %s [--engine epoll|uring|blocking] [--workers N] <port>\n",
+            program);
+}
+
+/**
+ * @brief Main server loop
+ */
+int main(int argc, char *argv[]) {
+    int server_fd;
     uint16_t port;
+    server_engine_t engine = ENGINE_EPOLL;
+    int num_workers = 0;
+    int status = EXIT_SUCCESS;
+    int argi;
     
     /* Parse command line arguments */
-    if (argc != 2) {
-        fprintf(stderr, "Usage: %s <port>\n", argv[0]);
+    for (argi = 1; argi + 1 < argc; argi += 2) {
+        if (strcmp(argv[argi], "--engine") == 0) {
+            if (strcmp(argv[argi + 1], "epoll") == 0) {
+                engine = ENGINE_EPOLL;
+            } else if (strcmp(argv[argi + 1], "uring") == 0) {
+#if HAVE_IO_URING
+                engine = ENGINE_URING;
+#else
+                fprintf(stderr, "io_uring engine not available in this build\n");
+                return EXIT_FAILURE;
+#endif
+            } else if (strcmp(argv[argi + 1], "blocking") == 0) {
+                engine = ENGINE_BLOCKING;
+            } else {
+                fprintf(stderr, "Unknown engine: %s\n", argv[argi + 1]);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[argi], "--workers") == 0) {
+            num_workers = atoi(argv[argi + 1]);
+            if (num_workers < 1 || num_workers > MAX_WORKERS) {
+                fprintf(stderr, "Worker count must be 1-%d\n", MAX_WORKERS);
+                return EXIT_FAILURE;
+            }
+        } else {
+            break;
+        }
+    }
+    
+    if (argi != argc - 1) {
+        print_usage(argv[0]);
         return EXIT_FAILURE;
     }
     
-    port = (uint16_t)atoi(argv[1]);
+    if (num_workers > 0 && engine == ENGINE_BLOCKING) {
+        fprintf(stderr, "--workers requires the epoll or uring engine\n");
+        return EXIT_FAILURE;
+    }
+    
+    port = (uint16_t)atoi(argv[argi]);
     if (port == 0) {
         fprintf(stderr, "Invalid port number\n");
         return EXIT_FAILURE;
     }
     
+    if (install_shutdown_handlers() < 0) {
+        return EXIT_FAILURE;
+    }
+    
+    net_log_init(NET_LOG_INFO, 1);
+    
+    if (num_workers > 0) {
+        return (run_worker_pool(port, num_workers, engine) < 0) ? EXIT_FAILURE
+                                                                : EXIT_SUCCESS;
+    }
+    
     /* Create server socket */
-    server_fd = create_server_socket(port);
+    server_fd = create_server_socket(port, false);
     if (server_fd < 0) {
         return EXIT_FAILURE;
     }
     
-    printf("Server started. Press Ctrl+C to stop.\n");
+    printf("Server started (%s engine). Press Ctrl+C to stop.\n",
+           engine == ENGINE_EPOLL ? "epoll" :
+           engine == ENGINE_URING ? "uring" : "blocking");
     
-    /* Accept connections */
-    while (1) {
-        client_len = sizeof(client_addr);
-        client_fd = accept(server_fd, (struct sockaddr *)&client_addr, &client_len);
-        
-        if (client_fd < 0) {
-            perror("accept");
-            continue;
+    if (engine != ENGINE_BLOCKING) {
+        event_loop_t loop;
+        int result;
+
+        memset(&loop, 0, sizeof(loop));
+        loop.server_fd = server_fd;
+        loop.wakeup_fd = -1;
+#if HAVE_IO_URING
+        result = (engine == ENGINE_URING) ? run_uring_loop(&loop) : run_event_loop(&loop);
+#else
+        result = run_event_loop(&loop);
+#endif
+        if (result < 0) {
+            status = EXIT_FAILURE;
         }
-        
-        /* Handle client (single-threaded for simplicity) */
-        handle_client(client_fd, &client_addr);
-        
-        /* Close client connection */
-        close(client_fd);
+        net_log_shutdown();
+        print_stats("total", &loop.stats);
+    } else {
+        run_blocking_server(server_fd);
     }
     
     /* Cleanup */
+    net_log_shutdown();
     close(server_fd);
-    return EXIT_SUCCESS;
+    return status;
 }
-
@@ -7,32 +7,136 @@
  * - Sending multicast packets
  * - Receiving multicast packets
  * - Socket options for multicast
+ * - Batched I/O with recvmmsg()/sendmmsg()
+ * - UDP segmentation offload (UDP_SEGMENT) and receive coalescing (UDP_GRO)
+ * - Packet rate and kernel drop reporting (SO_RXQ_OVFL)
  * - Error handling
  * 
- * Compile: gcc -Wall -Wextra -std=c11 -o udp-multicast udp-multicast.c
+ * Per-datagram output goes through net-log (sampled, off the data path);
+ * set NET_LOG_LEVEL=debug NET_LOG_SAMPLE=N to see 1 in N datagrams.
+ * 
+ * Compile: gcc -Wall -Wextra -std=c11 -pthread -o udp-multicast udp-multicast.c net-log.c
  * Run sender: ./udp-multicast send 239.0.0.1 5000
  * Run receiver: ./udp-multicast recv 239.0.0.1 5000
+ * Burst sender: ./udp-multicast --batch 64 --interval 1 --gso 256 send 239.0.0.1 5000
+ * Batched receiver: ./udp-multicast --batch 64 --gro --rcvbuf 8388608 recv 239.0.0.1 5000
  */
 
+#define _GNU_SOURCE  /* inet_aton, ip_mreq, recvmmsg, sendmmsg */
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <unistd.h>
 #include <errno.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/time.h>
 #include <netinet/in.h>
+#include <netinet/udp.h>
 #include <arpa/inet.h>
 #include <time.h>
 
+#include "net-log.h"
+
 #define BUFFER_SIZE 1024
 #define MULTICAST_TTL 32
+#define MAX_BATCH 1024              /* Datagrams per recvmmsg()/sendmmsg() */
+#define GRO_BUFFER_SIZE 65536       /* A coalesced UDP_GRO read can be this large */
+#define GSO_MAX_SEGMENTS 64         /* Kernel limit on segments per UDP_SEGMENT send */
+#define GSO_MAX_BYTES 65000         /* Stay under the 64 KiB IP datagram limit */
+
+/* Linux socket options missing from older libc headers */
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+/* Command line options shared by sender and receiver */
+typedef struct {
+    unsigned batch;                 /* Datagrams per syscall (1 = one at a time) */
+    unsigned interval_ms;           /* Sender pause between bursts */
+    int gso_size;                   /* Sender UDP_SEGMENT size, 0 = off */
+    bool gro;                       /* Receiver UDP_GRO */
+    int rcvbuf;                     /* Receiver SO_RCVBUF request, 0 = default */
+} mcast_options_t;
+
+/* Counters reported once per second */
+typedef struct {
+    unsigned long long packets;
+    unsigned long long bytes;
+    unsigned long long syscalls;
+    unsigned long long truncated;   /* Datagrams larger than the slot */
+    uint32_t drops;                 /* Cumulative SO_RXQ_OVFL count */
+    unsigned long long last_packets;
+    unsigned long long last_bytes;
+    uint32_t last_drops;
+    struct timespec last_report;
+} mcast_stats_t;
+
+/* Ancillary data space for one received datagram */
+typedef union {
+    char buf[CMSG_SPACE(sizeof(uint32_t)) + CMSG_SPACE(sizeof(int))];
+    struct cmsghdr align;
+} mcast_control_t;
+
+/**
+ * @brief Seconds elapsed between two CLOCK_MONOTONIC readings
+ */
+static double elapsed_seconds(const struct timespec *from, const struct timespec *to) {
+    return (double)(to->tv_sec - from->tv_sec) +
+           (double)(to->tv_nsec - from->tv_nsec) / 1e9;
+}
+
+/**
+ * @brief Start the reporting interval
+ */
+static void stats_init(mcast_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    clock_gettime(CLOCK_MONOTONIC, &stats->last_report);
+}
+
+/**
+ * @brief Print rates for the last interval if a second has passed
+ * 
+ * Drops are datagrams the kernel discarded because the socket receive
+ * queue was full: raise SO_RCVBUF (--rcvbuf) until they stay at zero.
+ */
+static void stats_report(mcast_stats_t *stats, const char *role) {
+    struct timespec now;
+    
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double seconds = elapsed_seconds(&stats->last_report, &now);
+    if (seconds < 1.0) {
+        return;
+    }
+    
+    /* Stay quiet while the feed is idle */
+    if (stats->packets != stats->last_packets) {
+        NET_LOG(NET_LOG_INFO,
+                "%s: %.0f pkt/s %.1f MB/s syscalls=%llu drops=%u (+%u) truncated=%llu",
+                role, (double)(stats->packets - stats->last_packets) / seconds,
+                (double)(stats->bytes - stats->last_bytes) / seconds / 1e6,
+                stats->syscalls, stats->drops, stats->drops - stats->last_drops,
+                stats->truncated);
+    }
+    
+    stats->last_packets = stats->packets;
+    stats->last_bytes = stats->bytes;
+    stats->last_drops = stats->drops;
+    stats->last_report = now;
+}
 
 /**
  * @brief Create multicast sender socket
  */
 static int create_multicast_sender(const char *group_addr, uint16_t port,
-                                   struct sockaddr_in *dest_addr) {
+                                   struct sockaddr_in *dest_addr,
+                                   const mcast_options_t *opts) {
     int sockfd;
     unsigned char ttl = MULTICAST_TTL;
     
@@ -50,6 +154,15 @@ static int create_multicast_sender(const char *group_addr, uint16_t port,
         return -1;
     }
     
+    /* Let the kernel (or NIC) split each large send into gso_size datagrams */
+    if (opts->gso_size > 0 &&
+        setsockopt(sockfd, IPPROTO_UDP, UDP_SEGMENT, &opts->gso_size,
+                   sizeof(opts->gso_size)) < 0) {
+        perror("setsockopt(UDP_SEGMENT)");
+        close(sockfd);
+        return -1;
+    }
+    
     /* Setup destination address */
     memset(dest_addr, 0, sizeof(*dest_addr));
     dest_addr->sin_family = AF_INET;
@@ -67,11 +180,16 @@ static int create_multicast_sender(const char *group_addr, uint16_t port,
 /**
  * @brief Create multicast receiver socket
  */
-static int create_multicast_receiver(const char *group_addr, uint16_t port) {
+static int create_multicast_receiver(const char *group_addr, uint16_t port,
+                                     const mcast_options_t *opts) {
     int sockfd;
     struct sockaddr_in local_addr;
     struct ip_mreq mreq;
+    struct timeval timeout = { .tv_sec = 1, .tv_usec = 0 };
     int reuse = 1;
+    int on = 1;
+    int rcvbuf = 0;
+    socklen_t optlen = sizeof(rcvbuf);
     
     /* Create UDP socket */
     sockfd = socket(AF_INET, SOCK_DGRAM, 0);
@@ -87,6 +205,36 @@ static int create_multicast_receiver(const char *group_addr, uint16_t port) {
         return -1;
     }
     
+    /* A bigger receive queue absorbs bursts while the application is busy */
+    if (opts->rcvbuf > 0 &&
+        setsockopt(sockfd, SOL_SOCKET, SO_RCVBUF, &opts->rcvbuf, sizeof(opts->rcvbuf)) < 0) {
+        perror("setsockopt(SO_RCVBUF)");
+        close(sockfd);
+        return -1;
+    }
+    
+    /* Deliver the queue-overflow drop count with every datagram */
+    if (setsockopt(sockfd, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on)) < 0) {
+        perror("setsockopt(SO_RXQ_OVFL)");
+        close(sockfd);
+        return -1;
+    }
+    
+    /* Coalesce same-flow datagrams into one large read */
+    if (opts->gro &&
+        setsockopt(sockfd, IPPROTO_UDP, UDP_GRO, &on, sizeof(on)) < 0) {
+        perror("setsockopt(UDP_GRO)");
+        close(sockfd);
+        return -1;
+    }
+    
+    /* Wake up at least once a second so rates are reported when idle */
+    if (setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) < 0) {
+        perror("setsockopt(SO_RCVTIMEO)");
+        close(sockfd);
+        return -1;
+    }
+    
     /* Bind to multicast port */
     memset(&local_addr, 0, sizeof(local_addr));
     local_addr.sin_family = AF_INET;
@@ -114,64 +262,238 @@ static int create_multicast_receiver(const char *group_addr, uint16_t port) {
         return -1;
     }
     
-    printf("Multicast receiver joined group %s:%u\n", group_addr, port);
+    /* The kernel doubles the request for bookkeeping; show what we got */
+    getsockopt(sockfd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, &optlen);
+    printf("Multicast receiver joined group %s:%u (SO_RCVBUF %d bytes)\n",
+           group_addr, port, rcvbuf);
     return sockfd;
 }
 
 /**
  * @brief Run multicast sender
+ * 
+ * Each burst of opts->batch datagrams goes out with as few sendmmsg()
+ * calls as possible. With UDP_SEGMENT, every datagram is padded to
+ * gso_size and up to GSO_MAX_SEGMENTS of them share one sendmmsg() entry,
+ * so the stack is traversed once per group instead of once per datagram.
  */
-static void run_sender(int sockfd, struct sockaddr_in *dest_addr) {
-    char buffer[BUFFER_SIZE];
-    int count = 0;
+static void run_sender(int sockfd, struct sockaddr_in *dest_addr,
+                       const mcast_options_t *opts) {
+    unsigned batch = opts->batch;
+    size_t slot_size = (opts->gso_size > 0) ? (size_t)opts->gso_size : BUFFER_SIZE;
+    unsigned per_entry = 1;
+    unsigned count = 0;
+    mcast_stats_t stats;
     
-    printf("Sending multicast messages (Ctrl+C to stop)...\n");
+    if (opts->gso_size > 0) {
+        per_entry = GSO_MAX_BYTES / (unsigned)opts->gso_size;
+        if (per_entry > GSO_MAX_SEGMENTS) {
+            per_entry = GSO_MAX_SEGMENTS;
+        }
+    }
+    unsigned entries = (batch + per_entry - 1) / per_entry;
+    
+    char *buffer = malloc((size_t)batch * slot_size);
+    struct mmsghdr *msgs = calloc(entries, sizeof(*msgs));
+    struct iovec *iov = calloc(entries, sizeof(*iov));
+    if (buffer == NULL || msgs == NULL || iov == NULL) {
+        perror("malloc");
+        goto out;
+    }
+    
+    printf("Sending multicast messages in bursts of %u (Ctrl+C to stop)...\n", batch);
+    stats_init(&stats);
     
     while (1) {
-        /* Create message with timestamp */
+        /* Create messages with one timestamp per burst */
         time_t now = time(NULL);
-        snprintf(buffer, sizeof(buffer), 
-                "Multicast message #%d at %s", count++, ctime(&now));
+        char stamp[32];
+        ctime_r(&now, stamp);
+        stamp[strcspn(stamp, "\n")] = '\0';
+        size_t burst_bytes = 0;
         
-        /* Send multicast packet */
-        ssize_t sent = sendto(sockfd, buffer, strlen(buffer), 0,
-                             (struct sockaddr *)dest_addr, sizeof(*dest_addr));
-        if (sent < 0) {
-            perror("sendto");
-            break;
+        for (unsigned i = 0; i < batch; i++) {
+            char *slot = buffer + (size_t)i * slot_size;
+            int len = snprintf(slot, slot_size, "Multicast message #%u at %s", count++, stamp);
+            size_t used = (len < 0) ? 0 : ((size_t)len < slot_size ? (size_t)len : slot_size - 1);
+            
+            if (opts->gso_size > 0) {
+                /* GSO needs equal-sized segments */
+                memset(slot + used, 0, slot_size - used);
+                used = slot_size;
+            }
+            if (per_entry == 1) {
+                iov[i].iov_base = slot;
+                iov[i].iov_len = used;
+            }
+            burst_bytes += used;
         }
         
-        printf("Sent: %s", buffer);
-        sleep(2);  /* Send every 2 seconds */
+        for (unsigned e = 0; e < entries; e++) {
+            if (per_entry > 1) {
+                unsigned first = e * per_entry;
+                unsigned segments = (batch - first < per_entry) ? batch - first : per_entry;
+                iov[e].iov_base = buffer + (size_t)first * slot_size;
+                iov[e].iov_len = (size_t)segments * slot_size;
+            }
+            memset(&msgs[e].msg_hdr, 0, sizeof(msgs[e].msg_hdr));
+            msgs[e].msg_hdr.msg_name = dest_addr;
+            msgs[e].msg_hdr.msg_namelen = sizeof(*dest_addr);
+            msgs[e].msg_hdr.msg_iov = &iov[e];
+            msgs[e].msg_hdr.msg_iovlen = 1;
+        }
+        
+        /* Send multicast packets; sendmmsg() may stop short */
+        unsigned sent = 0;
+        while (sent < entries) {
+            int n = sendmmsg(sockfd, msgs + sent, entries - sent, 0);
+            stats.syscalls++;
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                perror("sendmmsg");
+                goto out;
+            }
+            sent += (unsigned)n;
+        }
+        stats.packets += batch;
+        stats.bytes += burst_bytes;
+        
+        /* Fast bursts only log at debug level */
+        NET_LOG(opts->interval_ms >= 1000 ? NET_LOG_INFO : NET_LOG_DEBUG,
+                "Sent: %s", buffer);
+        stats_report(&stats, "send");
+        
+        if (opts->interval_ms > 0) {
+            struct timespec pause = {
+                .tv_sec = opts->interval_ms / 1000,
+                .tv_nsec = (long)(opts->interval_ms % 1000) * 1000000L
+            };
+            nanosleep(&pause, NULL);
+        }
     }
+
+out:
+    free(iov);
+    free(msgs);
+    free(buffer);
+}
+
+/**
+ * @brief Account one received slot and log it if sampled
+ * 
+ * With UDP_GRO a slot may hold several coalesced datagrams; the UDP_GRO
+ * control message carries the segment size needed to count them.
+ */
+static void receiver_account(mcast_stats_t *stats, struct mmsghdr *msg,
+                             const char *data, const struct sockaddr_in *sender) {
+    char sender_ip[INET_ADDRSTRLEN];
+    size_t len = msg->msg_len;
+    unsigned long long packets = 1;
+    
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg->msg_hdr); cmsg != NULL;
+         cmsg = CMSG_NXTHDR(&msg->msg_hdr, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+            memcpy(&stats->drops, CMSG_DATA(cmsg), sizeof(stats->drops));
+        } else if (cmsg->cmsg_level == IPPROTO_UDP && cmsg->cmsg_type == UDP_GRO) {
+            int segment;
+            memcpy(&segment, CMSG_DATA(cmsg), sizeof(segment));
+            if (segment > 0) {
+                packets = (len + (size_t)segment - 1) / (size_t)segment;
+            }
+        }
+    }
+    if (msg->msg_hdr.msg_flags & MSG_TRUNC) {
+        stats->truncated++;
+    }
+    
+    stats->packets += packets;
+    stats->bytes += len;
+    
+    /* Format (and run the reentrant inet_ntop) only for sampled records */
+    NET_LOG_SAMPLED(NET_LOG_DEBUG, "Received from %s:%u: %.*s",
+                    inet_ntop(AF_INET, &sender->sin_addr, sender_ip, sizeof(sender_ip)),
+                    ntohs(sender->sin_port), (int)strnlen(data, len), data);
 }
 
 /**
  * @brief Run multicast receiver
+ * 
+ * Receives up to opts->batch datagrams per recvmmsg() into preallocated
+ * slots. MSG_WAITFORONE blocks for the first datagram only, so a quiet
+ * feed costs one syscall per datagram and a busy one amortises it.
  */
-static void run_receiver(int sockfd) {
-    char buffer[BUFFER_SIZE];
-    struct sockaddr_in sender_addr;
-    socklen_t sender_len;
+static void run_receiver(int sockfd, const mcast_options_t *opts) {
+    unsigned batch = opts->batch;
+    size_t slot_size = opts->gro ? GRO_BUFFER_SIZE : BUFFER_SIZE;
+    mcast_stats_t stats;
+    
+    char *buffers = malloc((size_t)batch * slot_size);
+    struct mmsghdr *msgs = calloc(batch, sizeof(*msgs));
+    struct iovec *iov = calloc(batch, sizeof(*iov));
+    struct sockaddr_in *senders = calloc(batch, sizeof(*senders));
+    mcast_control_t *controls = calloc(batch, sizeof(*controls));
+    if (buffers == NULL || msgs == NULL || iov == NULL ||
+        senders == NULL || controls == NULL) {
+        perror("malloc");
+        goto out;
+    }
+    
+    for (unsigned i = 0; i < batch; i++) {
+        iov[i].iov_base = buffers + (size_t)i * slot_size;
+        iov[i].iov_len = slot_size;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = &senders[i];
+        msgs[i].msg_hdr.msg_control = controls[i].buf;
+    }
     
-    printf("Receiving multicast messages (Ctrl+C to stop)...\n");
+    printf("Receiving multicast messages %u per call (Ctrl+C to stop)...\n", batch);
+    stats_init(&stats);
     
     while (1) {
-        sender_len = sizeof(sender_addr);
-        ssize_t received = recvfrom(sockfd, buffer, sizeof(buffer) - 1, 0,
-                                   (struct sockaddr *)&sender_addr, &sender_len);
+        /* The kernel overwrites these lengths on every receive */
+        for (unsigned i = 0; i < batch; i++) {
+            msgs[i].msg_hdr.msg_namelen = sizeof(senders[i]);
+            msgs[i].msg_hdr.msg_controllen = sizeof(controls[i].buf);
+        }
+        
+        int received = recvmmsg(sockfd, msgs, batch, MSG_WAITFORONE, NULL);
+        stats.syscalls++;
         
         if (received < 0) {
-            perror("recvfrom");
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                stats_report(&stats, "recv");
+                continue;
+            }
+            perror("recvmmsg");
             break;
         }
         
-        buffer[received] = '\0';
-        printf("Received from %s:%u: %s",
-               inet_ntoa(sender_addr.sin_addr),
-               ntohs(sender_addr.sin_port),
-               buffer);
+        for (int i = 0; i < received; i++) {
+            receiver_account(&stats, &msgs[i], iov[i].iov_base, &senders[i]);
+        }
+        stats_report(&stats, "recv");
     }
+
+out:
+    free(controls);
+    free(senders);
+    free(iov);
+    free(msgs);
+    free(buffers);
+}
+
+/**
+ * @brief Print command line help
+ */
+static void print_usage(const char *program) {
+    fprintf(stderr, "Usage: %s [--batch N] [--interval MS] [--gso SIZE] [--gro] "
+            "[--rcvbuf BYTES] <send|recv> <multicast_addr> <port>\n", program);
+    fprintf(stderr, "Example: %s send 239.0.0.1 5000\n", program);
+    fprintf(stderr, "         %s recv 239.0.0.1 5000\n", program);
+    fprintf(stderr, "         %s --batch 64 --interval 1 send 239.0.0.1 5000\n", program);
 }
 
 /**
@@ -181,40 +503,84 @@ int main(int argc, char *argv[]) {
     int sockfd;
     const char *mode, *group_addr;
     uint16_t port;
+    mcast_options_t opts = { .batch = 1, .interval_ms = 2000 };
+    int argi;
+    
+    /* Parse options */
+    for (argi = 1; argi < argc && strncmp(argv[argi], "--", 2) == 0; argi++) {
+        if (strcmp(argv[argi], "--gro") == 0) {
+            opts.gro = true;
+            continue;
+        }
+        if (argi + 1 >= argc) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        if (strcmp(argv[argi], "--batch") == 0) {
+            int batch = atoi(argv[++argi]);
+            if (batch < 1 || batch > MAX_BATCH) {
+                fprintf(stderr, "Batch size must be 1-%d\n", MAX_BATCH);
+                return EXIT_FAILURE;
+            }
+            opts.batch = (unsigned)batch;
+        } else if (strcmp(argv[argi], "--interval") == 0) {
+            int interval = atoi(argv[++argi]);
+            if (interval < 0) {
+                fprintf(stderr, "Interval must not be negative\n");
+                return EXIT_FAILURE;
+            }
+            opts.interval_ms = (unsigned)interval;
+        } else if (strcmp(argv[argi], "--gso") == 0) {
+            opts.gso_size = atoi(argv[++argi]);
+            if (opts.gso_size < 64 || opts.gso_size > BUFFER_SIZE) {
+                fprintf(stderr, "GSO segment size must be 64-%d\n", BUFFER_SIZE);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[argi], "--rcvbuf") == 0) {
+            opts.rcvbuf = atoi(argv[++argi]);
+            if (opts.rcvbuf <= 0) {
+                fprintf(stderr, "Invalid receive buffer size\n");
+                return EXIT_FAILURE;
+            }
+        } else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
     
     /* Parse arguments */
-    if (argc != 4) {
-        fprintf(stderr, "Usage: %s <send|recv> <multicast_addr> <port>\n", argv[0]);
-        fprintf(stderr, "Example: %s send 239.0.0.1 5000\n", argv[0]);
-        fprintf(stderr, "         %s recv 239.0.0.1 5000\n", argv[0]);
+    if (argc - argi != 3) {
+        print_usage(argv[0]);
         return EXIT_FAILURE;
     }
     
-    mode = argv[1];
-    group_addr = argv[2];
-    port = (uint16_t)atoi(argv[3]);
+    mode = argv[argi];
+    group_addr = argv[argi + 1];
+    port = (uint16_t)atoi(argv[argi + 2]);
+    
+    net_log_init(NET_LOG_INFO, 1);
     
     if (strcmp(mode, "send") == 0) {
         /* Sender mode */
         struct sockaddr_in dest_addr;
-        sockfd = create_multicast_sender(group_addr, port, &dest_addr);
+        sockfd = create_multicast_sender(group_addr, port, &dest_addr, &opts);
         if (sockfd < 0) {
             return EXIT_FAILURE;
         }
-        run_sender(sockfd, &dest_addr);
+        run_sender(sockfd, &dest_addr, &opts);
     } else if (strcmp(mode, "recv") == 0) {
         /* Receiver mode */
-        sockfd = create_multicast_receiver(group_addr, port);
+        sockfd = create_multicast_receiver(group_addr, port, &opts);
         if (sockfd < 0) {
             return EXIT_FAILURE;
         }
-        run_receiver(sockfd);
+        run_receiver(sockfd, &opts);
     } else {
         fprintf(stderr, "Invalid mode: %s (use 'send' or 'recv')\n", mode);
         return EXIT_FAILURE;
     }
     
+    net_log_shutdown();
     close(sockfd);
     return EXIT_SUCCESS;
 }
-
@@ -8,11 +8,17 @@
  * - Deadline miss detection
  * - Worst-case execution time (WCET) tracking
  * - Task timing statistics
+ * - Cycle-accurate timestamps and p50/p99/p99.9 histograms (task-monitor.h)
+ * - Release jitter tracking
  * 
  * Compatible with: FreeRTOS, Zephyr RTOS, or POSIX real-time
  * Build: See README.md for RTOS-specific instructions
  */
 
+#ifndef USE_FREERTOS
+#define _GNU_SOURCE     /* CLOCK_MONOTONIC_RAW */
+#endif
+
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -24,93 +30,16 @@
 #include "timers.h"
 #endif
 
+#include "task-monitor.h"
+
 /* Task timing constraints */
 #define TASK_PERIOD_MS          100
 #define TASK_DEADLINE_MS        80
 #define TASK_WCET_MS            50
 
-/* Statistics tracking */
-typedef struct {
-    uint32_t executions;
-    uint32_t deadline_misses;
-    uint32_t min_execution_time_us;
-    uint32_t max_execution_time_us;
-    uint32_t total_execution_time_us;
-} task_stats_t;
-
-static task_stats_t task_stats = {0};
-
-/**
- * @brief Get current time in microseconds
- * @return Current time in microseconds
- */
-static inline uint32_t get_time_us(void)
-{
-#ifdef USE_FREERTOS
-    return (uint32_t)(xTaskGetTickCount() * 1000 / configTICK_RATE_HZ);
-#else
-    /* Platform-specific implementation */
-    return 0;  /* Placeholder */
-#endif
-}
-
-/**
- * @brief Initialize task statistics
- */
-static void init_task_stats(task_stats_t *stats)
-{
-    memset(stats, 0, sizeof(task_stats_t));
-    stats->min_execution_time_us = UINT32_MAX;
-}
-
-/**
- * @brief Update task statistics
- * @param stats Statistics structure
- * @param execution_time_us Execution time in microseconds
- * @param deadline_met Whether deadline was met
- */
-static void update_task_stats(task_stats_t *stats,
-                              uint32_t execution_time_us,
-                              bool deadline_met)
-{
-    stats->executions++;
-    stats->total_execution_time_us += execution_time_us;
-    
-    if (execution_time_us < stats->min_execution_time_us) {
-        stats->min_execution_time_us = execution_time_us;
-    }
-    
-    if (execution_time_us > stats->max_execution_time_us) {
-        stats->max_execution_time_us = execution_time_us;
-    }
-    
-    if (!deadline_met) {
-        stats->deadline_misses++;
-    }
-}
-
-/**
- * @brief Print task statistics
- */
-static void print_task_stats(const task_stats_t *stats)
-{
-    if (stats->executions == 0) {
-        printf("No executions yet\n");
-        return;
-    }
-    
-    uint32_t avg_time = stats->total_execution_time_us / stats->executions;
-    float miss_rate = (float)stats->deadline_misses / stats->executions * 100.0f;
-    
-    printf("\n=== Task Statistics ===\n");
-    printf("Executions:      %u\n", (unsigned int)stats->executions);
-    printf("Deadline misses: %u (%.2f%%)\n", 
-           (unsigned int)stats->deadline_misses, miss_rate);
-    printf("Min exec time:   %u us\n", (unsigned int)stats->min_execution_time_us);
-    printf("Max exec time:   %u us\n", (unsigned int)stats->max_execution_time_us);
-    printf("Avg exec time:   %u us\n", (unsigned int)avg_time);
-    printf("======================\n\n");
-}
+/* Statistics tracking; the snapshot is large, so it is not on the task stack */
+static task_stats_t task_stats;
+static task_stats_snapshot_t task_stats_report;
 
 /**
  * @brief Simulate task workload
@@ -118,10 +47,10 @@ static void print_task_stats(const task_stats_t *stats)
  */
 static void simulate_workload(uint32_t workload_us)
 {
-    uint32_t start = get_time_us();
+    monitor_time_t start = monitor_now();
     
     /* Busy-wait to simulate work */
-    while ((get_time_us() - start) < workload_us) {
+    while (monitor_elapsed_ns(start, monitor_now()) < workload_us * 1000U) {
         /* Simulate computation */
         volatile uint32_t dummy = 0;
         for (int i = 0; i < 100; i++) {
@@ -144,7 +73,7 @@ void deadline_monitored_task(void *params)
     
     (void)params;
     
-    init_task_stats(&task_stats);
+    task_stats_init(&task_stats, "DeadlineTask", TASK_PERIOD_MS * 1000, deadline_us);
     last_wake_time = xTaskGetTickCount();
     
     printf("Deadline-monitored task started\n");
@@ -155,9 +84,9 @@ void deadline_monitored_task(void *params)
         /* Wait for next period */
         vTaskDelayUntil(&last_wake_time, period);
         
-        /* Record start time */
-        uint32_t start_time = get_time_us();
-        TickType_t release_time = xTaskGetTickCount();
+        /* Record start time; its spacing from the last start is the jitter */
+        monitor_time_t start_time = monitor_now();
+        task_stats_release(&task_stats, start_time);
         
         /* Perform task work */
         /* Vary workload to demonstrate deadline monitoring */
@@ -173,26 +102,22 @@ void deadline_monitored_task(void *params)
         simulate_workload(workload_us);
         
         /* Record end time */
-        uint32_t end_time = get_time_us();
-        uint32_t execution_time_us = end_time - start_time;
-        
-        /* Check deadline */
-        bool deadline_met = (execution_time_us <= deadline_us);
+        uint32_t execution_time_ns = monitor_elapsed_ns(start_time, monitor_now());
         
-        /* Update statistics */
-        update_task_stats(&task_stats, execution_time_us, deadline_met);
+        /* Update statistics and check deadline: O(1), no locks */
+        bool deadline_met = task_stats_complete(&task_stats, execution_time_ns);
         
         /* Log deadline miss */
         if (!deadline_met) {
             printf("DEADLINE MISS! Iteration %u: %u us (deadline: %u us)\n",
                    (unsigned int)iteration,
-                   (unsigned int)execution_time_us,
+                   (unsigned int)(execution_time_ns / 1000U),
                    (unsigned int)deadline_us);
         }
         
         /* Print statistics every 20 iterations */
         if (iteration % 20 == 0 && iteration > 0) {
-            print_task_stats(&task_stats);
+            task_stats_print(&task_stats, &task_stats_report);
         }
         
         iteration++;
@@ -0,0 +1,348 @@
+/**
+ * @file lockfree-bench.c
+ * @brief Host benchmark: high-priority update latency, mutex vs. lock-free
+ * 
+ * Recreates the shared state of priority-scheduling.c with POSIX threads
+ * pinned to one CPU, like a single-core MCU:
+ * - High:   every 1 ms, bumps the counter and publishes the control state
+ * - Medium: CPU hog, busy two thirds of the time; never touches the shared state
+ * - Low:    reads the state and works on it inside its read section
+ * 
+ * Three ways to share the state:
+ * - mutex:    plain mutex; Medium can preempt Low while High waits
+ *             (unbounded priority inversion)
+ * - mutex-pi: PTHREAD_PRIO_INHERIT, what FreeRTOS mutexes do; High still
+ *             waits for the rest of Low's critical section
+ * - lockfree: lockfree.h counter and seqlock; High never waits
+ * 
+ * Reports p50/p99/p99.9/max of High's update section, which is where a
+ * mutex makes it wait.
+ * 
+ * Build: make bench
+ * Run:   sudo ./lockfree-bench [seconds per mode]
+ *        SCHED_FIFO needs CAP_SYS_NICE; without it the benchmark runs
+ *        under the default policy and says so.
+ */
+
+#define _GNU_SOURCE     /* sched_setaffinity, CLOCK_MONOTONIC_RAW */
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "task-monitor.h"
+#include "../common/lockfree.h"
+
+#define HIGH_PERIOD_US      1000
+#define MEDIUM_BUSY_US      2000
+#define MEDIUM_IDLE_US      1000
+#define LOW_SECTION_US      200
+#define LOW_IDLE_US         200
+
+#define PRIORITY_HIGH       30
+#define PRIORITY_MEDIUM     20
+#define PRIORITY_LOW        10
+#define PRIORITY_MAIN       40
+
+#define DEFAULT_SECONDS     3
+
+typedef enum {
+    MODE_MUTEX,
+    MODE_MUTEX_PI,
+    MODE_LOCKFREE,
+    MODE_COUNT
+} bench_mode_t;
+
+static const char *const mode_names[MODE_COUNT] = { "mutex", "mutex-pi", "lockfree" };
+
+typedef struct {
+    uint32_t sequence;
+    uint32_t input;
+    uint32_t output;
+} control_state_t;
+
+static bench_mode_t mode;
+static atomic_bool stop;
+static bool realtime = true;
+
+/* Mutex modes */
+static pthread_mutex_t state_mutex;
+static uint32_t locked_counter;
+
+/* Lock-free mode */
+static lf_counter_t shared_counter;
+static lf_seqlock_t control_lock;
+
+static control_state_t control_state;
+
+/* Written by the high thread only, read after it has been joined */
+static latency_hist_t update_hist;
+static uint32_t update_max_ns;
+static uint64_t updates;
+
+/* Keeps the low thread's work from being optimized away */
+static volatile uint32_t low_sink;
+
+/**
+ * @brief Busy-wait, like the simulated work in priority-scheduling.c
+ */
+static void spin_us(uint32_t us)
+{
+    monitor_time_t start = monitor_now();
+    
+    while (monitor_elapsed_ns(start, monitor_now()) < us * 1000U) {
+        /* Spin */
+    }
+}
+
+static void timespec_add_us(struct timespec *ts, uint32_t us)
+{
+    ts->tv_nsec += (long)us * 1000L;
+    while (ts->tv_nsec >= 1000000000L) {
+        ts->tv_nsec -= 1000000000L;
+        ts->tv_sec++;
+    }
+}
+
+static void sleep_us(uint32_t us)
+{
+    struct timespec ts = { .tv_sec = us / 1000000U, .tv_nsec = (long)(us % 1000000U) * 1000L };
+    
+    nanosleep(&ts, NULL);
+}
+
+/**
+ * @brief High priority: periodic update of the shared state
+ */
+static void *high_thread(void *arg)
+{
+    struct timespec next;
+    
+    (void)arg;
+    
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (!atomic_load_explicit(&stop, memory_order_relaxed)) {
+        timespec_add_us(&next, HIGH_PERIOD_US);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+        
+        monitor_time_t start = monitor_now();
+        uint32_t input = (uint32_t)start & 0xFFFU;
+        
+        if (mode == MODE_LOCKFREE) {
+            uint32_t count = lf_counter_add(&shared_counter, 1);
+            
+            lf_seq_write_begin(&control_lock);
+            control_state.sequence = count;
+            control_state.input = input;
+            control_state.output = input / 2U;
+            lf_seq_write_end(&control_lock);
+        } else {
+            pthread_mutex_lock(&state_mutex);
+            control_state.sequence = ++locked_counter;
+            control_state.input = input;
+            control_state.output = input / 2U;
+            pthread_mutex_unlock(&state_mutex);
+        }
+        
+        uint32_t elapsed_ns = monitor_elapsed_ns(start, monitor_now());
+        
+        hist_record(&update_hist, elapsed_ns);
+        if (elapsed_ns > update_max_ns) {
+            update_max_ns = elapsed_ns;
+        }
+        updates++;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Medium priority: unrelated CPU load
+ */
+static void *medium_thread(void *arg)
+{
+    (void)arg;
+    
+    while (!atomic_load_explicit(&stop, memory_order_relaxed)) {
+        spin_us(MEDIUM_BUSY_US);
+        sleep_us(MEDIUM_IDLE_US);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Low priority: reader doing LOW_SECTION_US of work on the state
+ * 
+ * The work sits inside the read section in both modes, so they run the
+ * same code; the seqlock just retries it instead of holding High off.
+ */
+static void *low_thread(void *arg)
+{
+    control_state_t copy;
+    
+    (void)arg;
+    
+    while (!atomic_load_explicit(&stop, memory_order_relaxed)) {
+        if (mode == MODE_LOCKFREE) {
+            uint32_t seq;
+            
+            do {
+                seq = lf_seq_read_begin(&control_lock);
+                copy = control_state;
+                spin_us(LOW_SECTION_US);
+            } while (lf_seq_read_retry(&control_lock, seq));
+        } else {
+            pthread_mutex_lock(&state_mutex);
+            copy = control_state;
+            spin_us(LOW_SECTION_US);
+            pthread_mutex_unlock(&state_mutex);
+        }
+        
+        low_sink = copy.sequence + copy.output;
+        sleep_us(LOW_IDLE_US);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Start a thread at a SCHED_FIFO priority
+ * 
+ * Falls back to the default policy once, for the whole run, if the
+ * process may not use real-time scheduling.
+ */
+static int start_thread(pthread_t *thread, void *(*fn)(void *), int priority)
+{
+    pthread_attr_t attr;
+    struct sched_param param = { .sched_priority = priority };
+    int ret;
+    
+    if (realtime) {
+        pthread_attr_init(&attr);
+        pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+        pthread_attr_setschedparam(&attr, &param);
+        ret = pthread_create(thread, &attr, fn, NULL);
+        pthread_attr_destroy(&attr);
+        if (ret != EPERM) {
+            return ret;
+        }
+        
+        fprintf(stderr, "warning: no permission for SCHED_FIFO; priorities are not enforced\n");
+        realtime = false;
+    }
+    return pthread_create(thread, NULL, fn, NULL);
+}
+
+/**
+ * @brief Run one mode and print its latency distribution
+ * @return 0 on success, -1 if the threads could not be set up
+ */
+static int run_mode(bench_mode_t run, unsigned int seconds)
+{
+    static uint32_t counts[HIST_BUCKETS];
+    pthread_mutexattr_t attr;
+    pthread_t high;
+    pthread_t medium;
+    pthread_t low;
+    uint32_t i;
+    int ret;
+    
+    mode = run;
+    atomic_store(&stop, false);
+    memset(&update_hist, 0, sizeof(update_hist));
+    update_max_ns = 0;
+    updates = 0;
+    locked_counter = 0;
+    lf_counter_init(&shared_counter, 0);
+    lf_seqlock_init(&control_lock);
+    
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setprotocol(&attr, (run == MODE_MUTEX_PI) ? PTHREAD_PRIO_INHERIT
+                                                                : PTHREAD_PRIO_NONE);
+    pthread_mutex_init(&state_mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    
+    /* Low first so that it is already inside its section when High starts */
+    ret = start_thread(&low, low_thread, PRIORITY_LOW);
+    if (ret == 0) {
+        ret = start_thread(&medium, medium_thread, PRIORITY_MEDIUM);
+        if (ret == 0) {
+            ret = start_thread(&high, high_thread, PRIORITY_HIGH);
+            if (ret == 0) {
+                sleep(seconds);
+                atomic_store(&stop, true);
+                pthread_join(high, NULL);
+            }
+            atomic_store(&stop, true);
+            pthread_join(medium, NULL);
+        }
+        atomic_store(&stop, true);
+        pthread_join(low, NULL);
+    }
+    pthread_mutex_destroy(&state_mutex);
+    
+    if (ret != 0) {
+        fprintf(stderr, "pthread_create: %s\n", strerror(ret));
+        return -1;
+    }
+    
+    for (i = 0; i < HIST_BUCKETS; i++) {
+        counts[i] = atomic_load_explicit(&update_hist.counts[i], memory_order_relaxed);
+    }
+    
+    printf("%-9s %8llu  %9.2f %9.2f %9.2f %9.2f\n", mode_names[run],
+           (unsigned long long)updates,
+           hist_quantile_us(counts, updates, 50000, update_max_ns),
+           hist_quantile_us(counts, updates, 99000, update_max_ns),
+           hist_quantile_us(counts, updates, 99900, update_max_ns),
+           update_max_ns / 1000.0);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int seconds = DEFAULT_SECONDS;
+    struct sched_param param = { .sched_priority = PRIORITY_MAIN };
+    cpu_set_t cpus;
+    int m;
+    
+    if (argc > 1) {
+        seconds = (unsigned int)strtoul(argv[1], NULL, 10);
+        if (seconds == 0) {
+            fprintf(stderr, "Usage: %s [seconds per mode]\n", argv[0]);
+            return 1;
+        }
+    }
+    
+    /* One CPU, so priorities decide who runs, as on the MCU */
+    CPU_ZERO(&cpus);
+    CPU_SET(0, &cpus);
+    if (sched_setaffinity(0, sizeof(cpus), &cpus) < 0) {
+        perror("sched_setaffinity");
+        return 1;
+    }
+    
+    /* main() only sleeps, but must be able to wake and stop the run */
+    if (sched_setscheduler(0, SCHED_FIFO, &param) < 0) {
+        fprintf(stderr, "warning: no permission for SCHED_FIFO; priorities are not enforced\n");
+        realtime = false;
+    }
+    
+    monitor_time_init();
+    
+    printf("High-priority update latency (us), %u s per mode, 1 CPU, %s\n",
+           seconds, realtime ? "SCHED_FIFO" : "default policy");
+    printf("%-9s %8s  %9s %9s %9s %9s\n", "mode", "updates", "p50", "p99", "p99.9", "max");
+    
+    for (m = 0; m < MODE_COUNT; m++) {
+        if (run_mode((bench_mode_t)m, seconds) < 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -6,13 +6,18 @@
  * - Task creation with different priorities
  * - Priority-based preemption
  * - Task synchronization
- * - Resource sharing with priority inheritance
+ * - Lock-free shared state: atomic counter, seqlock snapshot, SPSC mailbox
  * - Deadline monitoring
+ * - A task-set table checked for schedulability before the scheduler starts
+ *   (utilization bound and exact response-time analysis)
+ * - Optional EDF dispatch (-DSCHED_EDF) on top of fixed-priority FreeRTOS
  * 
  * Compatible with: FreeRTOS, Zephyr RTOS, or similar
  * Build: Depends on RTOS (see README.md)
  */
 
+#define _POSIX_C_SOURCE 199309L     /* clock_gettime() for task-monitor.h on hosts */
+
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -21,10 +26,12 @@
 #ifdef USE_FREERTOS
 #include "FreeRTOS.h"
 #include "task.h"
-#include "semphr.h"
 #include "queue.h"
 #endif
 
+#include "task-monitor.h"
+#include "../common/lockfree.h"
+
 /* Task priorities (higher number = higher priority) */
 #define PRIORITY_HIGH       3
 #define PRIORITY_MEDIUM     2
@@ -35,12 +42,363 @@
 #define PERIOD_MEDIUM_MS    50
 #define PERIOD_LOW_MS       100
 
+/* Events: at most one per EVENT_MIN_INTERVAL_MS, handled within 5ms */
+#define EVENT_MIN_INTERVAL_MS   50
+#define EVENT_DEADLINE_MS       5
+
+/* Handled events waiting to be logged by the low-priority task */
+#define EVENT_LOG_SLOTS     8
+
 /* Stack sizes */
 #define STACK_SIZE          256
 
-/* Shared resource protection */
-static SemaphoreHandle_t resource_mutex = NULL;
-static uint32_t shared_counter = 0;
+/* Re-check the task set against measured WCETs every N low-priority periods */
+#define RECHECK_PERIODS     10
+
+/**
+ * @brief One entry of the task set
+ * 
+ * Times are in microseconds. wcet_us is the design budget; the analysis
+ * uses the larger of it and the WCET measured by task-monitor.h.
+ */
+typedef struct {
+    const char *name;
+    TaskFunction_t entry;
+    uint32_t period_us;         /* T: period, or minimum inter-arrival time */
+    uint32_t deadline_us;       /* D: relative deadline, D <= T */
+    uint32_t wcet_us;           /* C: execution budget */
+    uint32_t critical_us;       /* Longest lock hold or critical section */
+    UBaseType_t priority;       /* Fixed-priority mode */
+    TaskHandle_t handle;
+#ifdef SCHED_EDF
+    TickType_t abs_deadline;    /* Current job's deadline; written under a critical section */
+#endif
+    task_stats_t stats;
+} rt_task_t;
+
+void high_priority_task(void *params);
+void medium_priority_task(void *params);
+void low_priority_task(void *params);
+void event_handler_task(void *params);
+
+/*
+ * The task set, highest fixed priority first. Statistics are ~4KB per
+ * task (two histograms), which is why the table is static. Shared state
+ * is lock-free, so no task blocks another: every critical_us is 0.
+ */
+static rt_task_t task_set[] = {
+    { .name = "HighPrio", .entry = high_priority_task,
+      .period_us = PERIOD_HIGH_MS * 1000, .deadline_us = PERIOD_HIGH_MS * 1000,
+      .wcet_us = 2000, .critical_us = 0, .priority = PRIORITY_HIGH },
+    { .name = "EventHandler", .entry = event_handler_task,
+      .period_us = EVENT_MIN_INTERVAL_MS * 1000, .deadline_us = EVENT_DEADLINE_MS * 1000,
+      .wcet_us = 1000, .critical_us = 0, .priority = PRIORITY_HIGH },
+    { .name = "MediumPrio", .entry = medium_priority_task,
+      .period_us = PERIOD_MEDIUM_MS * 1000, .deadline_us = PERIOD_MEDIUM_MS * 1000,
+      .wcet_us = 5000, .critical_us = 0, .priority = PRIORITY_MEDIUM },
+    { .name = "LowPrio", .entry = low_priority_task,
+      .period_us = PERIOD_LOW_MS * 1000, .deadline_us = PERIOD_LOW_MS * 1000,
+      .wcet_us = 10000, .critical_us = 0, .priority = PRIORITY_LOW },
+};
+
+#define TASK_COUNT          (sizeof(task_set) / sizeof(task_set[0]))
+
+#ifdef SCHED_EDF
+/*
+ * EDF ranks occupy one priority level per task, PRIORITY_LOW upwards;
+ * configMAX_PRIORITIES must exceed EDF_PRIORITY_TOP.
+ */
+#define EDF_PRIORITY_TOP    (PRIORITY_LOW + TASK_COUNT - 1)
+#endif
+
+/* Snapshot the high-priority task publishes every period */
+typedef struct {
+    uint32_t sequence;
+    uint32_t input;
+    uint32_t output;
+} control_state_t;
+
+/* Event forwarded by the handler so that printing stays off its path */
+typedef struct {
+    uint32_t data;
+    uint32_t handled_ns;
+} event_record_t;
+
+/*
+ * Shared state. The writer of each object has a higher priority than
+ * its readers, which the seqlock requires on a single core.
+ */
+static lf_counter_t shared_counter;                 /* HighPrio -> all */
+static lf_seqlock_t control_lock;                   /* HighPrio -> MediumPrio */
+static control_state_t control_state;
+static lf_mailbox_t event_log;                      /* EventHandler -> LowPrio */
+static event_record_t event_log_slots[EVENT_LOG_SLOTS];
+static QueueHandle_t event_queue = NULL;
+
+/**
+ * @brief Execution budget used by the analysis
+ * 
+ * The measured time runs from release to completion, so for a task that
+ * gets preempted it includes interference. That overestimates C: the
+ * check stays safe, only pessimistic.
+ */
+static uint32_t rt_task_wcet_us(rt_task_t *task)
+{
+    uint32_t measured_us = (task_stats_wcet_ns(&task->stats) + 999U) / 1000U;
+    
+    return (measured_us > task->wcet_us) ? measured_us : task->wcet_us;
+}
+
+/**
+ * @brief Total utilization, in parts per million
+ */
+static uint32_t task_set_utilization_ppm(void)
+{
+    uint64_t total = 0;
+    size_t i;
+    
+    for (i = 0; i < TASK_COUNT; i++) {
+        total += (uint64_t)rt_task_wcet_us(&task_set[i]) * 1000000U / task_set[i].period_us;
+    }
+    return (uint32_t)total;
+}
+
+#ifndef SCHED_EDF
+/* Liu & Layland bound n(2^(1/n) - 1) in parts per million, n = 1..8 */
+static const uint32_t rma_bound_ppm[] = {
+    1000000, 828427, 779763, 756828, 743492, 734772, 728627, 724062
+};
+
+#define RMA_BOUND_LIMIT_PPM 693147      /* ln 2, the bound as n grows */
+
+/**
+ * @brief Worst-case response time under fixed priorities
+ * @return Response time in us, or UINT32_MAX if it exceeds the deadline
+ * 
+ * Iterates R = C + B + sum(ceil(R / Tj) * Cj) over every task j at the
+ * same or higher priority until R stops growing. Equal priorities are
+ * counted as interference both ways (round-robin). B is the longest
+ * critical section of a lower-priority task: with priority inheritance
+ * and one mutex, a job is blocked at most once.
+ */
+static uint32_t rta_response_time_us(size_t i)
+{
+    const rt_task_t *self = &task_set[i];
+    uint64_t blocking = 0;
+    uint64_t response;
+    uint64_t next;
+    size_t j;
+    
+    for (j = 0; j < TASK_COUNT; j++) {
+        if (task_set[j].priority < self->priority && task_set[j].critical_us > blocking) {
+            blocking = task_set[j].critical_us;
+        }
+    }
+    
+    next = rt_task_wcet_us(&task_set[i]) + blocking;
+    do {
+        response = next;
+        if (response > self->deadline_us) {
+            return UINT32_MAX;
+        }
+        
+        next = rt_task_wcet_us(&task_set[i]) + blocking;
+        for (j = 0; j < TASK_COUNT; j++) {
+            if (j != i && task_set[j].priority >= self->priority) {
+                uint64_t releases = (response + task_set[j].period_us - 1) / task_set[j].period_us;
+                next += releases * rt_task_wcet_us(&task_set[j]);
+            }
+        }
+    } while (next != response);
+    
+    return (uint32_t)response;
+}
+
+/**
+ * @brief Fixed-priority check: utilization bound, then exact RTA
+ * 
+ * The bound is sufficient only, and only for D = T with rate-monotonic
+ * priorities; when it is inconclusive, RTA decides.
+ */
+static bool task_set_check_fixed_priority(uint32_t utilization_ppm)
+{
+    uint32_t bound = (TASK_COUNT <= sizeof(rma_bound_ppm) / sizeof(rma_bound_ppm[0]))
+                     ? rma_bound_ppm[TASK_COUNT - 1] : RMA_BOUND_LIMIT_PPM;
+    bool ok = true;
+    size_t i;
+    
+    printf("RMA bound: U = %u.%02u%% <= %u.%02u%%: %s\n",
+           (unsigned int)(utilization_ppm / 10000), (unsigned int)(utilization_ppm / 100 % 100),
+           (unsigned int)(bound / 10000), (unsigned int)(bound / 100 % 100),
+           (utilization_ppm <= bound) ? "schedulable" : "inconclusive");
+    
+    for (i = 0; i < TASK_COUNT; i++) {
+        uint32_t response = rta_response_time_us(i);
+        
+        if (response == UINT32_MAX) {
+            printf("  %-12s C=%6u D=%6u R > D  MISS\n", task_set[i].name,
+                   (unsigned int)rt_task_wcet_us(&task_set[i]),
+                   (unsigned int)task_set[i].deadline_us);
+            ok = false;
+        } else {
+            printf("  %-12s C=%6u D=%6u R=%6u\n", task_set[i].name,
+                   (unsigned int)rt_task_wcet_us(&task_set[i]),
+                   (unsigned int)task_set[i].deadline_us, (unsigned int)response);
+        }
+    }
+    return ok;
+}
+#endif /* !SCHED_EDF */
+
+/**
+ * @brief EDF check with blocking
+ * 
+ * For every task k, in increasing order of relative deadline:
+ *   sum(Ci / Di for Di <= Dk) + Bk / Dk <= 1
+ * where Bk is the longest critical section of a task with a longer
+ * relative deadline. Exact for D = T without blocking, sufficient
+ * otherwise.
+ */
+static bool task_set_check_edf(void)
+{
+    bool ok = true;
+    size_t k;
+    size_t i;
+    
+    for (k = 0; k < TASK_COUNT; k++) {
+        const rt_task_t *self = &task_set[k];
+        uint64_t density = 0;
+        uint32_t blocking = 0;
+        
+        for (i = 0; i < TASK_COUNT; i++) {
+            if (task_set[i].deadline_us <= self->deadline_us) {
+                density += (uint64_t)rt_task_wcet_us(&task_set[i]) * 1000000U /
+                           task_set[i].deadline_us;
+            } else if (task_set[i].critical_us > blocking) {
+                blocking = task_set[i].critical_us;
+            }
+        }
+        density += (uint64_t)blocking * 1000000U / self->deadline_us;
+        
+        printf("  %-12s D=%6u density %u.%02u%%%s\n", self->name,
+               (unsigned int)self->deadline_us,
+               (unsigned int)(density / 10000), (unsigned int)(density / 100 % 100),
+               (density > 1000000U) ? "  MISS" : "");
+        if (density > 1000000U) {
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief Check the task set under the configured scheduling policy
+ * @return true if no deadline can be missed
+ */
+static bool task_set_check(void)
+{
+    uint32_t utilization_ppm = task_set_utilization_ppm();
+
+#ifdef SCHED_EDF
+    printf("EDF: U = %u.%02u%%\n", (unsigned int)(utilization_ppm / 10000),
+           (unsigned int)(utilization_ppm / 100 % 100));
+    return task_set_check_edf();
+#else
+    if (task_set_check_fixed_priority(utilization_ppm)) {
+        return true;
+    }
+    printf("Under EDF (build with -DSCHED_EDF):\n");
+    if (task_set_check_edf()) {
+        printf("  schedulable\n");
+    }
+    return false;
+#endif
+}
+
+#ifdef SCHED_EDF
+/**
+ * @brief Re-rank EDF tasks after a release
+ * @param self Task that was just released
+ * @param release Nominal release time of its job
+ * 
+ * Earliest absolute deadline gets the highest priority. Runs inside a
+ * critical section so two releases cannot interleave; on Cortex-M ports
+ * the yields requested by vTaskPrioritySet() are pended until it exits.
+ * The insertion sort is O(n^2), fine for a handful of tasks.
+ */
+static void edf_release(rt_task_t *self, TickType_t release)
+{
+    rt_task_t *order[TASK_COUNT];
+    size_t i;
+    size_t j;
+    
+    taskENTER_CRITICAL();
+    
+    self->abs_deadline = release + pdMS_TO_TICKS(self->deadline_us / 1000U);
+    
+    for (i = 0; i < TASK_COUNT; i++) {
+        rt_task_t *task = &task_set[i];
+        
+        /* Wrap-safe "task is due before order[j - 1]" */
+        for (j = i; j > 0 &&
+             (TickType_t)(task->abs_deadline - order[j - 1]->abs_deadline) > portMAX_DELAY / 2;
+             j--) {
+            order[j] = order[j - 1];
+        }
+        order[j] = task;
+    }
+    
+    for (i = 0; i < TASK_COUNT; i++) {
+        vTaskPrioritySet(order[i]->handle, EDF_PRIORITY_TOP - i);
+    }
+    
+    taskEXIT_CRITICAL();
+}
+#endif
+
+/**
+ * @brief Start of a job: record release jitter, re-rank under EDF
+ * @return Start timestamp for rt_job_complete()
+ */
+static monitor_time_t rt_job_release(rt_task_t *self, TickType_t release)
+{
+    monitor_time_t start = monitor_now();
+    
+    task_stats_release(&self->stats, start);
+#ifdef SCHED_EDF
+    edf_release(self, release);
+#else
+    (void)release;
+#endif
+    return start;
+}
+
+/**
+ * @brief End of a job: record its time and report a deadline miss
+ */
+static void rt_job_complete(rt_task_t *self, monitor_time_t start)
+{
+    uint32_t elapsed_ns = monitor_elapsed_ns(start, monitor_now());
+    
+    if (!task_stats_complete(&self->stats, elapsed_ns)) {
+        printf("%s: Deadline missed! (%u us)\n", self->name,
+               (unsigned int)(elapsed_ns / 1000U));
+    }
+}
+
+/**
+ * @brief Simulate CPU-bound work (replace with actual task)
+ * 
+ * Busy-waits rather than sleeping: the analysis budgets CPU time.
+ */
+static void simulate_work(uint32_t work_us)
+{
+    monitor_time_t start = monitor_now();
+    
+    while (monitor_elapsed_ns(start, monitor_now()) < work_us * 1000U) {
+        /* Spin */
+    }
+}
 
 /**
  * @brief High-priority periodic task
@@ -49,32 +407,35 @@ static uint32_t shared_counter = 0;
  */
 void high_priority_task(void *params)
 {
+    rt_task_t *self = (rt_task_t *)params;
     TickType_t last_wake_time;
     const TickType_t period = pdMS_TO_TICKS(PERIOD_HIGH_MS);
     
-    (void)params;  /* Unused */
-    
     /* Initialize last wake time */
     last_wake_time = xTaskGetTickCount();
     
     while (1) {
         /* Wait for next period */
         vTaskDelayUntil(&last_wake_time, period);
+        monitor_time_t start = rt_job_release(self, last_wake_time);
         
         /* Critical real-time work */
         /* Example: Read sensor, update control output */
         
-        /* Access shared resource with mutex */
-        if (xSemaphoreTake(resource_mutex, pdMS_TO_TICKS(5)) == pdTRUE) {
-            shared_counter++;
-            xSemaphoreGive(resource_mutex);
-        } else {
-            /* Mutex timeout - log error */
-            printf("High priority task: Mutex timeout!\n");
-        }
+        /* Update shared state: never waits, whatever the readers are doing */
+        uint32_t count = lf_counter_add(&shared_counter, 1);
+        uint32_t input = (uint32_t)start & 0xFFFU;      /* Placeholder sensor reading */
+        
+        lf_seq_write_begin(&control_lock);
+        control_state.sequence = count;
+        control_state.input = input;
+        control_state.output = input / 2U;
+        lf_seq_write_end(&control_lock);
         
         /* Simulate work (replace with actual task) */
-        vTaskDelay(pdMS_TO_TICKS(2));
+        simulate_work(1500);
+        
+        rt_job_complete(self, start);
     }
 }
 
@@ -85,92 +446,107 @@ void high_priority_task(void *params)
  */
 void medium_priority_task(void *params)
 {
+    rt_task_t *self = (rt_task_t *)params;
     TickType_t last_wake_time;
     const TickType_t period = pdMS_TO_TICKS(PERIOD_MEDIUM_MS);
     
-    (void)params;
-    
     last_wake_time = xTaskGetTickCount();
     
     while (1) {
         vTaskDelayUntil(&last_wake_time, period);
+        monitor_time_t start = rt_job_release(self, last_wake_time);
         
         /* Medium priority work */
         /* Example: Process data, update display */
         
-        if (xSemaphoreTake(resource_mutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-            /* Read shared resource */
-            uint32_t value = shared_counter;
-            xSemaphoreGive(resource_mutex);
-            
-            printf("Medium task: Counter = %u\n", (unsigned int)value);
-        }
+        /* Consistent copy of the control state; retried if HighPrio preempted us */
+        control_state_t state;
+        uint32_t seq;
+        
+        do {
+            seq = lf_seq_read_begin(&control_lock);
+            state = control_state;
+        } while (lf_seq_read_retry(&control_lock, seq));
+        
+        printf("Medium task: Counter = %u, input = %u, output = %u\n",
+               (unsigned int)state.sequence, (unsigned int)state.input,
+               (unsigned int)state.output);
         
-        vTaskDelay(pdMS_TO_TICKS(5));
+        simulate_work(4000);
+        
+        rt_job_complete(self, start);
     }
 }
 
 /**
  * @brief Low-priority periodic task
  * 
- * Runs every 100ms - Background processing
+ * Runs every 100ms - Background processing. Also re-runs the
+ * schedulability check against measured WCETs, outside its timed job.
  */
 void low_priority_task(void *params)
 {
+    rt_task_t *self = (rt_task_t *)params;
     TickType_t last_wake_time;
     const TickType_t period = pdMS_TO_TICKS(PERIOD_LOW_MS);
-    
-    (void)params;
+    uint32_t iteration = 0;
     
     last_wake_time = xTaskGetTickCount();
     
     while (1) {
         vTaskDelayUntil(&last_wake_time, period);
+        monitor_time_t start = rt_job_release(self, last_wake_time);
         
         /* Low priority work */
         /* Example: Logging, housekeeping, diagnostics */
         
-        if (xSemaphoreTake(resource_mutex, pdMS_TO_TICKS(20)) == pdTRUE) {
-            uint32_t value = shared_counter;
-            xSemaphoreGive(resource_mutex);
-            
-            printf("Low task: Counter = %u\n", (unsigned int)value);
+        event_record_t record;
+        
+        printf("Low task: Counter = %u\n", (unsigned int)lf_counter_read(&shared_counter));
+        while (lf_mailbox_fetch(&event_log, &record)) {
+            printf("Low task: Event %u handled in %u us\n",
+                   (unsigned int)record.data, (unsigned int)(record.handled_ns / 1000U));
         }
         
-        vTaskDelay(pdMS_TO_TICKS(10));
+        simulate_work(8000);
+        
+        rt_job_complete(self, start);
+        
+        /* Measured WCETs over budget may have broken the guarantee */
+        if (++iteration % RECHECK_PERIODS == 0 && !task_set_check()) {
+            printf("Low task: Task set no longer schedulable with measured WCETs!\n");
+        }
     }
 }
 
 /**
  * @brief Aperiodic event handler task
  * 
- * Responds to events with high priority
+ * Responds to events with high priority. Analysed as a sporadic task:
+ * events must be at least EVENT_MIN_INTERVAL_MS apart.
  */
 void event_handler_task(void *params)
 {
-    QueueHandle_t event_queue = (QueueHandle_t)params;
+    rt_task_t *self = (rt_task_t *)params;
     uint32_t event_data;
     
     while (1) {
         /* Wait for event (blocking) */
         if (xQueueReceive(event_queue, &event_data, portMAX_DELAY) == pdTRUE) {
-            /* Handle event immediately */
-            printf("Event handler: Received event %u\n", (unsigned int)event_data);
-            
-            /* Process event with deadline constraint */
-            /* Must complete within 5ms */
-            TickType_t start_time = xTaskGetTickCount();
+            /* The job is released when the event arrives */
+            monitor_time_t start = rt_job_release(self, xTaskGetTickCount());
             
-            /* Event processing */
-            vTaskDelay(pdMS_TO_TICKS(3));
+            /* Event processing, must complete within 5ms */
+            simulate_work(800);
             
-            TickType_t end_time = xTaskGetTickCount();
-            TickType_t elapsed = end_time - start_time;
+            /* Leave the printing to LowPrio; drop the record if it is behind */
+            event_record_t record = {
+                .data = event_data,
+                .handled_ns = monitor_elapsed_ns(start, monitor_now()),
+            };
+            (void)lf_mailbox_post(&event_log, &record);
             
-            if (elapsed > pdMS_TO_TICKS(5)) {
-                printf("Event handler: Deadline missed! (%u ms)\n",
-                       (unsigned int)(elapsed * portTICK_PERIOD_MS));
-            }
+            rt_job_complete(self, start);
         }
     }
 }
@@ -181,17 +557,26 @@ void event_handler_task(void *params)
 int main(void)
 {
     BaseType_t ret;
-    QueueHandle_t event_queue;
+    size_t i;
     
     printf("Starting Real-Time Priority Scheduling Example\n");
     
-    /* Create mutex with priority inheritance */
-    resource_mutex = xSemaphoreCreateMutex();
-    if (resource_mutex == NULL) {
-        printf("Failed to create mutex\n");
+    for (i = 0; i < TASK_COUNT; i++) {
+        task_stats_init(&task_set[i].stats, task_set[i].name,
+                        task_set[i].period_us, task_set[i].deadline_us);
+    }
+    
+    /* Refuse to start a task set that can miss deadlines */
+    if (!task_set_check()) {
+        printf("Task set is not schedulable\n");
         return -1;
     }
     
+    /* Shared state: no kernel objects, nothing to fail */
+    lf_counter_init(&shared_counter, 0);
+    lf_seqlock_init(&control_lock);
+    lf_mailbox_init(&event_log, event_log_slots, sizeof(event_log_slots[0]), EVENT_LOG_SLOTS);
+    
     /* Create event queue */
     event_queue = xQueueCreate(10, sizeof(uint32_t));
     if (event_queue == NULL) {
@@ -199,52 +584,18 @@ int main(void)
         return -1;
     }
     
-    /* Create high-priority task */
-    ret = xTaskCreate(high_priority_task,
-                     "HighPrio",
-                     STACK_SIZE,
-                     NULL,
-                     PRIORITY_HIGH,
-                     NULL);
-    if (ret != pdPASS) {
-        printf("Failed to create high priority task\n");
-        return -1;
-    }
-    
-    /* Create medium-priority task */
-    ret = xTaskCreate(medium_priority_task,
-                     "MediumPrio",
-                     STACK_SIZE,
-                     NULL,
-                     PRIORITY_MEDIUM,
-                     NULL);
-    if (ret != pdPASS) {
-        printf("Failed to create medium priority task\n");
-        return -1;
-    }
-    
-    /* Create low-priority task */
-    ret = xTaskCreate(low_priority_task,
-                     "LowPrio",
-                     STACK_SIZE,
-                     NULL,
-                     PRIORITY_LOW,
-                     NULL);
-    if (ret != pdPASS) {
-        printf("Failed to create low priority task\n");
-        return -1;
-    }
-    
-    /* Create event handler task */
-    ret = xTaskCreate(event_handler_task,
-                     "EventHandler",
-                     STACK_SIZE,
-                     (void *)event_queue,
-                     PRIORITY_HIGH,
-                     NULL);
-    if (ret != pdPASS) {
-        printf("Failed to create event handler task\n");
-        return -1;
+    /* Create tasks; under EDF the priorities are re-ranked at each release */
+    for (i = 0; i < TASK_COUNT; i++) {
+        ret = xTaskCreate(task_set[i].entry,
+                         task_set[i].name,
+                         STACK_SIZE,
+                         &task_set[i],
+                         task_set[i].priority,
+                         &task_set[i].handle);
+        if (ret != pdPASS) {
+            printf("Failed to create task %s\n", task_set[i].name);
+            return -1;
+        }
     }
     
     /* Start scheduler */
@@ -255,4 +606,3 @@ int main(void)
     printf("Scheduler failed to start\n");
     return -1;
 }
-
@@ -0,0 +1,473 @@
+/**
+ * @file task-monitor.h
+ * @brief Per-task timing monitor: high-resolution clock and HDR histograms
+ *
+ * Header-only; shared by deadline-monitoring.c and priority-scheduling.c.
+ * On POSIX hosts the includer must define _POSIX_C_SOURCE >= 199309L (or
+ * _GNU_SOURCE) before its first #include, for clock_gettime().
+ *
+ * - Time source: DWT cycle counter on Cortex-M3/M4/M7, the RTOS tick on
+ *   other FreeRTOS ports, CLOCK_MONOTONIC_RAW on POSIX hosts
+ * - 64-bit accumulators: the execution-time total never overflows
+ * - Log-linear (HDR-style) histograms of execution time and release
+ *   jitter in fixed memory, with a bounded relative error per bucket
+ * - O(1) updates from the monitored task with no locks: the task is the
+ *   only writer; readers take lock-free snapshots and never wait for it
+ *
+ * Usage:
+ *   static task_stats_t stats;
+ *   task_stats_init(&stats, "Control", 10000, 8000);    // period, deadline in us
+ *   ...
+ *   monitor_time_t start = monitor_now();
+ *   task_stats_release(&stats, start);
+ *   do_work();
+ *   task_stats_complete(&stats, monitor_elapsed_ns(start, monitor_now()));
+ */
+
+#ifndef TASK_MONITOR_H
+#define TASK_MONITOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+
+/* ---- Time source ---- */
+
+#if defined(USE_FREERTOS) && \
+    (defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__))
+
+/* DWT cycle counter: one cycle resolution, wraps every 2^32 cycles */
+#ifndef MONITOR_CPU_HZ
+#define MONITOR_CPU_HZ          72000000UL
+#endif
+
+#define MONITOR_DEMCR           (*(volatile uint32_t *)0xE000EDFCUL)
+#define MONITOR_DEMCR_TRCENA    (1UL << 24)
+#define MONITOR_DWT_CTRL        (*(volatile uint32_t *)0xE0001000UL)
+#define MONITOR_DWT_CYCCNTENA   (1UL << 0)
+#define MONITOR_DWT_CYCCNT      (*(volatile uint32_t *)0xE0001004UL)
+#define MONITOR_DWT_LAR         (*(volatile uint32_t *)0xE0001FB0UL)    /* Cortex-M7 only */
+
+/* Nanoseconds per cycle in Q16 fixed point: one UMULL per conversion */
+#define MONITOR_NS_PER_CYCLE_Q16    ((uint32_t)((1000000000ULL << 16) / MONITOR_CPU_HZ))
+
+typedef uint32_t monitor_time_t;
+
+static inline void monitor_time_init(void)
+{
+    MONITOR_DEMCR |= MONITOR_DEMCR_TRCENA;
+    MONITOR_DWT_LAR = 0xC5ACCE55UL;
+    MONITOR_DWT_CTRL |= MONITOR_DWT_CYCCNTENA;
+}
+
+static inline monitor_time_t monitor_now(void)
+{
+    return MONITOR_DWT_CYCCNT;
+}
+
+/* Correct across one counter wrap (59 s at 72 MHz) */
+static inline uint64_t monitor_delta_ns(monitor_time_t start, monitor_time_t end)
+{
+    return ((uint64_t)(uint32_t)(end - start) * MONITOR_NS_PER_CYCLE_Q16) >> 16;
+}
+
+#elif defined(USE_FREERTOS)
+
+/* No cycle counter (e.g. Cortex-M0): tick resolution only */
+typedef TickType_t monitor_time_t;
+
+static inline void monitor_time_init(void)
+{
+}
+
+static inline monitor_time_t monitor_now(void)
+{
+    return xTaskGetTickCount();
+}
+
+static inline uint64_t monitor_delta_ns(monitor_time_t start, monitor_time_t end)
+{
+    return (uint64_t)(TickType_t)(end - start) * (1000000000ULL / configTICK_RATE_HZ);
+}
+
+#else
+
+#include <time.h>
+
+#if !defined(_POSIX_C_SOURCE) || _POSIX_C_SOURCE < 199309L
+#error "task-monitor.h: define _POSIX_C_SOURCE >= 199309L before any #include (clock_gettime)"
+#endif
+
+/* Raw monotonic clock: not slewed by NTP, so intervals are true durations */
+#ifdef CLOCK_MONOTONIC_RAW
+#define MONITOR_CLOCK           CLOCK_MONOTONIC_RAW
+#else
+#define MONITOR_CLOCK           CLOCK_MONOTONIC
+#endif
+
+typedef uint64_t monitor_time_t;
+
+static inline void monitor_time_init(void)
+{
+}
+
+static inline monitor_time_t monitor_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(MONITOR_CLOCK, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint64_t monitor_delta_ns(monitor_time_t start, monitor_time_t end)
+{
+    return end - start;
+}
+
+#endif
+
+/**
+ * @brief Elapsed time in nanoseconds, saturated to 32 bits (4.29 s)
+ */
+static inline uint32_t monitor_elapsed_ns(monitor_time_t start, monitor_time_t end)
+{
+    uint64_t ns = monitor_delta_ns(start, end);
+
+    return (ns > UINT32_MAX) ? UINT32_MAX : (uint32_t)ns;
+}
+
+/* ---- Log-linear histogram ---- */
+
+/*
+ * Values below 2^HIST_SUB_BITS get one bucket each. Above that, every
+ * power-of-two range is split into 2^HIST_SUB_BITS equal buckets, so a
+ * bucket is never wider than 1/2^HIST_SUB_BITS of its value (6.25% with
+ * 4 bits). Values are nanoseconds; 32 bits cover up to 4.29 s.
+ */
+#ifndef HIST_SUB_BITS
+#define HIST_SUB_BITS           4
+#endif
+#define HIST_SUB_COUNT          (1U << HIST_SUB_BITS)
+#define HIST_VALUE_BITS         32
+#define HIST_BUCKETS            ((HIST_VALUE_BITS - HIST_SUB_BITS + 1) * HIST_SUB_COUNT)
+
+typedef struct {
+    atomic_uint_least32_t counts[HIST_BUCKETS];
+} latency_hist_t;
+
+/**
+ * @brief Bucket for a value: a count-leading-zeros and a shift
+ */
+static inline uint32_t hist_bucket(uint32_t value)
+{
+    uint32_t msb;
+    uint32_t group;
+
+    if (value < HIST_SUB_COUNT) {
+        return value;
+    }
+
+    msb = 31U - (uint32_t)__builtin_clz(value);
+    group = msb - HIST_SUB_BITS + 1U;
+    return (group << HIST_SUB_BITS) + ((value >> (group - 1U)) - HIST_SUB_COUNT);
+}
+
+/**
+ * @brief Largest value that falls into a bucket
+ */
+static inline uint32_t hist_bucket_max(uint32_t bucket)
+{
+    uint32_t group = bucket >> HIST_SUB_BITS;
+    uint32_t sub = bucket & (HIST_SUB_COUNT - 1U);
+    uint64_t low;
+
+    if (group == 0) {
+        return sub;
+    }
+
+    low = (uint64_t)(HIST_SUB_COUNT + sub) << (group - 1U);
+    return (uint32_t)(low + (1ULL << (group - 1U)) - 1U);
+}
+
+/**
+ * @brief Count one value (single writer)
+ *
+ * A relaxed load and store, not a read-modify-write: only the owning
+ * task writes, so no LDREX/STREX loop or interrupt masking is needed.
+ */
+static inline void hist_record(latency_hist_t *hist, uint32_t value)
+{
+    atomic_uint_least32_t *count = &hist->counts[hist_bucket(value)];
+
+    atomic_store_explicit(count, atomic_load_explicit(count, memory_order_relaxed) + 1U,
+                          memory_order_relaxed);
+}
+
+/**
+ * @brief Value at a quantile of a copied histogram
+ * @param counts Bucket counts (e.g. from task_stats_snapshot())
+ * @param total Sum of counts
+ * @param per_100k Quantile in parts per 100000 (99900 = p99.9)
+ * @return Upper bound of the bucket holding that rank
+ */
+static inline uint32_t hist_quantile(const uint32_t counts[HIST_BUCKETS],
+                                     uint64_t total, uint32_t per_100k)
+{
+    uint64_t rank;
+    uint64_t seen = 0;
+    uint32_t i;
+
+    if (total == 0) {
+        return 0;
+    }
+
+    rank = (total * per_100k + 99999U) / 100000U;
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    for (i = 0; i < HIST_BUCKETS; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return hist_bucket_max(i);
+        }
+    }
+    return UINT32_MAX;
+}
+
+/* ---- Per-task statistics ---- */
+
+/**
+ * @brief Scalar statistics, published as one unit
+ */
+typedef struct {
+    uint64_t executions;
+    uint64_t total_execution_ns;
+    uint32_t min_execution_ns;
+    uint32_t max_execution_ns;
+    uint32_t max_jitter_ns;
+    uint32_t deadline_misses;
+} task_summary_t;
+
+typedef struct {
+    const char *name;
+    uint32_t period_ns;
+    uint32_t deadline_ns;
+
+    /* Owned by the task only */
+    task_summary_t work;
+    monitor_time_t last_release;
+    bool has_release;
+
+    /*
+     * Published copies under a latch sequence count: readers use
+     * published[seq & 1], which the writer is not modifying, and retry
+     * only if seq moved while they copied. A reader that preempts the
+     * task never spins waiting for it, and the task never waits either.
+     */
+    atomic_uint seq;
+    task_summary_t published[2];
+
+    latency_hist_t execution_hist;
+    latency_hist_t jitter_hist;
+} task_stats_t;
+
+/**
+ * @brief Consistent copy of a task's statistics
+ */
+typedef struct {
+    task_summary_t summary;
+    uint64_t execution_samples;
+    uint64_t jitter_samples;
+    uint32_t execution_counts[HIST_BUCKETS];
+    uint32_t jitter_counts[HIST_BUCKETS];
+} task_stats_snapshot_t;
+
+/**
+ * @brief Initialize task statistics
+ * @param stats Statistics to reset
+ * @param name Task name for reports
+ * @param period_us Release period in microseconds
+ * @param deadline_us Relative deadline in microseconds
+ */
+static inline void task_stats_init(task_stats_t *stats, const char *name,
+                                   uint32_t period_us, uint32_t deadline_us)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->name = name;
+    stats->period_ns = period_us * 1000U;
+    stats->deadline_ns = deadline_us * 1000U;
+    stats->work.min_execution_ns = UINT32_MAX;
+    stats->published[0] = stats->work;
+    stats->published[1] = stats->work;
+    atomic_init(&stats->seq, 0);
+    monitor_time_init();
+}
+
+/**
+ * @brief Publish the task's working summary to readers
+ */
+static inline void task_stats_publish(task_stats_t *stats)
+{
+    unsigned int seq = atomic_load_explicit(&stats->seq, memory_order_relaxed);
+
+    /* Odd: readers move to published[1] while [0] is rewritten */
+    atomic_store_explicit(&stats->seq, seq + 1U, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    stats->published[0] = stats->work;
+
+    /* Even: readers move back to [0] while [1] catches up */
+    atomic_store_explicit(&stats->seq, seq + 2U, memory_order_release);
+    atomic_thread_fence(memory_order_release);
+    stats->published[1] = stats->work;
+}
+
+/**
+ * @brief Read the latest published summary
+ */
+static inline void task_stats_summary(task_stats_t *stats, task_summary_t *out)
+{
+    unsigned int seq;
+
+    do {
+        seq = atomic_load_explicit(&stats->seq, memory_order_acquire);
+        *out = stats->published[seq & 1U];
+        atomic_thread_fence(memory_order_acquire);
+    } while (atomic_load_explicit(&stats->seq, memory_order_relaxed) != seq);
+}
+
+/**
+ * @brief Record a release; the jitter is how far the interval since the
+ *        previous release strayed from the period
+ */
+static inline void task_stats_release(task_stats_t *stats, monitor_time_t now)
+{
+    if (stats->has_release) {
+        uint32_t interval = monitor_elapsed_ns(stats->last_release, now);
+        uint32_t jitter = (interval > stats->period_ns) ? interval - stats->period_ns
+                                                        : stats->period_ns - interval;
+
+        hist_record(&stats->jitter_hist, jitter);
+        if (jitter > stats->work.max_jitter_ns) {
+            stats->work.max_jitter_ns = jitter;
+        }
+    }
+    stats->last_release = now;
+    stats->has_release = true;
+}
+
+/**
+ * @brief Record one completed job
+ * @param execution_ns Release-to-completion time
+ * @return true if the deadline was met
+ */
+static inline bool task_stats_complete(task_stats_t *stats, uint32_t execution_ns)
+{
+    task_summary_t *work = &stats->work;
+    bool met = execution_ns <= stats->deadline_ns;
+
+    hist_record(&stats->execution_hist, execution_ns);
+
+    work->executions++;
+    work->total_execution_ns += execution_ns;
+    if (execution_ns < work->min_execution_ns) {
+        work->min_execution_ns = execution_ns;
+    }
+    if (execution_ns > work->max_execution_ns) {
+        work->max_execution_ns = execution_ns;
+    }
+    if (!met) {
+        work->deadline_misses++;
+    }
+
+    task_stats_publish(stats);
+    return met;
+}
+
+/**
+ * @brief Copy statistics without stopping the task
+ *
+ * The histograms are copied bucket by bucket, so their totals come from
+ * the copy itself and percentiles are always self-consistent.
+ */
+static inline void task_stats_snapshot(task_stats_t *stats, task_stats_snapshot_t *snap)
+{
+    uint32_t i;
+
+    task_stats_summary(stats, &snap->summary);
+
+    snap->execution_samples = 0;
+    snap->jitter_samples = 0;
+    for (i = 0; i < HIST_BUCKETS; i++) {
+        snap->execution_counts[i] = atomic_load_explicit(&stats->execution_hist.counts[i],
+                                                         memory_order_relaxed);
+        snap->jitter_counts[i] = atomic_load_explicit(&stats->jitter_hist.counts[i],
+                                                      memory_order_relaxed);
+        snap->execution_samples += snap->execution_counts[i];
+        snap->jitter_samples += snap->jitter_counts[i];
+    }
+}
+
+/**
+ * @brief Worst-case execution time observed so far, in nanoseconds
+ */
+static inline uint32_t task_stats_wcet_ns(task_stats_t *stats)
+{
+    task_summary_t summary;
+
+    task_stats_summary(stats, &summary);
+    return summary.max_execution_ns;
+}
+
+/**
+ * @brief Quantile in microseconds, capped at the observed maximum
+ */
+static inline double hist_quantile_us(const uint32_t counts[HIST_BUCKETS], uint64_t total,
+                                      uint32_t per_100k, uint32_t max_ns)
+{
+    uint32_t ns = hist_quantile(counts, total, per_100k);
+
+    return ((ns < max_ns) ? ns : max_ns) / 1000.0;
+}
+
+/**
+ * @brief Print a task's statistics
+ * @param snap Scratch snapshot (large: keep it off small task stacks)
+ */
+static inline void task_stats_print(task_stats_t *stats, task_stats_snapshot_t *snap)
+{
+    const task_summary_t *sum = &snap->summary;
+
+    task_stats_snapshot(stats, snap);
+
+    if (sum->executions == 0) {
+        printf("%s: no executions yet\n", stats->name);
+        return;
+    }
+
+    printf("\n=== Task Statistics: %s ===\n", stats->name);
+    printf("Executions:      %llu\n", (unsigned long long)sum->executions);
+    printf("Deadline misses: %u (%.2f%%)\n", (unsigned int)sum->deadline_misses,
+           (double)sum->deadline_misses * 100.0 / (double)sum->executions);
+    printf("Exec time (us):  min %.1f  avg %.1f  max %.1f\n",
+           sum->min_execution_ns / 1000.0,
+           (double)sum->total_execution_ns / (double)sum->executions / 1000.0,
+           sum->max_execution_ns / 1000.0);
+    printf("Exec time (us):  p50 %.1f  p99 %.1f  p99.9 %.1f\n",
+           hist_quantile_us(snap->execution_counts, snap->execution_samples, 50000,
+                            sum->max_execution_ns),
+           hist_quantile_us(snap->execution_counts, snap->execution_samples, 99000,
+                            sum->max_execution_ns),
+           hist_quantile_us(snap->execution_counts, snap->execution_samples, 99900,
+                            sum->max_execution_ns));
+    printf("Jitter (us):     p50 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+           hist_quantile_us(snap->jitter_counts, snap->jitter_samples, 50000, sum->max_jitter_ns),
+           hist_quantile_us(snap->jitter_counts, snap->jitter_samples, 99000, sum->max_jitter_ns),
+           hist_quantile_us(snap->jitter_counts, snap->jitter_samples, 99900, sum->max_jitter_ns),
+           sum->max_jitter_ns / 1000.0);
+    printf("======================\n\n");
+}
+
+#endif /* TASK_MONITOR_H */
@@ -0,0 +1,340 @@
+/**
+ * @file ipc-channel.c
+ * @brief Message channel over a pipe or a shared-memory SPSC ring
+ * 
+ * The shared-memory transport puts a ../common/spsc-ring.h ring in a
+ * memfd mapping inherited across fork(). Each side polls briefly, then
+ * parks on a futex word in the mapping; the other side only makes the
+ * wake syscall when that word says someone is parked.
+ */
+
+#define _GNU_SOURCE     /* memfd_create, syscall */
+
+#include "ipc-channel.h"
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <errno.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include "../common/spsc-ring.h"
+
+/* Pipe frames up to this size go out in one write() */
+#define IPC_PIPE_FRAME_MAX  256
+
+/* Shared-memory ring: data area size (power of two) and polls before parking */
+#define SHM_RING_SIZE       (256 * 1024)
+#define SHM_SPIN_LIMIT      200
+
+/* Ring records are a 4-byte length and the payload, padded to 4 bytes */
+#define SHM_RECORD_ALIGN    4U
+#define SHM_RECORD_SIZE(n)  (4U + (((uint32_t)(n) + SHM_RECORD_ALIGN - 1) & ~(SHM_RECORD_ALIGN - 1)))
+
+/**
+ * Shared mapping for the SHM transport. The ring's buffer pointer is
+ * valid in both processes because the mapping is made before fork();
+ * an unrelated process given shm_fd would have to map it and rebase.
+ */
+struct shm_channel {
+    spsc_ring_t ring;                           /* head, tail on separate lines */
+
+    /* Futex words: 1 while that side is asleep waiting for the other */
+    _Alignas(64) atomic_uint receiver_parked;
+    _Alignas(64) atomic_uint sender_parked;
+    atomic_uint closed;                         /* Sender is done */
+
+    _Alignas(64) uint8_t data[SHM_RING_SIZE];
+};
+
+SPSC_RING_ASSERT_SIZE(SHM_RING_SIZE);
+_Static_assert(IPC_MAX_MESSAGE <= SHM_RING_SIZE / 2, "message must fit the ring");
+
+const char *ipc_transport_name(ipc_transport_t transport) {
+    return (transport == IPC_TRANSPORT_PIPE) ? "pipe" : "shm-ring";
+}
+
+static void shm_futex_wait(atomic_uint *word, unsigned int expected) {
+#ifdef __linux__
+    /* Not FUTEX_PRIVATE_FLAG: the word is shared between processes */
+    syscall(SYS_futex, word, FUTEX_WAIT, expected, NULL, NULL, 0);
+#else
+    (void)word;
+    (void)expected;
+    nanosleep(&(struct timespec){ .tv_nsec = 50000 }, NULL);
+#endif
+}
+
+static void shm_futex_wake(atomic_uint *word) {
+#ifdef __linux__
+    syscall(SYS_futex, word, FUTEX_WAKE, 1, NULL, NULL, 0);
+#else
+    (void)word;
+#endif
+}
+
+/**
+ * @brief Wake the peer if it is parked on word
+ *
+ * Called after publishing an index. The fence orders that store before
+ * the load of word; shm_wait_until() orders its store of word before
+ * rechecking the index, so one side always sees the other.
+ */
+static void shm_wake_peer(atomic_uint *word) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(word, memory_order_relaxed) &&
+        atomic_exchange(word, 0)) {
+        shm_futex_wake(word);
+    }
+}
+
+/**
+ * @brief Wait until the ring satisfies a condition, parking if it takes long
+ * @param parked This side's futex word
+ * @param ready Returns true once the caller may proceed
+ */
+static void shm_wait_until(struct shm_channel *shm, atomic_uint *parked,
+                           bool (*ready)(struct shm_channel *, uint32_t), uint32_t need) {
+    for (;;) {
+        for (int spin = 0; spin < SHM_SPIN_LIMIT; spin++) {
+            if (ready(shm, need)) {
+                return;
+            }
+        }
+
+        atomic_store(parked, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (ready(shm, need)) {
+            atomic_store(parked, 0);
+            return;
+        }
+        /* Returns at once if the peer already cleared the word */
+        shm_futex_wait(parked, 1);
+        atomic_store(parked, 0);
+    }
+}
+
+static bool shm_has_space(struct shm_channel *shm, uint32_t need) {
+    return spsc_ring_space(&shm->ring) >= need;
+}
+
+static bool shm_has_data(struct shm_channel *shm, uint32_t need) {
+    return spsc_ring_count(&shm->ring) >= need ||
+           atomic_load_explicit(&shm->closed, memory_order_acquire);
+}
+
+int ipc_channel_open(ipc_channel_t *ch, ipc_transport_t transport) {
+    memset(ch, 0, sizeof(*ch));
+    ch->transport = transport;
+    ch->shm_fd = -1;
+    ch->pipefd[0] = -1;
+    ch->pipefd[1] = -1;
+
+    if (transport == IPC_TRANSPORT_PIPE) {
+        if (pipe(ch->pipefd) < 0) {
+            perror("pipe");
+            return -1;
+        }
+        return 0;
+    }
+
+#ifdef __linux__
+    ch->shm_fd = memfd_create("ipc-ring", MFD_CLOEXEC);
+    if (ch->shm_fd < 0) {
+        perror("memfd_create");
+        return -1;
+    }
+#else
+    char name[64];
+    snprintf(name, sizeof(name), "/ipc-ring-%ld", (long)getpid());
+    ch->shm_fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (ch->shm_fd < 0) {
+        perror("shm_open");
+        return -1;
+    }
+    shm_unlink(name);   /* Lives on while mapped or open */
+#endif
+
+    if (ftruncate(ch->shm_fd, sizeof(struct shm_channel)) < 0) {
+        perror("ftruncate");
+        close(ch->shm_fd);
+        return -1;
+    }
+
+    ch->shm = mmap(NULL, sizeof(struct shm_channel), PROT_READ | PROT_WRITE,
+                   MAP_SHARED, ch->shm_fd, 0);
+    if (ch->shm == MAP_FAILED) {
+        perror("mmap");
+        close(ch->shm_fd);
+        ch->shm = NULL;
+        return -1;
+    }
+
+    spsc_ring_init(&ch->shm->ring, ch->shm->data, SHM_RING_SIZE);
+    atomic_init(&ch->shm->receiver_parked, 0);
+    atomic_init(&ch->shm->sender_parked, 0);
+    atomic_init(&ch->shm->closed, 0);
+    return 0;
+}
+
+void ipc_channel_set_role(ipc_channel_t *ch, ipc_role_t role) {
+    ch->role = role;
+    if (ch->transport == IPC_TRANSPORT_PIPE) {
+        int unused = (role == IPC_ROLE_SENDER) ? 0 : 1;
+
+        close(ch->pipefd[unused]);
+        ch->pipefd[unused] = -1;
+    }
+}
+
+int ipc_transfer_all(int fd, void *buf, size_t len, bool is_write) {
+    uint8_t *p = buf;
+    size_t done = 0;
+
+    while (done < len) {
+        ssize_t n = is_write ? write(fd, p + done, len - done)
+                             : read(fd, p + done, len - done);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if (n == 0) {
+            if (done == 0) {
+                return 0;
+            }
+            errno = EPIPE;
+            return -1;
+        }
+        done += (size_t)n;
+    }
+    return 1;
+}
+
+int ipc_send(ipc_channel_t *ch, const void *msg, size_t len) {
+    uint32_t header = (uint32_t)len;
+
+    if (len > IPC_MAX_MESSAGE) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+
+    if (ch->transport == IPC_TRANSPORT_PIPE) {
+        /* One write for header and payload when it fits: atomic below PIPE_BUF */
+        uint8_t frame[4 + IPC_PIPE_FRAME_MAX];
+
+        if (len <= IPC_PIPE_FRAME_MAX) {
+            memcpy(frame, &header, 4);
+            memcpy(frame + 4, msg, len);
+            return (ipc_transfer_all(ch->pipefd[1], frame, 4 + len, true) == 1) ? 0 : -1;
+        }
+        if (ipc_transfer_all(ch->pipefd[1], &header, 4, true) != 1 ||
+            ipc_transfer_all(ch->pipefd[1], (void *)msg, len, true) != 1) {
+            return -1;
+        }
+        return 0;
+    }
+
+    static const uint8_t padding[SHM_RECORD_ALIGN];
+    struct shm_channel *shm = ch->shm;
+    uint32_t record = SHM_RECORD_SIZE(len);
+
+    shm_wait_until(shm, &shm->sender_parked, shm_has_space, record);
+    spsc_ring_write_n(&shm->ring, (const uint8_t *)&header, 4);
+    spsc_ring_write_n(&shm->ring, msg, (uint32_t)len);
+    spsc_ring_write_n(&shm->ring, padding, record - 4 - (uint32_t)len);
+    shm_wake_peer(&shm->receiver_parked);
+    return 0;
+}
+
+ssize_t ipc_receive(ipc_channel_t *ch, void *buf, size_t size) {
+    uint32_t header;
+
+    if (ch->transport == IPC_TRANSPORT_PIPE) {
+        int ret = ipc_transfer_all(ch->pipefd[0], &header, 4, false);
+
+        if (ret <= 0) {
+            return ret;
+        }
+        if (header > size) {
+            /* Drop the payload too, or the next receive reads it as a header */
+            uint8_t scratch[IPC_PIPE_FRAME_MAX];
+
+            while (header > 0) {
+                uint32_t n = header < sizeof(scratch) ? header : (uint32_t)sizeof(scratch);
+
+                if (ipc_transfer_all(ch->pipefd[0], scratch, n, false) != 1) {
+                    return -1;
+                }
+                header -= n;
+            }
+            errno = EMSGSIZE;
+            return -1;
+        }
+        return (ipc_transfer_all(ch->pipefd[0], buf, header, false) == 1) ? (ssize_t)header : -1;
+    }
+
+    struct shm_channel *shm = ch->shm;
+    const uint8_t *span;
+
+    shm_wait_until(shm, &shm->receiver_parked, shm_has_data, 4);
+    if (spsc_ring_count(&shm->ring) == 0) {
+        return 0;   /* Closed and drained */
+    }
+
+    /* Records are 4-byte aligned, so a header never straddles the wrap */
+    spsc_ring_peek_read(&shm->ring, &span);
+    memcpy(&header, span, 4);
+
+    uint32_t record = SHM_RECORD_SIZE(header);
+    shm_wait_until(shm, &shm->receiver_parked, shm_has_data, record);
+
+    spsc_ring_commit_read(&shm->ring, 4);
+    if (header > size) {
+        spsc_ring_commit_read(&shm->ring, record - 4);
+        shm_wake_peer(&shm->sender_parked);
+        errno = EMSGSIZE;
+        return -1;
+    }
+    spsc_ring_read_n(&shm->ring, buf, header);
+    spsc_ring_commit_read(&shm->ring, record - 4 - header);
+    shm_wake_peer(&shm->sender_parked);
+    return (ssize_t)header;
+}
+
+void ipc_channel_drop(ipc_channel_t *ch) {
+    for (int i = 0; i < 2; i++) {
+        if (ch->pipefd[i] >= 0) {
+            close(ch->pipefd[i]);
+            ch->pipefd[i] = -1;
+        }
+    }
+    if (ch->shm != NULL) {
+        munmap(ch->shm, sizeof(struct shm_channel));
+        ch->shm = NULL;
+    }
+    if (ch->shm_fd >= 0) {
+        close(ch->shm_fd);
+        ch->shm_fd = -1;
+    }
+}
+
+void ipc_channel_close(ipc_channel_t *ch) {
+    /* A pipe reports end-of-stream by itself once the write end is closed */
+    if (ch->transport == IPC_TRANSPORT_SHM && ch->shm != NULL && ch->role == IPC_ROLE_SENDER) {
+        atomic_store_explicit(&ch->shm->closed, 1, memory_order_release);
+        shm_wake_peer(&ch->shm->receiver_parked);
+    }
+    ipc_channel_drop(ch);
+}
@@ -0,0 +1,102 @@
+/**
+ * @file ipc-channel.h
+ * @brief Message channel between a parent and a forked child
+ * 
+ * One send/receive API over two transports:
+ * - IPC_TRANSPORT_PIPE: length-prefixed frames through a pipe; two
+ *   syscalls and two copies per message
+ * - IPC_TRANSPORT_SHM: an SPSC ring in shared memory; no syscall while
+ *   the peer keeps up, a futex wake only when it is parked
+ * 
+ * A channel has one sender and one receiver. Open it before fork(), then
+ * each process picks its end:
+ *   ipc_channel_t ch;
+ *   ipc_channel_open(&ch, IPC_TRANSPORT_SHM);
+ *   if (fork() == 0) {
+ *       ipc_channel_set_role(&ch, IPC_ROLE_SENDER);
+ *       ipc_send(&ch, msg, len);
+ *       ipc_channel_close(&ch);
+ *       exit(0);
+ *   }
+ *   ipc_channel_set_role(&ch, IPC_ROLE_RECEIVER);
+ *   while ((n = ipc_receive(&ch, buf, sizeof(buf))) > 0) { ... }
+ *   ipc_channel_close(&ch);
+ */
+
+#ifndef SYSTEMS_IPC_CHANNEL_H
+#define SYSTEMS_IPC_CHANNEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+/* Largest message either transport accepts */
+#define IPC_MAX_MESSAGE     (128 * 1024)
+
+typedef enum {
+    IPC_TRANSPORT_PIPE,
+    IPC_TRANSPORT_SHM
+} ipc_transport_t;
+
+typedef enum {
+    IPC_ROLE_SENDER,
+    IPC_ROLE_RECEIVER
+} ipc_role_t;
+
+typedef struct {
+    ipc_transport_t transport;
+    ipc_role_t role;
+    int pipefd[2];                  /* IPC_TRANSPORT_PIPE */
+    int shm_fd;                     /* IPC_TRANSPORT_SHM */
+    struct shm_channel *shm;        /* Shared mapping */
+} ipc_channel_t;
+
+/**
+ * @brief Name of a transport, for reports
+ */
+const char *ipc_transport_name(ipc_transport_t transport);
+
+/**
+ * @brief Create a channel; call before fork()
+ * @return 0 on success, -1 on error
+ */
+int ipc_channel_open(ipc_channel_t *ch, ipc_transport_t transport);
+
+/**
+ * @brief Pick this process's end after fork(); closes the unused pipe end
+ */
+void ipc_channel_set_role(ipc_channel_t *ch, ipc_role_t role);
+
+/**
+ * @brief Send one message; blocks while the channel is full
+ * @return 0 on success, -1 on error (EMSGSIZE: len > IPC_MAX_MESSAGE)
+ */
+int ipc_send(ipc_channel_t *ch, const void *msg, size_t len);
+
+/**
+ * @brief Receive one message; blocks until one arrives
+ * @return Message length, 0 once the sender has closed, -1 on error
+ *         (EMSGSIZE: message larger than size, dropped)
+ */
+ssize_t ipc_receive(ipc_channel_t *ch, void *buf, size_t size);
+
+/**
+ * @brief Close this process's end; the receiver then sees end-of-stream
+ */
+void ipc_channel_close(ipc_channel_t *ch);
+
+/**
+ * @brief Release an inherited channel this process does not use
+ *
+ * Unlike ipc_channel_close(), never signals end-of-stream: a forked
+ * worker drops its siblings' channels with this.
+ */
+void ipc_channel_drop(ipc_channel_t *ch);
+
+/**
+ * @brief Write or read exactly len bytes on a file descriptor
+ * @return 1 on success, 0 on EOF before any byte, -1 on error
+ */
+int ipc_transfer_all(int fd, void *buf, size_t len, bool is_write);
+
+#endif /* SYSTEMS_IPC_CHANNEL_H */
@@ -8,11 +8,16 @@
  * - Parent-child process coordination
  * - Exit status handling
  * - Resource cleanup
+ * - posix_spawn() fast path: launch cost independent of the parent's RSS
+ * - Reaping children in the order they exit (pidfd + poll, waitpid(-1))
+ * - Pre-forked worker pool fed over ipc-channel.h, versus fork per job
  * 
- * Compile: gcc -Wall -Wextra -std=c11 -o process-management process-management.c
+ * Compile: gcc -Wall -Wextra -std=c11 -o process-management process-management.c ipc-channel.c
  * Run: ./process-management
  */
 
+#define _GNU_SOURCE     /* kill(), SIGTERM and syscall() under -std=c11 */
+
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -20,6 +25,45 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <signal.h>
+#include <spawn.h>
+#include <poll.h>
+#include <time.h>
+#include <stdint.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#include "ipc-channel.h"
+
+#define POOL_MAX_WORKERS    16
+#define POOL_BATCH          64      /* Jobs in flight per worker */
+#define POOL_JOB_SIZE       20000   /* Loop iterations per job */
+
+extern char **environ;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Print how a child ended
+ * @return 0 if it exited with status 0, -1 otherwise
+ */
+static int report_exit_status(pid_t pid, int status) {
+    if (WIFEXITED(status)) {
+        int exit_code = WEXITSTATUS(status);
+        printf("Child process %d exited with status %d\n", pid, exit_code);
+        return exit_code == 0 ? 0 : -1;
+    } else if (WIFSIGNALED(status)) {
+        int signal = WTERMSIG(status);
+        fprintf(stderr, "Child process %d terminated by signal %d\n", pid, signal);
+    }
+    return -1;
+}
 
 /**
  * @brief Spawn a child process to execute a command
@@ -55,24 +99,157 @@ int spawn_process(const char *command, char *const args[]) {
             return -1;
         }
         
-        if (WIFEXITED(status)) {
-            int exit_code = WEXITSTATUS(status);
-            printf("Child process %d exited with status %d\n", pid, exit_code);
-            return exit_code == 0 ? 0 : -1;
-        } else if (WIFSIGNALED(status)) {
-            int signal = WTERMSIG(status);
-            fprintf(stderr, "Child process %d terminated by signal %d\n", pid, signal);
-            return -1;
+        return report_exit_status(pid, status);
+    }
+}
+
+/**
+ * @brief Start a command without copying the parent's address space
+ * @param command Command to execute, looked up in PATH
+ * @param args Arguments for the command (NULL-terminated)
+ * @return Child PID, or -1 on error; the caller reaps the child
+ *
+ * glibc and musl implement posix_spawn() with clone(CLONE_VM | CLONE_VFORK):
+ * the child runs on the parent's memory until it execs, so no page tables
+ * are copied and launch time stays flat however large the parent grows.
+ * Use it whenever the child only sets up file actions and execs.
+ */
+pid_t spawn_process_fast(const char *command, char *const args[]) {
+    if (command == NULL || args == NULL) {
+        fprintf(stderr, "Error: NULL command or args\n");
+        return -1;
+    }
+
+    pid_t pid;
+    int ret = posix_spawnp(&pid, command, NULL, NULL, args, environ);
+
+    if (ret != 0) {
+        // posix_spawn reports errors through its return value, not errno
+        fprintf(stderr, "posix_spawnp %s: %s\n", command, strerror(ret));
+        return -1;
+    }
+    return pid;
+}
+
+/**
+ * @brief Fallback reaper: waitpid(-1) also returns children in exit order
+ * @return Number of children that failed
+ *
+ * Collects any child of this process, so unrelated children are reaped
+ * (and not counted) too; pidfds avoid that.
+ */
+static int reap_any_children(const pid_t *pids, int count) {
+    int failed = 0;
+    int remaining = count;
+
+    while (remaining > 0) {
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+
+        if (pid < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("waitpid");
+            return failed + remaining;
+        }
+
+        for (int i = 0; i < count; i++) {
+            if (pids[i] == pid) {
+                if (report_exit_status(pid, status) < 0) {
+                    failed++;
+                }
+                remaining--;
+                break;
+            }
         }
     }
-    
-    return 0;
+    return failed;
+}
+
+/**
+ * @brief Wait for every child in pids, reaping each as soon as it exits
+ * @return Number of children that failed
+ *
+ * A pidfd becomes readable when its process exits, so poll() tells us
+ * which child is done and one slow child never holds up the others. The
+ * same fds can sit in an event loop next to sockets. Without pidfds
+ * (pre-5.3 kernels, other systems) falls back to waitpid(-1).
+ */
+static int reap_children(const pid_t *pids, int count) {
+#if defined(__linux__) && defined(SYS_pidfd_open)
+    struct pollfd *fds = calloc(count, sizeof(*fds));
+    if (fds == NULL) {
+        perror("calloc");
+        return reap_any_children(pids, count);
+    }
+
+    for (int i = 0; i < count; i++) {
+        // A child that already exited still gets a (readable) pidfd
+        fds[i].fd = (int)syscall(SYS_pidfd_open, pids[i], 0);
+        fds[i].events = POLLIN;
+        if (fds[i].fd < 0) {
+            if (errno != ENOSYS) {
+                perror("pidfd_open");
+            }
+            for (int j = 0; j < i; j++) {
+                close(fds[j].fd);
+            }
+            free(fds);
+            return reap_any_children(pids, count);
+        }
+    }
+
+    int failed = 0;
+    int remaining = count;
+    while (remaining > 0) {
+        if (poll(fds, count, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("poll");
+            failed += remaining;
+            break;
+        }
+
+        for (int i = 0; i < count; i++) {
+            if (fds[i].fd < 0 || !(fds[i].revents & POLLIN)) {
+                continue;
+            }
+
+            // Exited, so this does not block
+            int status;
+            if (waitpid(pids[i], &status, 0) < 0) {
+                perror("waitpid");
+                failed++;
+            } else if (report_exit_status(pids[i], status) < 0) {
+                failed++;
+            }
+            close(fds[i].fd);
+            fds[i].fd = -1;     // poll() ignores negative fds
+            remaining--;
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (fds[i].fd >= 0) {
+            close(fds[i].fd);
+        }
+    }
+    free(fds);
+    return failed;
+#else
+    return reap_any_children(pids, count);
+#endif
 }
 
 /**
  * @brief Create multiple child processes and wait for all
  * @param count Number of child processes to create
  * @return 0 on success, -1 on error
+ *
+ * Later children finish first, so the output shows them reaped in exit
+ * order rather than creation order.
  */
 int spawn_multiple_processes(int count) {
     if (count <= 0 || count > 100) {
@@ -86,6 +263,9 @@ int spawn_multiple_processes(int count) {
         return -1;
     }
 
+    // Children would flush a copy of anything still buffered
+    fflush(stdout);
+
     // Create child processes
     for (int i = 0; i < count; i++) {
         pid_t pid = fork();
@@ -96,12 +276,16 @@ int spawn_multiple_processes(int count) {
             for (int j = 0; j < i; j++) {
                 kill(children[j], SIGTERM);
             }
+            reap_children(children, i);
             free(children);
             return -1;
         } else if (pid == 0) {
             // Child process
-            printf("Child %d (PID %d) running\n", i, getpid());
-            sleep(1);  // Simulate work
+            long work_ms = (long)(count - i) * 200;
+            struct timespec ts = { work_ms / 1000, (work_ms % 1000) * 1000000L };
+
+            printf("Child %d (PID %d) running for %ld ms\n", i, getpid(), work_ms);
+            nanosleep(&ts, NULL);  // Simulate work
             exit(EXIT_SUCCESS);
         } else {
             // Parent process
@@ -109,25 +293,335 @@ int spawn_multiple_processes(int count) {
         }
     }
 
-    // Wait for all children
-    int failed = 0;
-    for (int i = 0; i < count; i++) {
-        int status;
-        pid_t result = waitpid(children[i], &status, 0);
-        
-        if (result < 0) {
-            perror("waitpid");
-            failed++;
-        } else if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
-            fprintf(stderr, "Child %d failed\n", children[i]);
-            failed++;
+    // Wait for all children, in whatever order they finish
+    int failed = reap_children(children, count);
+
+    free(children);
+    return failed == 0 ? 0 : -1;
+}
+
+/**
+ * @brief Compare fork()+execvp() with posix_spawnp() from a large parent
+ * @param launches Number of commands to start with each method
+ * @param rss_mb Memory the parent allocates and touches first
+ * @return 0 on success, -1 on error
+ *
+ * fork() copies the page tables of every touched page, so its cost grows
+ * with the parent's RSS; posix_spawn() does not.
+ */
+int launch_cost_example(int launches, size_t rss_mb) {
+    size_t size = rss_mb * 1024 * 1024;
+    long page = sysconf(_SC_PAGESIZE);
+    char *ballast = malloc(size);
+    char *args[] = {"true", NULL};
+
+    if (ballast == NULL) {
+        perror("malloc");
+        return -1;
+    }
+    for (size_t off = 0; off < size; off += (size_t)page) {
+        ballast[off] = 1;
+    }
+
+    printf("Parent RSS inflated by %zu MiB, %d launches of 'true'\n", rss_mb, launches);
+
+    for (int method = 0; method < 2; method++) {
+        double start = now_seconds();
+
+        for (int i = 0; i < launches; i++) {
+            pid_t pid;
+            int status;
+
+            if (method == 0) {
+                pid = fork();
+                if (pid == 0) {
+                    execvp(args[0], args);
+                    _exit(127);  // Do not run the parent's atexit handlers
+                }
+                if (pid < 0) {
+                    perror("fork");
+                }
+            } else {
+                pid = spawn_process_fast(args[0], args);
+            }
+
+            if (pid < 0 || waitpid(pid, &status, 0) < 0 ||
+                !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                fprintf(stderr, "Launch %d failed\n", i);
+                free(ballast);
+                return -1;
+            }
         }
+
+        double elapsed = now_seconds() - start;
+        printf("  %-18s %8.1f us per launch\n",
+               method == 0 ? "fork() + execvp()" : "posix_spawnp()",
+               elapsed * 1e6 / launches);
     }
 
-    free(children);
+    free(ballast);
+    return 0;
+}
+
+/* ---- Pre-forked worker pool ---- */
+
+typedef struct {
+    uint32_t id;
+    uint32_t arg;
+} pool_job_t;
+
+typedef struct {
+    uint32_t id;
+    uint32_t worker;
+    uint64_t value;
+} pool_result_t;
+
+/**
+ * Workers forked once up front. Each has its own job and result channel,
+ * so every channel keeps exactly one sender and one receiver, as the SHM
+ * transport requires.
+ */
+typedef struct {
+    int workers;
+    int next;                                   /* Round-robin cursor */
+    pid_t pids[POOL_MAX_WORKERS];
+    ipc_channel_t jobs[POOL_MAX_WORKERS];       /* Parent -> worker */
+    ipc_channel_t results[POOL_MAX_WORKERS];    /* Worker -> parent */
+} worker_pool_t;
+
+/**
+ * @brief The work itself: stands in for whatever a job really does
+ */
+static uint64_t pool_job_run(uint32_t arg) {
+    uint64_t value = arg;
+
+    for (uint32_t i = 0; i < POOL_JOB_SIZE; i++) {
+        value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+    }
+    return value;
+}
+
+/**
+ * @brief Worker process body: run jobs until the parent closes the channel
+ */
+static void pool_worker_main(worker_pool_t *pool, int index) {
+    ipc_channel_t *jobs = &pool->jobs[index];
+    ipc_channel_t *results = &pool->results[index];
+    pool_job_t job;
+    ssize_t n;
+
+    ipc_channel_set_role(jobs, IPC_ROLE_RECEIVER);
+    ipc_channel_set_role(results, IPC_ROLE_SENDER);
+
+    while ((n = ipc_receive(jobs, &job, sizeof(job))) == (ssize_t)sizeof(job)) {
+        pool_result_t result = { job.id, (uint32_t)index, pool_job_run(job.arg) };
+
+        if (ipc_send(results, &result, sizeof(result)) < 0) {
+            break;
+        }
+    }
+
+    ipc_channel_close(results);
+    ipc_channel_close(jobs);
+    _exit(n == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/**
+ * @brief Stop the workers and reap them
+ * @return 0 if every worker exited cleanly, -1 otherwise
+ */
+int worker_pool_stop(worker_pool_t *pool) {
+    // End-of-stream on its job channel tells a worker to exit
+    for (int i = 0; i < pool->workers; i++) {
+        ipc_channel_close(&pool->jobs[i]);
+    }
+
+    int failed = reap_children(pool->pids, pool->workers);
+
+    for (int i = 0; i < pool->workers; i++) {
+        ipc_channel_close(&pool->results[i]);
+    }
+    pool->workers = 0;
     return failed == 0 ? 0 : -1;
 }
 
+/**
+ * @brief Fork the workers and connect a channel pair to each
+ * @return 0 on success, -1 on error (workers already started are stopped)
+ */
+int worker_pool_start(worker_pool_t *pool, int workers, ipc_transport_t transport) {
+    if (workers <= 0 || workers > POOL_MAX_WORKERS) {
+        fprintf(stderr, "Error: Invalid worker count %d\n", workers);
+        return -1;
+    }
+
+    memset(pool, 0, sizeof(*pool));
+
+    for (int i = 0; i < workers; i++) {
+        if (ipc_channel_open(&pool->jobs[i], transport) < 0) {
+            worker_pool_stop(pool);
+            return -1;
+        }
+        if (ipc_channel_open(&pool->results[i], transport) < 0) {
+            ipc_channel_drop(&pool->jobs[i]);
+            worker_pool_stop(pool);
+            return -1;
+        }
+
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            ipc_channel_drop(&pool->jobs[i]);
+            ipc_channel_drop(&pool->results[i]);
+            worker_pool_stop(pool);
+            return -1;
+        } else if (pid == 0) {
+            // Drop earlier workers' channels, or their pipes never see EOF
+            for (int j = 0; j < i; j++) {
+                ipc_channel_drop(&pool->jobs[j]);
+                ipc_channel_drop(&pool->results[j]);
+            }
+            pool_worker_main(pool, i);
+        }
+
+        pool->pids[i] = pid;
+        pool->workers = i + 1;
+        ipc_channel_set_role(&pool->jobs[i], IPC_ROLE_SENDER);
+        ipc_channel_set_role(&pool->results[i], IPC_ROLE_RECEIVER);
+    }
+    return 0;
+}
+
+/**
+ * @brief Queue a job on the next worker
+ * @return Index of the worker that got it, or -1 on error
+ */
+int worker_pool_submit(worker_pool_t *pool, const pool_job_t *job) {
+    int worker = pool->next;
+
+    pool->next = (pool->next + 1) % pool->workers;
+    if (ipc_send(&pool->jobs[worker], job, sizeof(*job)) < 0) {
+        return -1;
+    }
+    return worker;
+}
+
+/**
+ * @brief Wait for the next result from one worker
+ * @return 0 on success, -1 if the worker failed or went away
+ */
+int worker_pool_collect(worker_pool_t *pool, int worker, pool_result_t *result) {
+    ssize_t n = ipc_receive(&pool->results[worker], result, sizeof(*result));
+
+    if (n != (ssize_t)sizeof(*result)) {
+        fprintf(stderr, "Worker %d (PID %d) stopped returning results\n",
+                worker, pool->pids[worker]);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Run jobs on a worker pool, then the same jobs with a fork per job
+ * @param workers Pool size
+ * @param job_count Number of jobs
+ * @return 0 on success, -1 on error
+ *
+ * Jobs go out in batches of POOL_BATCH per worker and are collected
+ * before the next batch, so neither direction can fill up and deadlock.
+ */
+int worker_pool_example(int workers, int job_count) {
+    worker_pool_t pool;
+    uint64_t pool_sum = 0;
+    uint64_t fork_sum = 0;
+
+    double start = now_seconds();
+    if (worker_pool_start(&pool, workers, IPC_TRANSPORT_SHM) < 0) {
+        return -1;
+    }
+
+    for (int id = 0; id < job_count; ) {
+        int batch = job_count - id;
+        if (batch > POOL_BATCH * workers) {
+            batch = POOL_BATCH * workers;
+        }
+
+        // Round robin: the k-th job of the batch went to worker k % workers
+        int first_worker = pool.next;
+        for (int k = 0; k < batch; k++) {
+            pool_job_t job = { (uint32_t)(id + k), (uint32_t)(id + k) };
+            if (worker_pool_submit(&pool, &job) < 0) {
+                worker_pool_stop(&pool);
+                return -1;
+            }
+        }
+        for (int k = 0; k < batch; k++) {
+            pool_result_t result;
+            if (worker_pool_collect(&pool, (first_worker + k) % workers, &result) < 0) {
+                worker_pool_stop(&pool);
+                return -1;
+            }
+            pool_sum += result.value;
+        }
+        id += batch;
+    }
+
+    if (worker_pool_stop(&pool) < 0) {
+        return -1;
+    }
+    double pool_elapsed = now_seconds() - start;
+
+    // The same jobs, one forked child each, result via a pipe
+    start = now_seconds();
+    for (int id = 0; id < job_count; id++) {
+        int fds[2];
+        uint64_t value;
+        int status;
+
+        if (pipe(fds) < 0) {
+            perror("pipe");
+            return -1;
+        }
+
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            close(fds[0]);
+            close(fds[1]);
+            return -1;
+        } else if (pid == 0) {
+            close(fds[0]);
+            value = pool_job_run((uint32_t)id);
+            _exit(ipc_transfer_all(fds[1], &value, sizeof(value), true) == 1 ? 0 : 1);
+        }
+
+        close(fds[1]);
+        int ret = ipc_transfer_all(fds[0], &value, sizeof(value), false);
+        close(fds[0]);
+        // EOF (ret 0) means the child died before writing its result
+        if (waitpid(pid, &status, 0) < 0 || ret != 1 ||
+            !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "Job %d failed\n", id);
+            return -1;
+        }
+        fork_sum += value;
+    }
+    double fork_elapsed = now_seconds() - start;
+
+    if (pool_sum != fork_sum) {
+        fprintf(stderr, "Result mismatch: pool %llu, fork %llu\n",
+                (unsigned long long)pool_sum, (unsigned long long)fork_sum);
+        return -1;
+    }
+
+    printf("%d jobs, %d pre-forked workers over %s channels\n",
+           job_count, workers, ipc_transport_name(IPC_TRANSPORT_SHM));
+    printf("  %-18s %8.1f us per job (incl. pool start/stop)\n",
+           "worker pool", pool_elapsed * 1e6 / job_count);
+    printf("  %-18s %8.1f us per job\n", "fork per job", fork_elapsed * 1e6 / job_count);
+    return 0;
+}
+
 int main(void) {
     printf("=== Process Management Example ===\n\n");
 
@@ -147,6 +641,22 @@ int main(void) {
     }
     printf("\n");
 
+    // Example 3: Launch cost with a large parent
+    printf("Example 3: fork()+exec versus posix_spawn()\n");
+    if (launch_cost_example(200, 256) < 0) {
+        fprintf(stderr, "Failed to compare launch methods\n");
+        return EXIT_FAILURE;
+    }
+    printf("\n");
+
+    // Example 4: Pre-forked worker pool
+    printf("Example 4: Worker pool versus fork per job\n");
+    if (worker_pool_example(4, 2000) < 0) {
+        fprintf(stderr, "Worker pool failed\n");
+        return EXIT_FAILURE;
+    }
+    printf("\n");
+
     printf("All examples completed successfully\n");
     return EXIT_SUCCESS;
 }
@@ -8,17 +8,54 @@
  * - Async-signal-safe operations
  * - Graceful shutdown
  * - Signal masking
+ * - Signals as events: signalfd (Linux) or a self-pipe, in one epoll loop
+ *   with the application's own file descriptors
+ * 
+ * Modes:
+ * - default: handlers set flags; the main loop checks them every 2 s
+ * - --event-loop: signals are blocked and read from a file descriptor, so
+ *   SIGUSR1 dumps stats and SIGINT/SIGTERM drain and exit the moment they
+ *   arrive. Requests are lines on stdin.
  * 
  * Compile: gcc -Wall -Wextra -std=c11 -o signal-handling signal-handling.c
  * Run: ./signal-handling (Press Ctrl+C to test SIGINT)
+ *      ./signal-handling --event-loop (type lines, Ctrl+C to drain and exit)
  */
 
+#define _GNU_SOURCE     /* sigaction and friends under -std=c11 */
+
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdbool.h>
 #include <unistd.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+
+/* signalfd and epoll are Linux-only; elsewhere a self-pipe and poll() */
+#ifndef HAVE_SIGNALFD
+#ifdef __linux__
+#define HAVE_SIGNALFD 1
+#else
+#define HAVE_SIGNALFD 0
+#endif
+#endif
+
+#ifdef __linux__
+#define HAVE_EPOLL 1
+#include <sys/epoll.h>
+#else
+#define HAVE_EPOLL 0
+#include <poll.h>
+#endif
+
+#if HAVE_SIGNALFD
+#include <sys/signalfd.h>
+#endif
+
+#define REQUEST_MAX 256
 
 // Global flag for graceful shutdown (volatile sig_atomic_t is async-signal-safe)
 static volatile sig_atomic_t shutdown_requested = 0;
@@ -144,9 +181,423 @@ void run_application(void) {
     printf("\nShutdown complete. Total SIGUSR1 signals: %d\n", (int)usr1_count);
 }
 
-int main(void) {
+/* ---- Event-loop mode ---- */
+
+typedef struct {
+    unsigned long long requests;
+    unsigned long long bytes;
+    unsigned long long wakeups;         /* Returns from the wait call */
+    unsigned long long stats_dumps;     /* SIGUSR1 deliveries */
+    struct timespec started;
+} app_stats_t;
+
+/* Event loop state: the signal source plus the application's input */
+typedef struct {
+    int signal_fd;              /* signalfd, or the self-pipe's read end */
+    int input_fd;               /* Requests, one per line; -1 after EOF */
+    int input_flags;            /* Original fcntl flags, restored on exit */
+#if HAVE_EPOLL
+    int epoll_fd;
+#endif
+    char line[REQUEST_MAX];
+    size_t line_len;
+    app_stats_t stats;
+} app_loop_t;
+
+#if !HAVE_SIGNALFD
+/* Write end of the self-pipe, used only by self_pipe_handler() */
+static int self_pipe_write_fd = -1;
+
+/**
+ * @brief Forward a signal into the self-pipe
+ *
+ * The only work done in signal context: one non-blocking write of the
+ * signal number. If the pipe is full, a wakeup is already pending and the
+ * byte may be dropped; standard signals coalesce anyway.
+ */
+static void self_pipe_handler(int signum) {
+    int saved_errno = errno;
+    unsigned char byte = (unsigned char)signum;
+
+    (void)write(self_pipe_write_fd, &byte, 1);
+    errno = saved_errno;
+}
+#endif
+
+/**
+ * @brief Route SIGINT, SIGTERM and SIGUSR1 into a readable descriptor
+ * @return Descriptor to watch, or -1 on error
+ *
+ * With signalfd the signals are blocked and stay pending until read, so
+ * nothing runs asynchronously at all. Block them before starting threads
+ * so that none of them takes the delivery instead.
+ */
+static int signal_source_open(void) {
+#if HAVE_SIGNALFD
+    sigset_t mask;
+
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGUSR1);
+
+    if (sigprocmask(SIG_BLOCK, &mask, NULL) < 0) {
+        perror("sigprocmask(SIG_BLOCK)");
+        return -1;
+    }
+
+    int fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (fd < 0) {
+        perror("signalfd");
+    }
+    return fd;
+#else
+    int fds[2];
+    struct sigaction sa;
+    const int signals[] = { SIGINT, SIGTERM, SIGUSR1 };
+
+    if (pipe(fds) < 0) {
+        perror("pipe");
+        return -1;
+    }
+    for (int i = 0; i < 2; i++) {
+        fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+        fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+    }
+    self_pipe_write_fd = fds[1];
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = self_pipe_handler;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+
+    for (size_t i = 0; i < sizeof(signals) / sizeof(signals[0]); i++) {
+        if (sigaction(signals[i], &sa, NULL) < 0) {
+            perror("sigaction");
+            close(fds[0]);
+            close(fds[1]);
+            return -1;
+        }
+    }
+    return fds[0];
+#endif
+}
+
+/**
+ * @brief Take one pending signal from the signal source
+ * @return Signal number, 0 if none is pending, -1 on error
+ */
+static int signal_source_read(int fd) {
+#if HAVE_SIGNALFD
+    struct signalfd_siginfo info;
+    ssize_t n = read(fd, &info, sizeof(info));
+
+    if (n == (ssize_t)sizeof(info)) {
+        return (int)info.ssi_signo;
+    }
+#else
+    unsigned char byte;
+    ssize_t n = read(fd, &byte, 1);
+
+    if (n == 1) {
+        return byte;
+    }
+#endif
+    if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+        return 0;
+    }
+    perror("read(signal source)");
+    return -1;
+}
+
+/**
+ * @brief Print the stats; safe here because this is not signal context
+ */
+static void app_stats_dump(const app_stats_t *stats) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double uptime = (now.tv_sec - stats->started.tv_sec) +
+                    (now.tv_nsec - stats->started.tv_nsec) / 1e9;
+
+    printf("[stats] uptime %.3f s, requests %llu, bytes %llu, wakeups %llu, dumps %llu\n",
+           uptime, stats->requests, stats->bytes, stats->wakeups, stats->stats_dumps);
+    fflush(stdout);
+}
+
+/**
+ * @brief Handle one complete request line
+ */
+static void app_handle_request(app_loop_t *loop, const char *line, size_t len) {
+    loop->stats.requests++;
+    loop->stats.bytes += len;
+    printf("Handled request %llu: %.*s\n", loop->stats.requests, (int)len, line);
+}
+
+/**
+ * @brief Read whatever input is available and handle every complete line
+ * @return 1 if more input may follow, 0 at EOF, -1 on error
+ */
+static int app_read_input(app_loop_t *loop) {
+    char buf[4096];
+
+    for (;;) {
+        ssize_t n = read(loop->input_fd, buf, sizeof(buf));
+
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return 1;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("read(input)");
+            return -1;
+        }
+        if (n == 0) {
+            // A final line without a newline still counts
+            if (loop->line_len > 0) {
+                app_handle_request(loop, loop->line, loop->line_len);
+                loop->line_len = 0;
+            }
+            return 0;
+        }
+
+        for (ssize_t i = 0; i < n; i++) {
+            if (buf[i] == '\n') {
+                app_handle_request(loop, loop->line, loop->line_len);
+                loop->line_len = 0;
+            } else if (loop->line_len < sizeof(loop->line)) {
+                loop->line[loop->line_len++] = buf[i];
+            }
+            // Bytes past REQUEST_MAX are dropped; the line is still handled
+        }
+    }
+}
+
+/**
+ * @brief Stop reading input and restore its flags
+ */
+static void app_close_input(app_loop_t *loop) {
+    if (loop->input_fd < 0) {
+        return;
+    }
+#if HAVE_EPOLL
+    epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, loop->input_fd, NULL);
+#endif
+    fcntl(loop->input_fd, F_SETFL, loop->input_flags);
+    loop->input_fd = -1;
+}
+
+/**
+ * @brief Wait until the signal source or the input is readable
+ * @return 0 on success, -1 on error
+ *
+ * Both sources are level-triggered; the loop reads each to EAGAIN anyway.
+ */
+static int app_loop_wait(app_loop_t *loop, bool *signal_ready, bool *input_ready) {
+    *signal_ready = false;
+    *input_ready = false;
+
+#if HAVE_EPOLL
+    struct epoll_event events[2];
+    int ready = epoll_wait(loop->epoll_fd, events, 2, -1);
+
+    if (ready < 0) {
+        if (errno == EINTR) {
+            return 0;
+        }
+        perror("epoll_wait");
+        return -1;
+    }
+    for (int i = 0; i < ready; i++) {
+        if (events[i].data.ptr == &loop->signal_fd) {
+            *signal_ready = true;
+        } else if (events[i].data.ptr == &loop->input_fd) {
+            *input_ready = true;
+        }
+    }
+#else
+    struct pollfd fds[2] = {
+        { .fd = loop->signal_fd, .events = POLLIN },
+        { .fd = loop->input_fd, .events = POLLIN },     // Ignored once -1
+    };
+
+    if (poll(fds, 2, -1) < 0) {
+        if (errno == EINTR) {
+            return 0;
+        }
+        perror("poll");
+        return -1;
+    }
+    *signal_ready = (fds[0].revents & POLLIN) != 0;
+    *input_ready = (fds[1].revents & (POLLIN | POLLHUP)) != 0;
+#endif
+    loop->stats.wakeups++;
+    return 0;
+}
+
+/**
+ * @brief Watch a descriptor in the loop's epoll set
+ * @return 0 on success, -1 on error (errno from epoll_ctl)
+ */
+static int app_loop_watch(app_loop_t *loop, int fd, void *tag) {
+#if HAVE_EPOLL
+    struct epoll_event ev;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = tag;
+    return epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+#else
+    (void)loop;
+    (void)fd;
+    (void)tag;
+    return 0;
+#endif
+}
+
+/**
+ * @brief Signals and requests from one event loop, no sleep-polling
+ * @return 0 on a clean shutdown, -1 on error
+ *
+ * SIGUSR1 dumps the stats as soon as it arrives. SIGINT/SIGTERM stop the
+ * loop at once: input already available is drained and handled, then the
+ * loop exits instead of waiting for more.
+ */
+int run_event_loop(void) {
+    app_loop_t loop;
+    bool running = true;
+    int status = 0;
+
+    memset(&loop, 0, sizeof(loop));
+    clock_gettime(CLOCK_MONOTONIC, &loop.stats.started);
+    loop.input_fd = STDIN_FILENO;
+    loop.input_flags = fcntl(STDIN_FILENO, F_GETFL);
+    if (loop.input_flags < 0) {
+        perror("fcntl(F_GETFL)");
+        return -1;
+    }
+
+    loop.signal_fd = signal_source_open();
+    if (loop.signal_fd < 0) {
+        return -1;
+    }
+
+#if HAVE_EPOLL
+    loop.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (loop.epoll_fd < 0) {
+        perror("epoll_create1");
+        close(loop.signal_fd);
+        return -1;
+    }
+#endif
+
+    printf("Event loop running (PID: %d, signals via %s)\n", getpid(),
+           HAVE_SIGNALFD ? "signalfd" : "self-pipe");
+    printf("Type requests, one per line\n");
+    printf("Send SIGUSR1 with: kill -USR1 %d\n", getpid());
+    printf("Send SIGTERM with: kill -TERM %d (or press Ctrl+C)\n\n", getpid());
+    fflush(stdout);
+
+    if (app_loop_watch(&loop, loop.signal_fd, &loop.signal_fd) < 0) {
+        perror("epoll_ctl(signal source)");
+        running = false;
+        status = -1;
+    }
+
+    fcntl(loop.input_fd, F_SETFL, loop.input_flags | O_NONBLOCK);
+    if (running && app_loop_watch(&loop, loop.input_fd, &loop.input_fd) < 0) {
+        if (errno == EPERM) {
+            // Regular files cannot be polled (always ready): handle them now
+            if (app_read_input(&loop) < 0) {
+                status = -1;
+            }
+            app_close_input(&loop);
+        } else {
+            perror("epoll_ctl(input)");
+            running = false;
+            status = -1;
+        }
+    }
+
+    while (running) {
+        bool signal_ready;
+        bool input_ready;
+
+        if (app_loop_wait(&loop, &signal_ready, &input_ready) < 0) {
+            status = -1;
+            break;
+        }
+
+        if (input_ready && loop.input_fd >= 0) {
+            int ret = app_read_input(&loop);
+            if (ret == 0) {
+                printf("Input closed; still serving signals\n");
+                app_close_input(&loop);
+            } else if (ret < 0) {
+                status = -1;
+                app_close_input(&loop);
+            }
+            fflush(stdout);
+        }
+
+        while (signal_ready && running) {
+            int signum = signal_source_read(loop.signal_fd);
+
+            if (signum <= 0) {
+                status = signum < 0 ? -1 : status;
+                running = signum == 0;
+                break;
+            }
+            if (signum == SIGUSR1) {
+                loop.stats.stats_dumps++;
+                app_stats_dump(&loop.stats);
+                continue;
+            }
+
+            printf("Received %s, draining...\n", signum == SIGINT ? "SIGINT" : "SIGTERM");
+            if (loop.input_fd >= 0 && app_read_input(&loop) < 0) {
+                status = -1;
+            }
+            // Shutting down, so no rest of the line will be read
+            if (loop.line_len > 0) {
+                app_handle_request(&loop, loop.line, loop.line_len);
+                loop.line_len = 0;
+            }
+            running = false;
+        }
+    }
+
+    app_close_input(&loop);
+#if HAVE_EPOLL
+    close(loop.epoll_fd);
+#endif
+    close(loop.signal_fd);
+
+    printf("\nShutdown complete\n");
+    app_stats_dump(&loop.stats);
+    return status;
+}
+
+int main(int argc, char *argv[]) {
+    bool event_loop = argc > 1 && strcmp(argv[1], "--event-loop") == 0;
+
+    if (argc > 2 || (argc == 2 && !event_loop)) {
+        fprintf(stderr, "Usage: %s [--event-loop]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
     printf("=== Signal Handling Example ===\n\n");
 
+    if (event_loop) {
+        if (run_event_loop() < 0) {
+            return EXIT_FAILURE;
+        }
+        printf("Application terminated gracefully\n");
+        return EXIT_SUCCESS;
+    }
+
     // Install signal handlers
     if (install_signal_handlers() < 0) {
         fprintf(stderr, "Failed to install signal handlers\n");
@@ -159,4 +610,3 @@ int main(void) {
     printf("Application terminated gracefully\n");
     return EXIT_SUCCESS;
 }
-
@@ -0,0 +1,118 @@
+/**
+ * Native Benchmark Suite for the C Examples
+ * Builds examples/benchmarks/c-bench and runs it in quick mode.
+ * Checks that every scenario in benchmarks/baseline/c-examples.json is still
+ * reported, in the shape benchmarks/run-c-benchmarks.py compares.
+ * Timings are machine-dependent, so the regression check against the
+ * baseline stays in the runner: python benchmarks/run-c-benchmarks.py
+ */
+
+import { execFileSync, execSync } from 'child_process';
+import * as fs from 'fs';
+import * as os from 'os';
+import * as path from 'path';
+
+interface BenchResult {
+  scenario: string;
+  description: string;
+  unit: string;
+  value: number;
+  higher_is_better: boolean;
+}
+
+interface BaselineEntry {
+  unit: string;
+  higher_is_better: boolean;
+  value: number;
+  allowed_regression?: number;
+}
+
+const suiteDir = path.join(__dirname, '../../examples/benchmarks');
+const baselineFile = path.join(__dirname, '../../../../../benchmarks/baseline/c-examples.json');
+
+// SIMD kernels are only measured when the CPU has them
+const cpuSpecific = /^checksum\.(xor_(sse2|avx2|neon)|crc32c_(sse42|armv8))\./;
+
+function hasToolchain(): boolean {
+  if (process.platform !== 'linux') {
+    return false;
+  }
+  try {
+    execSync('command -v make && command -v gcc', { stdio: 'ignore' });
+    return true;
+  } catch (error) {
+    return false;
+  }
+}
+
+const describeIfToolchain = hasToolchain() ? describe : describe.skip;
+
+describeIfToolchain('C Examples Benchmark Suite', () => {
+  let tempDir: string;
+  let results: BenchResult[];
+  let baseline: Record<string, BaselineEntry>;
+
+  beforeAll(() => {
+    tempDir = fs.mkdtempSync(path.join(os.tmpdir(), 'c-bench-'));
+    const jsonPath = path.join(tempDir, 'c-bench.json');
+
+    execFileSync('make', ['-C', suiteDir, 'all', 'servers'], { stdio: 'ignore' });
+    execFileSync('./c-bench', ['--quick', '--json', jsonPath], {
+      cwd: suiteDir,
+      stdio: 'ignore'
+    });
+
+    results = JSON.parse(fs.readFileSync(jsonPath, 'utf-8')).results;
+    baseline = JSON.parse(fs.readFileSync(baselineFile, 'utf-8')).scenarios;
+  }, 120000);
+
+  afterAll(() => {
+    try {
+      fs.rmSync(tempDir, { recursive: true, force: true });
+    } catch (error) {
+      // Ignore cleanup errors
+    }
+  });
+
+  it('should report finite, positive values', () => {
+    expect(results.length).toBeGreaterThan(0);
+
+    for (const result of results) {
+      expect(typeof result.scenario).toBe('string');
+      expect(typeof result.description).toBe('string');
+      expect(typeof result.unit).toBe('string');
+      expect(typeof result.higher_is_better).toBe('boolean');
+      expect(Number.isFinite(result.value)).toBe(true);
+      expect(result.value).toBeGreaterThan(0);
+    }
+  });
+
+  it('should report every baseline scenario', () => {
+    const measured = new Set(results.map(r => r.scenario));
+    const missing = Object.keys(baseline)
+      .filter(name => !cpuSpecific.test(name))
+      .filter(name => !measured.has(name));
+
+    expect(missing).toEqual([]);
+  });
+
+  it('should keep units and direction consistent with the baseline', () => {
+    for (const result of results) {
+      const entry = baseline[result.scenario];
+      if (entry === undefined) {
+        continue;
+      }
+      expect(result.unit).toBe(entry.unit);
+      expect(result.higher_is_better).toBe(entry.higher_is_better);
+    }
+  });
+
+  it('should keep the fast paths ahead of their reference paths', () => {
+    // Same machine, same run: these hold wherever the suite runs
+    const value = (name: string) => results.find(r => r.scenario === name)?.value ?? 0;
+
+    expect(value('parser.buffer.throughput')).toBeGreaterThan(value('parser.byte.throughput'));
+    expect(value('process.posix_spawn.launch.p50_us'))
+      .toBeLessThan(value('process.fork_exec.launch.p50_us'));
+  });
+});
@@ -0,0 +1,199 @@
+#!/usr/bin/env python3
+"""
+C Examples Benchmark Runner
+
+Builds and runs the native benchmark suite in
+augment-extensions/coding-standards/c/examples/benchmarks, compares every
+measurement with benchmarks/baseline/c-examples.json and writes the results
+in the same format as benchmarks/results.json.
+"""
+
+import argparse
+import json
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+from typing import Dict, List, Optional, Tuple
+
+SUITE_DIR = Path("augment-extensions/coding-standards/c/examples/benchmarks")
+BASELINE_FILE = Path("benchmarks/baseline/c-examples.json")
+OUTPUT_FILE = Path("benchmarks/c-results.json")
+DEFAULT_ALLOWED_REGRESSION = 25.0
+
+
+def run_suite(quick: bool, suites: List[str]) -> Tuple[List[Dict], bool]:
+    """Build c-bench and the servers it load-tests, run it, return its results
+    and whether every suite succeeded."""
+    subprocess.run(["make", "-C", str(SUITE_DIR), "all", "servers"], check=True)
+
+    with tempfile.TemporaryDirectory() as tmp:
+        json_path = Path(tmp) / "c-bench.json"
+        command = ["./c-bench", "--json", str(json_path)]
+        if quick:
+            command.append("--quick")
+        command.extend(suites)
+
+        completed = subprocess.run(command, cwd=SUITE_DIR)
+        if not json_path.exists():
+            print("Error: c-bench did not write any results")
+            sys.exit(1)
+        if completed.returncode != 0:
+            print("Warning: some suites failed; comparing the results that were recorded")
+        results = json.loads(json_path.read_text(encoding='utf-8'))["results"]
+        return results, completed.returncode == 0
+
+
+def compare(measured: Dict, baseline: Optional[Dict], default_allowed: float) -> Dict:
+    """Compare one measurement with its baseline entry."""
+    value = measured["value"]
+    higher_is_better = measured["higher_is_better"]
+    allowed = default_allowed
+    baseline_value = None
+    change = 0.0
+
+    if baseline is not None:
+        baseline_value = baseline["value"]
+        allowed = baseline.get("allowed_regression", default_allowed)
+        if baseline_value > 0:
+            change = (value - baseline_value) / baseline_value * 100
+            if not higher_is_better:
+                change = -change
+
+    return {
+        "scenario": measured["scenario"],
+        "description": measured["description"],
+        "unit": measured["unit"],
+        "baseline_value": baseline_value,
+        "measured_value": value,
+        # Positive is an improvement, whichever direction the metric runs
+        "change_percentage": change,
+        "allowed_regression": allowed,
+        "meets_expectation": change >= -allowed
+    }
+
+
+def print_results(results: List[Dict], missing: List[str]):
+    """Print benchmark results in a formatted table."""
+    print("\n" + "=" * 100)
+    print("C EXAMPLES BENCHMARK RESULTS")
+    print("=" * 100)
+
+    for result in results:
+        baseline = result['baseline_value']
+        print(f"\n{result['scenario']}")
+        print(f"  Description: {result['description']}")
+        if baseline is None:
+            print(f"  Baseline:    (none)")
+        else:
+            print(f"  Baseline:    {baseline:,.2f} {result['unit']}")
+        print(f"  Measured:    {result['measured_value']:,.2f} {result['unit']}")
+        print(f"  Change:      {result['change_percentage']:+.1f}% "
+              f"(allowed: -{result['allowed_regression']:.0f}%)")
+        status = "✓ PASS" if result['meets_expectation'] else "✗ FAIL"
+        print(f"  Status:      {status}")
+
+    if missing:
+        print(f"\nNot measured on this machine: {', '.join(missing)}")
+
+    # Summary
+    passed = sum(1 for r in results if r['meets_expectation'])
+
+    print(f"\n{'=' * 100}")
+    print(f"SUMMARY")
+    print(f"{'=' * 100}")
+    print(f"  Total Scenarios:    {len(results)}")
+    print(f"  Passed:             {passed}/{len(results)}")
+    print(f"  Average Change:     {average_change(results):+.1f}%")
+    print(f"  Overall Status:     {'✓ ALL PASS' if passed == len(results) else '✗ SOME FAILED'}")
+    print(f"{'=' * 100}\n")
+
+
+def average_change(results: List[Dict]) -> float:
+    """Mean change over the scenarios that have a baseline."""
+    compared = [r["change_percentage"] for r in results if r["baseline_value"] is not None]
+    return sum(compared) / len(compared) if compared else 0.0
+
+
+def export_json(results: List[Dict], output_file: Path):
+    """Export results to JSON file."""
+    output = {
+        "results": results,
+        "summary": {
+            "total_scenarios": len(results),
+            "passed": sum(1 for r in results if r['meets_expectation']),
+            "average_change": average_change(results)
+        }
+    }
+
+    output_file.write_text(json.dumps(output, indent=2), encoding='utf-8')
+    print(f"Results exported to: {output_file}")
+
+
+def update_baseline(measured: List[Dict], baseline: Dict):
+    """Record the current run as the new baseline, keeping per-scenario tolerances."""
+    scenarios = baseline.setdefault("scenarios", {})
+    for m in measured:
+        entry = scenarios.setdefault(m["scenario"], {})
+        entry["unit"] = m["unit"]
+        entry["higher_is_better"] = m["higher_is_better"]
+        entry["value"] = round(m["value"], 3)
+
+    BASELINE_FILE.write_text(json.dumps(baseline, indent=2) + "\n", encoding='utf-8')
+    print(f"Baseline updated: {BASELINE_FILE} ({len(measured)} scenarios)")
+
+
+def main():
+    """Main benchmark runner."""
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--quick", action="store_true",
+                        help="run a tenth of the iterations")
+    parser.add_argument("--update-baseline", action="store_true",
+                        help=f"store this run in {BASELINE_FILE}")
+    parser.add_argument("--output", type=Path, default=OUTPUT_FILE,
+                        help=f"results file (default: {OUTPUT_FILE})")
+    parser.add_argument("suites", nargs="*",
+                        help="suites to run (default: all)")
+    args = parser.parse_args()
+
+    if not SUITE_DIR.exists():
+        print(f"Error: Benchmark suite not found: {SUITE_DIR}")
+        print("Please run from the repository root.")
+        sys.exit(1)
+
+    baseline = {}
+    if BASELINE_FILE.exists():
+        baseline = json.loads(BASELINE_FILE.read_text(encoding='utf-8'))
+    default_allowed = baseline.get("allowed_regression", DEFAULT_ALLOWED_REGRESSION)
+    baseline_scenarios = baseline.get("scenarios", {})
+
+    measured, suites_ok = run_suite(args.quick, args.suites)
+    if not measured:
+        print("Error: No results recorded")
+        sys.exit(1)
+
+    if args.update_baseline:
+        if not suites_ok:
+            print("Error: Not updating the baseline from a failed run")
+            sys.exit(1)
+        update_baseline(measured, baseline)
+        sys.exit(0)
+
+    results = [compare(m, baseline_scenarios.get(m["scenario"]), default_allowed)
+               for m in measured]
+
+    # Kernels the CPU lacks, or suites not selected, have nothing to compare
+    seen = {m["scenario"] for m in measured}
+    prefixes = tuple(f"{s}." for s in args.suites)
+    missing = [name for name in baseline_scenarios
+               if name not in seen and (not prefixes or name.startswith(prefixes))]
+
+    print_results(results, missing)
+    export_json(results, args.output)
+
+    all_passed = suites_ok and all(r['meets_expectation'] for r in results)
+    sys.exit(0 if all_passed else 1)
+
+
+if __name__ == "__main__":
+    main()